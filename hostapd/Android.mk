@@ -326,6 +326,11 @@ L_CFLAGS += -DCONFIG_MBO
 OBJS += src/ap/mbo_ap.c
 endif
 
+ifdef CONFIG_STA_CONN_TRACE
+L_CFLAGS += -DCONFIG_STA_CONN_TRACE
+OBJS += src/ap/conn_trace.c
+endif
+
 ifdef CONFIG_FST
 L_CFLAGS += -DCONFIG_FST
 OBJS += src/fst/fst.c
@@ -1079,6 +1084,10 @@ ifdef CONFIG_DEBUG_LINUX_TRACING
 L_CFLAGS += -DCONFIG_DEBUG_LINUX_TRACING
 endif
 
+ifdef CONFIG_DEBUG_RING
+L_CFLAGS += -DCONFIG_DEBUG_RING
+endif
+
 ifdef CONFIG_DEBUG_FILE
 L_CFLAGS += -DCONFIG_DEBUG_FILE
 endif
@@ -2483,6 +2483,14 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->ap_max_inactivity = atoi(pos);
 	} else if (os_strcmp(buf, "skip_inactivity_poll") == 0) {
 		bss->skip_inactivity_poll = atoi(pos);
+	} else if (os_strcmp(buf, "sta_stats_interval") == 0) {
+		bss->sta_stats_interval = atoi(pos);
+	} else if (os_strcmp(buf, "sta_stats_max_age_inactivity") == 0) {
+		bss->sta_stats_max_age[STA_STATS_INACTIVITY] = atoi(pos);
+	} else if (os_strcmp(buf, "sta_stats_max_age_accounting") == 0) {
+		bss->sta_stats_max_age[STA_STATS_ACCOUNTING] = atoi(pos);
+	} else if (os_strcmp(buf, "sta_stats_max_age_ctrl") == 0) {
+		bss->sta_stats_max_age[STA_STATS_CTRL_IFACE] = atoi(pos);
 	} else if (os_strcmp(buf, "country_code") == 0) {
 		os_memcpy(conf->country, pos, 2);
 	} else if (os_strcmp(buf, "country3") == 0) {
@@ -3153,6 +3161,26 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->acs_num_scans = val;
+	} else if (os_strcmp(buf, "acs_reeval_period") == 0) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 86400) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid acs_reeval_period %d (expected 0..86400)",
+				   line, val);
+			return 1;
+		}
+		conf->acs_reeval_period = val;
+	} else if (os_strcmp(buf, "acs_cost") == 0) {
+		if (os_strcmp(pos, "survey") == 0) {
+			conf->acs_cost = ACS_COST_SURVEY;
+		} else if (os_strcmp(pos, "busy") == 0) {
+			conf->acs_cost = ACS_COST_BUSY;
+		} else {
+			wpa_printf(MSG_ERROR, "Line %d: unknown acs_cost '%s'",
+				   line, pos);
+			return 1;
+		}
 	} else if (os_strcmp(buf, "acs_chan_bias") == 0) {
 		if (hostapd_config_parse_acs_chan_bias(conf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid acs_chan_bias",
@@ -4214,6 +4242,36 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		conf->track_sta_max_num = atoi(pos);
 	} else if (os_strcmp(buf, "track_sta_max_age") == 0) {
 		conf->track_sta_max_age = atoi(pos);
+	} else if (os_strcmp(buf, "probe_resp_rate_limit") == 0) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 1000) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid probe_resp_rate_limit %d (expected 0..1000)",
+				   line, val);
+			return 1;
+		}
+		conf->probe_resp_rate_limit = val;
+	} else if (os_strcmp(buf, "probe_resp_burst") == 0) {
+		int val = atoi(pos);
+
+		if (val < 1 || val > 1000) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid probe_resp_burst %d (expected 1..1000)",
+				   line, val);
+			return 1;
+		}
+		conf->probe_resp_burst = val;
+	} else if (os_strcmp(buf, "probe_req_dedup_window") == 0) {
+		int val = atoi(pos);
+
+		if (val < 0 || val > 10000) {
+			wpa_printf(MSG_ERROR,
+				   "Line %d: invalid probe_req_dedup_window %d (expected 0..10000)",
+				   line, val);
+			return 1;
+		}
+		conf->probe_req_dedup_window = val;
 	} else if (os_strcmp(buf, "no_probe_resp_if_seen_on") == 0) {
 		os_free(bss->no_probe_resp_if_seen_on);
 		bss->no_probe_resp_if_seen_on = os_strdup(pos);
@@ -2466,7 +2466,7 @@ static int hostapd_ctrl_iface_log_level(struct hostapd_data *hapd, char *cmd,
 	char *pos, *end, *stamp;
 	int ret;
 
-	/* cmd: "LOG_LEVEL [<level>]" */
+	/* cmd: "LOG_LEVEL [<level>|<module>=<level>|<module>=DEFAULT]" */
 	if (*cmd == '\0') {
 		pos = buf;
 		end = buf + buflen;
@@ -2475,9 +2475,11 @@ static int hostapd_ctrl_iface_log_level(struct hostapd_data *hapd, char *cmd,
 				  debug_level_str(wpa_debug_level),
 				  wpa_debug_timestamp);
 		if (os_snprintf_error(end - pos, ret))
-			ret = 0;
+			return 0;
+		pos += ret;
+		pos += wpa_debug_module_levels_str(pos, end - pos);
 
-		return ret;
+		return pos - buf;
 	}
 
 	while (*cmd == ' ')
@@ -2491,7 +2493,10 @@ static int hostapd_ctrl_iface_log_level(struct hostapd_data *hapd, char *cmd,
 		}
 	}
 
-	if (os_strlen(cmd)) {
+	if (os_strchr(cmd, '=')) {
+		if (wpa_debug_set_module_level(cmd) < 0)
+			return -1;
+	} else if (os_strlen(cmd)) {
 		int level = str_to_debug_level(cmd);
 		if (level < 0)
 			return -1;
@@ -2758,6 +2763,53 @@ set:
 }
 
 
+/*
+ * Import neighbor database entries from a file. Each line has the same format
+ * as the SET_NEIGHBOR command arguments; empty lines and lines starting with
+ * '#' are ignored. The import stops at the first invalid entry.
+ */
+static int hostapd_ctrl_iface_import_neighbors(struct hostapd_data *hapd,
+					       const char *fname)
+{
+	FILE *f;
+	char buf[4096], *pos;
+	int line = 0, count = 0, ret = 0;
+
+	f = fopen(fname, "r");
+	if (!f) {
+		wpa_printf(MSG_ERROR,
+			   "CTRL: IMPORT_NEIGHBORS: Could not open '%s'",
+			   fname);
+		return -1;
+	}
+
+	while (fgets(buf, sizeof(buf), f)) {
+		line++;
+		pos = buf;
+		while (*pos == ' ' || *pos == '\t')
+			pos++;
+		pos[strcspn(pos, "\r\n")] = '\0';
+		if (*pos == '#' || *pos == '\0')
+			continue;
+
+		if (hostapd_ctrl_iface_set_neighbor(hapd, pos) < 0) {
+			wpa_printf(MSG_ERROR,
+				   "CTRL: IMPORT_NEIGHBORS: Invalid entry on line %d in '%s'",
+				   line, fname);
+			ret = -1;
+			break;
+		}
+		count++;
+	}
+
+	fclose(f);
+	wpa_printf(MSG_DEBUG,
+		   "CTRL: IMPORT_NEIGHBORS: Imported %d entries from '%s'",
+		   count, fname);
+	return ret;
+}
+
+
 static int hostapd_ctrl_iface_remove_neighbor(struct hostapd_data *hapd,
 					      char *buf)
 {
@@ -3003,6 +3055,11 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 		reply_len = hostapd_ctrl_iface_signature(hapd, buf + 10,
 							 reply, reply_size);
 #endif /* CONFIG_TAXONOMY */
+#ifdef CONFIG_STA_CONN_TRACE
+	} else if (os_strncmp(buf, "CONN_TRACE ", 11) == 0) {
+		reply_len = hostapd_ctrl_iface_conn_trace(hapd, buf + 11,
+							  reply, reply_size);
+#endif /* CONFIG_STA_CONN_TRACE */
 	} else if (os_strncmp(buf, "POLL_STA ", 9) == 0) {
 		if (hostapd_ctrl_iface_poll_sta(hapd, buf + 9))
 			reply_len = -1;
@@ -3202,6 +3259,9 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "SET_NEIGHBOR ", 13) == 0) {
 		if (hostapd_ctrl_iface_set_neighbor(hapd, buf + 13))
 			reply_len = -1;
+	} else if (os_strncmp(buf, "IMPORT_NEIGHBORS ", 17) == 0) {
+		if (hostapd_ctrl_iface_import_neighbors(hapd, buf + 17))
+			reply_len = -1;
 	} else if (os_strncmp(buf, "REMOVE_NEIGHBOR ", 16) == 0) {
 		if (hostapd_ctrl_iface_remove_neighbor(hapd, buf + 16))
 			reply_len = -1;
@@ -4221,6 +4281,9 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "INTERFACES", 10) == 0) {
 		reply_len = hostapd_global_ctrl_iface_interfaces(
 			interfaces, buf + 10, reply, sizeof(buffer));
+	} else if (os_strcmp(buf, "STATUS") == 0) {
+		/* Process-wide state that is not specific to an interface */
+		reply_len = ap_sta_slab_status(reply, reply_size);
 	} else if (os_strcmp(buf, "TERMINATE") == 0) {
 		eloop_terminate();
 	} else {
@@ -10,9 +10,537 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "drivers/driver.h"
+#include "ap/hostapd.h"
+#include "ap/ap_config.h"
+#include "ap/sta_info.h"
+#include "ap/ieee802_11.h"
+#include "ap/acs.h"
+#include "common/ieee802_11_defs.h"
+
+
+/*
+ * Run step() for rounds first..rounds-1 with debug prints below MSG_INFO
+ * disabled and report the time used. Returns 0 if all rounds succeeded.
+ */
+static int timed_test(const char *name, const char *what, unsigned int first,
+		      unsigned int rounds,
+		      int (*step)(void *ctx, unsigned int round), void *ctx)
+{
+	struct os_reltime start, end, diff;
+	unsigned int i;
+	int level = wpa_debug_level;
+
+	wpa_debug_level = MSG_INFO;
+	os_get_reltime(&start);
+	for (i = first; i < rounds; i++) {
+		if (step(ctx, i) < 0)
+			break;
+	}
+	os_get_reltime(&end);
+	wpa_debug_level = level;
+
+	if (i < rounds) {
+		wpa_printf(MSG_ERROR, "%s test: Round %u failed", name, i);
+		return -1;
+	}
+	os_reltime_sub(&end, &start, &diff);
+	wpa_printf(MSG_INFO, "%s test: %u %s in %ld.%06ld sec",
+		   name, rounds, what, (long) diff.sec, (long) diff.usec);
+	return 0;
+}
+
+
+#define AID_TEST_MAX 2007
+#define AID_TEST_CHURN 200000
+
+struct aid_test_ctx {
+	struct hostapd_data *hapd;
+	struct sta_info *sta;
+	unsigned int rnd;
+};
+
+
+static int aid_test_churn(void *ctx, unsigned int round)
+{
+	struct aid_test_ctx *t = ctx;
+	unsigned int idx;
+
+	t->rnd = t->rnd * 1103515245 + 12345;
+	idx = (t->rnd >> 16) % AID_TEST_MAX;
+	if (t->sta[idx].aid) {
+		hostapd_free_aid(t->hapd, &t->sta[idx]);
+		t->sta[idx].aid = 0;
+		return 0;
+	}
+	return hostapd_get_aid(t->hapd, &t->sta[idx]);
+}
+
+
+static int aid_alloc_tests(void)
+{
+	struct hostapd_data *hapd;
+	struct sta_info *sta, extra;
+	struct aid_test_ctx ctx;
+	unsigned int i;
+	int ret = -1;
+
+	wpa_printf(MSG_INFO, "AID allocation tests");
+
+	hapd = os_zalloc(sizeof(*hapd));
+	sta = os_calloc(AID_TEST_MAX, sizeof(*sta));
+	if (!hapd || !sta)
+		goto fail;
+	os_memset(&extra, 0, sizeof(extra));
+
+	for (i = 0; i < AID_TEST_MAX; i++) {
+		if (hostapd_get_aid(hapd, &sta[i]) < 0 ||
+		    sta[i].aid != i + 1) {
+			wpa_printf(MSG_ERROR,
+				   "aid test: Unexpected AID %u for entry %u",
+				   sta[i].aid, i);
+			goto fail;
+		}
+	}
+	if (hostapd_get_aid(hapd, &extra) == 0) {
+		wpa_printf(MSG_ERROR, "aid test: AID allocated beyond 2007");
+		goto fail;
+	}
+
+	/* The lowest free AID is allocated next */
+	hostapd_free_aid(hapd, &sta[1000]);
+	hostapd_free_aid(hapd, &sta[40]);
+	sta[1000].aid = sta[40].aid = 0;
+	if (hostapd_get_aid(hapd, &extra) < 0 || extra.aid != 41 ||
+	    hostapd_get_aid(hapd, &sta[40]) < 0 || sta[40].aid != 1001) {
+		wpa_printf(MSG_ERROR, "aid test: Free AID not reused in order");
+		goto fail;
+	}
+	hostapd_free_aid(hapd, &extra);
+	hostapd_free_aid(hapd, &sta[40]);
+	sta[40].aid = 0;
+
+	/* Allocation/free churn with about half of the AIDs in use */
+	for (i = AID_TEST_MAX / 2; i < AID_TEST_MAX; i++) {
+		if (sta[i].aid) {
+			hostapd_free_aid(hapd, &sta[i]);
+			sta[i].aid = 0;
+		}
+	}
+	ctx.hapd = hapd;
+	ctx.sta = sta;
+	ctx.rnd = 1;
+	if (timed_test("aid", "allocation/free operations", 0, AID_TEST_CHURN,
+		       aid_test_churn, &ctx) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	os_free(sta);
+	os_free(hapd);
+	return ret;
+}
+
+
+#ifdef CONFIG_ACS
+
+#define ACS_TEST_CHANS 13
+#define ACS_TEST_SCANS 5
+#define ACS_TEST_ROUNDS 2000
+
+/* Survey dump recorded on 2.4 GHz channels 1-13 over five scans (see the
+ * example analysis in src/ap/acs.c) and the resulting interference factors */
+static const struct acs_test_chan {
+	s8 nf[ACS_TEST_SCANS];
+	u16 time[ACS_TEST_SCANS];
+	u16 rx[ACS_TEST_SCANS];
+	double factor;
+} acs_test_dump[ACS_TEST_CHANS] = {
+	{ { -113, -113, -113, -113, -113 }, { 162, 161, 162, 161, 161 },
+	  { 13, 12, 11, 5, 4 }, 0.0557166 },
+	{ { -113, -113, -113, -113, -113 }, { 162, 162, 162, 161, 161 },
+	  { 3, 4, 6, 24, 4 }, 0.050832 },
+	{ { -113, -113, -113, -113, -113 }, { 162, 162, 161, 161, 161 },
+	  { 0, 3, 3, 3, 3 }, 0.0148838 },
+	{ { -114, -114, -114, -114, -114 }, { 162, 162, 161, 161, 161 },
+	  { 0, 9, 0, 3, 1 }, 0.0160801 },
+	{ { -113, -113, -113, -113, -114 }, { 161, 162, 161, 161, 161 },
+	  { 66, 7, 2, 109, 3 }, 0.232244 },
+	{ { -113, -112, -113, -112, -113 }, { 161, 161, 161, 161, 161 },
+	  { 89, 13, 5, 70, 10 }, 0.232298 },
+	{ { -112, -113, -113, -113, -113 }, { 161, 161, 161, 161, 161 },
+	  { 71, 62, 6, 6, 12 }, 0.195031 },
+	{ { -112, -114, -113, -113, -114 }, { 161, 161, 161, 162, 162 },
+	  { 8, 8, 6, 21, 27 }, 0.0865885 },
+	{ { -114, -114, -114, -114, -114 }, { 161, 161, 161, 162, 162 },
+	  { 2, 5, 0, 1, 0 }, 0.00993022 },
+	{ { -114, -114, -114, -114, -114 }, { 161, 161, 161, 162, 162 },
+	  { 1, 1, 1, 8, 0 }, 0.0136033 },
+	{ { -114, -113, -113, -114, -114 }, { 161, 161, 161, 162, 162 },
+	  { 0, 0, 0, 7, 15 }, 0.0271605 },
+	{ { -113, -114, -113, -113, -113 }, { 161, 161, 162, 162, 162 },
+	  { 10, 1, 0, 0, 1 }, 0.0148992 },
+	{ { -114, -114, -114, -114, -114 }, { 161, 162, 162, 162, 162 },
+	  { 12, 9, 0, 0, 0 }, 0.0260179 },
+};
+
+
+static int acs_test_replay(struct hostapd_iface *iface)
+{
+	struct survey_results res;
+	struct freq_survey *survey;
+	int scan, i;
+
+	acs_cleanup(iface);
+
+	for (scan = 0; scan < ACS_TEST_SCANS; scan++) {
+		res.freq_filter = 0;
+		dl_list_init(&res.survey_list);
+		for (i = 0; i < ACS_TEST_CHANS; i++) {
+			survey = os_zalloc(sizeof(*survey));
+			if (!survey)
+				return -1;
+			survey->freq = 2412 + i * 5;
+			survey->nf = acs_test_dump[i].nf[scan];
+			survey->channel_time = acs_test_dump[i].time[scan];
+			survey->channel_time_rx = acs_test_dump[i].rx[scan];
+			survey->filled = SURVEY_HAS_NF | SURVEY_HAS_CHAN_TIME |
+				SURVEY_HAS_CHAN_TIME_RX;
+			dl_list_add_tail(&res.survey_list, &survey->list);
+		}
+		hostapd_event_get_survey(iface, &res);
+		acs_update_chan_stats(iface);
+	}
+
+	return acs_study_survey_based(iface);
+}
+
+
+static int acs_test_round(void *ctx, unsigned int round)
+{
+	return acs_test_replay(ctx);
+}
+
+
+static int acs_replay_tests(void)
+{
+	struct hostapd_iface *iface;
+	struct hostapd_hw_modes *mode;
+	long double factor, expected;
+	int i, ret = -1;
+
+	wpa_printf(MSG_INFO, "ACS survey replay tests");
+
+	iface = os_zalloc(sizeof(*iface));
+	mode = os_zalloc(sizeof(*mode));
+	if (!iface || !mode)
+		goto fail;
+	iface->conf = os_zalloc(sizeof(*iface->conf));
+	mode->channels = os_calloc(ACS_TEST_CHANS, sizeof(*mode->channels));
+	if (!iface->conf || !mode->channels)
+		goto fail;
+	mode->mode = HOSTAPD_MODE_IEEE80211G;
+	mode->num_channels = ACS_TEST_CHANS;
+	for (i = 0; i < ACS_TEST_CHANS; i++) {
+		mode->channels[i].chan = i + 1;
+		mode->channels[i].freq = 2412 + i * 5;
+	}
+	iface->current_mode = mode;
+
+	if (acs_test_replay(iface) < 0) {
+		wpa_printf(MSG_ERROR, "acs test: Survey analysis failed");
+		goto fail;
+	}
+
+	for (i = 0; i < ACS_TEST_CHANS; i++) {
+		factor = mode->channels[i].interference_factor;
+		expected = acs_test_dump[i].factor;
+		if (factor < expected * 0.9999 || factor > expected * 1.0001) {
+			wpa_printf(MSG_ERROR,
+				   "acs test: Channel %d interference factor %Lg (expected %Lg)",
+				   i + 1, factor, expected);
+			goto fail;
+		}
+	}
+
+	if (timed_test("acs", "survey dump replays", 0, ACS_TEST_ROUNDS,
+		       acs_test_round, iface) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	if (iface && iface->current_mode)
+		acs_cleanup(iface);
+	if (mode)
+		os_free(mode->channels);
+	os_free(mode);
+	if (iface)
+		os_free(iface->conf);
+	os_free(iface);
+	return ret;
+}
+
+#endif /* CONFIG_ACS */
+
+
+#define MGMT_TEST_ROUNDS 20000
+#define MGMT_TEST_STAS 16
+
+/* Management frame exchange of a station connecting to an open network with
+ * SSID "test". Header address fields are filled in for each replay. */
+static const struct mgmt_test_frame {
+	u16 stype;
+	u8 len;
+	u8 body[40];
+} mgmt_test_frames[] = {
+	{ WLAN_FC_STYPE_PROBE_REQ, 18,
+	  { 0x00, 0x00, 0x01, 0x08, 0x02, 0x04, 0x0b, 0x16, 0x0c, 0x12,
+	    0x18, 0x24, 0x32, 0x04, 0x30, 0x48, 0x60, 0x6c } },
+	{ WLAN_FC_STYPE_AUTH, 6, { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00 } },
+	{ WLAN_FC_STYPE_ASSOC_REQ, 26,
+	  { 0x01, 0x04, 0x0a, 0x00, 0x00, 0x04, 't', 'e', 's', 't',
+	    0x01, 0x08, 0x02, 0x04, 0x0b, 0x16, 0x0c, 0x12, 0x18, 0x24,
+	    0x32, 0x04, 0x30, 0x48, 0x60, 0x6c } },
+	{ WLAN_FC_STYPE_DEAUTH, 2, { 0x03, 0x00 } },
+};
+
+
+static int mgmt_test_replay(struct hostapd_data *hapd, unsigned int round)
+{
+	u8 buf[IEEE80211_HDRLEN + 40];
+	struct ieee80211_mgmt *mgmt = (struct ieee80211_mgmt *) buf;
+	const struct mgmt_test_frame *frame;
+	struct sta_info *sta;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(mgmt_test_frames); i++) {
+		frame = &mgmt_test_frames[i];
+		os_memset(buf, 0, IEEE80211_HDRLEN);
+		mgmt->frame_control = IEEE80211_FC(WLAN_FC_TYPE_MGMT,
+						   frame->stype);
+		if (frame->stype == WLAN_FC_STYPE_PROBE_REQ) {
+			os_memset(mgmt->da, 0xff, ETH_ALEN);
+			os_memset(mgmt->bssid, 0xff, ETH_ALEN);
+		} else {
+			os_memcpy(mgmt->da, hapd->own_addr, ETH_ALEN);
+			os_memcpy(mgmt->bssid, hapd->own_addr, ETH_ALEN);
+		}
+		mgmt->sa[0] = 0x02;
+		mgmt->sa[5] = round % MGMT_TEST_STAS;
+		os_memcpy(&buf[IEEE80211_HDRLEN], frame->body, frame->len);
+
+		if (ieee802_11_mgmt(hapd, buf, IEEE80211_HDRLEN + frame->len,
+				    NULL) != 1)
+			return -1;
+
+		if (frame->stype == WLAN_FC_STYPE_ASSOC_REQ) {
+			sta = ap_get_sta(hapd, mgmt->sa);
+			if (!sta || !sta->aid ||
+			    !(sta->flags & WLAN_STA_ASSOC_REQ_OK))
+				return -1;
+		}
+	}
+
+	return ap_get_sta(hapd, mgmt->sa) ? -1 : 0;
+}
+
+
+static int mgmt_test_round(void *ctx, unsigned int round)
+{
+	return mgmt_test_replay(ctx, round);
+}
+
+
+static void mgmt_test_bss_free(struct hostapd_data *hapd)
+{
+	struct hostapd_iface *iface;
+
+	if (!hapd)
+		return;
+	iface = hapd->iface;
+	hostapd_free_stas(hapd);
+	os_free(hapd);
+	os_free(iface->probe_limit);
+	os_free(iface->bss);
+	hostapd_config_free(iface->conf);
+	os_free(iface);
+}
+
+
+/* BSS with the default configuration and SSID "test" without a driver */
+static struct hostapd_data * mgmt_test_bss_alloc(void)
+{
+	struct hostapd_iface *iface;
+	struct hostapd_data *hapd;
+
+	iface = hostapd_alloc_iface();
+	if (!iface)
+		return NULL;
+	iface->conf = hostapd_config_defaults();
+	iface->bss = os_calloc(1, sizeof(*iface->bss));
+	if (!iface->conf || !iface->bss)
+		goto fail;
+	hapd = hostapd_alloc_bss_data(iface, iface->conf, iface->conf->bss[0]);
+	if (!hapd)
+		goto fail;
+	iface->bss[0] = hapd;
+	iface->num_bss = 1;
+	os_memcpy(hapd->own_addr, "\x02\x00\x00\x00\x01\x00", ETH_ALEN);
+	os_memcpy(hapd->conf->ssid.ssid, "test", 4);
+	hapd->conf->ssid.ssid_len = 4;
+	hapd->conf->ssid.ssid_set = 1;
+	return hapd;
+
+fail:
+	os_free(iface->bss);
+	hostapd_config_free(iface->conf);
+	os_free(iface);
+	return NULL;
+}
+
+
+static int mgmt_replay_tests(void)
+{
+	struct hostapd_data *hapd;
+	size_t j;
+	int ret = -1;
+
+	wpa_printf(MSG_INFO, "Management frame replay tests");
+
+	hapd = mgmt_test_bss_alloc();
+	if (!hapd)
+		goto fail;
+
+	if (mgmt_test_replay(hapd, 0) < 0) {
+		wpa_printf(MSG_ERROR, "mgmt test: Connection exchange failed");
+		goto fail;
+	}
+
+	if (timed_test("mgmt", "connection exchanges", 1, MGMT_TEST_ROUNDS,
+		       mgmt_test_round, hapd) < 0)
+		goto fail;
+
+	for (j = 0; j < ARRAY_SIZE(mgmt_test_frames); j++) {
+		const struct mgmt_rx_stats *stats =
+			&hapd->mgmt_rx_stats[mgmt_test_frames[j].stype];
+
+		if (stats->frames != MGMT_TEST_ROUNDS || stats->ignored) {
+			wpa_printf(MSG_ERROR,
+				   "mgmt test: Subtype %u frames=%u ignored=%u",
+				   mgmt_test_frames[j].stype, stats->frames,
+				   stats->ignored);
+			goto fail;
+		}
+		wpa_printf(MSG_INFO, "mgmt test: Subtype %u: %llu usec/frame",
+			   mgmt_test_frames[j].stype,
+			   (unsigned long long) stats->usec / stats->frames);
+	}
+
+	ret = 0;
+fail:
+	mgmt_test_bss_free(hapd);
+	return ret;
+}
+
+
+static int probe_limit_test_send(struct hostapd_data *hapd, unsigned int count,
+				 u8 seq_elem)
+{
+	u8 buf[IEEE80211_HDRLEN + 40];
+	struct ieee80211_mgmt *mgmt = (struct ieee80211_mgmt *) buf;
+	const struct mgmt_test_frame *frame = &mgmt_test_frames[0];
+	unsigned int i;
+
+	os_memset(buf, 0, IEEE80211_HDRLEN);
+	mgmt->frame_control = IEEE80211_FC(WLAN_FC_TYPE_MGMT,
+					   WLAN_FC_STYPE_PROBE_REQ);
+	os_memset(mgmt->da, 0xff, ETH_ALEN);
+	os_memset(mgmt->bssid, 0xff, ETH_ALEN);
+	mgmt->sa[0] = 0x02;
+	mgmt->sa[5] = 0x42;
+	os_memcpy(&buf[IEEE80211_HDRLEN], frame->body, frame->len);
+
+	for (i = 0; i < count; i++) {
+		/* Vendor specific element that makes each frame unique */
+		buf[IEEE80211_HDRLEN + frame->len] = WLAN_EID_VENDOR_SPECIFIC;
+		buf[IEEE80211_HDRLEN + frame->len + 1] = 4;
+		WPA_PUT_BE32(&buf[IEEE80211_HDRLEN + frame->len + 2],
+			     seq_elem ? i : 0);
+		if (ieee802_11_mgmt(hapd, buf,
+				    IEEE80211_HDRLEN + frame->len + 6,
+				    NULL) != 1)
+			return -1;
+	}
+
+	return 0;
+}
+
+
+static int probe_limit_tests(void)
+{
+	struct hostapd_data *hapd;
+	struct probe_req_stats *stats;
+	int ret = -1;
+
+	wpa_printf(MSG_INFO, "Probe Request limit tests");
+
+	hapd = mgmt_test_bss_alloc();
+	if (!hapd)
+		goto fail;
+	stats = &hapd->probe_req_stats;
+
+	/* Identical frames are answered once within the window */
+	hapd->iconf->probe_req_dedup_window = 10000;
+	if (probe_limit_test_send(hapd, 20, 0) < 0 ||
+	    stats->answered != 1 || stats->duplicate != 19 ||
+	    stats->rate_limited) {
+		wpa_printf(MSG_ERROR,
+			   "probe limit test: dedup answered=%u duplicate=%u rate_limited=%u",
+			   stats->answered, stats->duplicate,
+			   stats->rate_limited);
+		goto fail;
+	}
+
+	/* Distinct frames are answered up to the burst size */
+	os_memset(stats, 0, sizeof(*stats));
+	os_memset(hapd->iface->probe_limit, 0,
+		  PROBE_LIMIT_SETS * PROBE_LIMIT_WAYS *
+		  sizeof(*hapd->iface->probe_limit));
+	hapd->iconf->probe_resp_rate_limit = 1;
+	hapd->iconf->probe_resp_burst = 4;
+	if (probe_limit_test_send(hapd, 20, 1) < 0 ||
+	    stats->answered != 4 || stats->duplicate ||
+	    stats->rate_limited != 16) {
+		wpa_printf(MSG_ERROR,
+			   "probe limit test: rate limit answered=%u duplicate=%u rate_limited=%u",
+			   stats->answered, stats->duplicate,
+			   stats->rate_limited);
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	mgmt_test_bss_free(hapd);
+	return ret;
+}
+
 
 int hapd_module_tests(void)
 {
+	int ret = 0;
+
 	wpa_printf(MSG_INFO, "hostapd module tests");
-	return 0;
+
+	if (aid_alloc_tests() < 0)
+		ret = -1;
+#ifdef CONFIG_ACS
+	if (acs_replay_tests() < 0)
+		ret = -1;
+#endif /* CONFIG_ACS */
+	if (mgmt_replay_tests() < 0)
+		ret = -1;
+	if (probe_limit_tests() < 0)
+		ret = -1;
+
+	return ret;
 }
@@ -401,6 +401,22 @@ static int hostapd_cli_cmd_signature(struct wpa_ctrl *ctrl, int argc,
 #endif /* CONFIG_TAXONOMY */
 
 
+#ifdef CONFIG_STA_CONN_TRACE
+static int hostapd_cli_cmd_conn_trace(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	char buf[64];
+
+	if (argc != 1) {
+		printf("Invalid 'conn_trace' command - exactly one argument, STA address, is required.\n");
+		return -1;
+	}
+	os_snprintf(buf, sizeof(buf), "CONN_TRACE %s", argv[0]);
+	return wpa_ctrl_command(ctrl, buf);
+}
+#endif /* CONFIG_STA_CONN_TRACE */
+
+
 #ifdef CONFIG_IEEE80211W
 static int hostapd_cli_cmd_sa_query(struct wpa_ctrl *ctrl, int argc,
 				    char *argv[])
@@ -1304,6 +1320,18 @@ static int hostapd_cli_cmd_set_neighbor(struct wpa_ctrl *ctrl, int argc,
 }
 
 
+static int hostapd_cli_cmd_import_neighbors(struct wpa_ctrl *ctrl, int argc,
+					    char *argv[])
+{
+	if (argc != 1) {
+		printf("Invalid import_neighbors command: needs 1 argument\n");
+		return -1;
+	}
+
+	return hostapd_cli_cmd(ctrl, "IMPORT_NEIGHBORS", 1, argc, argv);
+}
+
+
 static int hostapd_cli_cmd_remove_neighbor(struct wpa_ctrl *ctrl, int argc,
 					   char *argv[])
 {
@@ -1535,6 +1563,10 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "signature", hostapd_cli_cmd_signature, hostapd_complete_stations,
 	  "<addr> = get taxonomy signature for a station" },
 #endif /* CONFIG_TAXONOMY */
+#ifdef CONFIG_STA_CONN_TRACE
+	{ "conn_trace", hostapd_cli_cmd_conn_trace, hostapd_complete_stations,
+	  "<addr> = get connection event trace for a station" },
+#endif /* CONFIG_STA_CONN_TRACE */
 #ifdef CONFIG_IEEE80211W
 	{ "sa_query", hostapd_cli_cmd_sa_query, hostapd_complete_stations,
 	  "<addr> = send SA Query to a station" },
@@ -1620,7 +1652,7 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "erp_flush", hostapd_cli_cmd_erp_flush, NULL,
 	  "= drop all ERP keys"},
 	{ "log_level", hostapd_cli_cmd_log_level, NULL,
-	  "[level] = show/change log verbosity level" },
+	  "[level|module=level] = show/change log verbosity level" },
 	{ "pmksa", hostapd_cli_cmd_pmksa, NULL,
 	  " = show PMKSA cache entries" },
 	{ "pmksa_flush", hostapd_cli_cmd_pmksa_flush, NULL,
@@ -1628,6 +1660,9 @@ static const struct hostapd_cli_cmd hostapd_cli_commands[] = {
 	{ "set_neighbor", hostapd_cli_cmd_set_neighbor, NULL,
 	  "<addr> <ssid=> <nr=> [lci=] [civic=] [stat]\n"
 	  "  = add AP to neighbor database" },
+	{ "import_neighbors", hostapd_cli_cmd_import_neighbors, NULL,
+	  "<file> = add APs from a file to neighbor database (one\n"
+	  "  set_neighbor argument list per line)" },
 	{ "remove_neighbor", hostapd_cli_cmd_remove_neighbor, NULL,
 	  "<addr> <ssid=> = remove AP from neighbor database" },
 	{ "req_lci", hostapd_cli_cmd_req_lci, hostapd_complete_stations,
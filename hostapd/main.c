@@ -491,6 +491,11 @@ static void usage(void)
 		"   -T   record to Linux tracing in addition to logging\n"
 		"        (records all messages regardless of debug verbosity)\n"
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
+#ifdef CONFIG_DEBUG_RING
+		"   -r   buffer debug output in memory and write it in batches\n"
+		"   -R   capture debug messages in memory and write them out\n"
+		"        only when an error is logged\n"
+#endif /* CONFIG_DEBUG_RING */
 		"   -i   list of interface names to use\n"
 #ifdef CONFIG_DEBUG_SYSLOG
 		"   -s   log output to syslog instead of stdout\n"
@@ -638,6 +643,18 @@ static void hostapd_periodic(void *eloop_ctx, void *timeout_ctx)
 }
 
 
+#ifdef CONFIG_DEBUG_RING
+#define HOSTAPD_DEBUG_RING_FLUSH_INTERVAL 1
+
+static void hostapd_debug_ring_flush(void *eloop_ctx, void *timeout_ctx)
+{
+	wpa_debug_ring_flush();
+	eloop_register_timeout(HOSTAPD_DEBUG_RING_FLUSH_INTERVAL, 0,
+			       hostapd_debug_ring_flush, NULL, NULL);
+}
+#endif /* CONFIG_DEBUG_RING */
+
+
 int main(int argc, char *argv[])
 {
 	struct hapd_interfaces interfaces;
@@ -653,6 +670,10 @@ int main(int argc, char *argv[])
 	int enable_trace_dbg = 0;
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 	int start_ifaces_in_sync = 0;
+#ifdef CONFIG_DEBUG_RING
+	int debug_ring = 0;
+	enum wpa_debug_ring_mode debug_ring_mode = WPA_DEBUG_RING_BUFFERED;
+#endif /* CONFIG_DEBUG_RING */
 	char **if_names = NULL;
 	size_t if_names_size = 0;
 
@@ -680,7 +701,7 @@ int main(int argc, char *argv[])
 #endif /* CONFIG_DPP */
 
 	for (;;) {
-		c = getopt(argc, argv, "b:Bde:f:hi:KP:sSTtu:vg:G:");
+		c = getopt(argc, argv, "b:Bde:f:hi:KP:rRsSTtu:vg:G:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -711,6 +732,16 @@ int main(int argc, char *argv[])
 		case 't':
 			wpa_debug_timestamp++;
 			break;
+#ifdef CONFIG_DEBUG_RING
+		case 'r':
+			debug_ring = 1;
+			debug_ring_mode = WPA_DEBUG_RING_BUFFERED;
+			break;
+		case 'R':
+			debug_ring = 1;
+			debug_ring_mode = WPA_DEBUG_RING_CAPTURE;
+			break;
+#endif /* CONFIG_DEBUG_RING */
 #ifdef CONFIG_DEBUG_LINUX_TRACING
 		case 'T':
 			enable_trace_dbg = 1;
@@ -785,6 +816,14 @@ int main(int argc, char *argv[])
 		}
 	}
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
+#ifdef CONFIG_DEBUG_RING
+	if (debug_ring &&
+	    wpa_debug_ring_init(debug_ring_mode, WPA_DEBUG_RING_DEFAULT_SIZE,
+				MSG_DEBUG)) {
+		wpa_printf(MSG_ERROR, "Failed to enable debug ring buffer");
+		return -1;
+	}
+#endif /* CONFIG_DEBUG_RING */
 
 	interfaces.count = argc - optind;
 	if (interfaces.count || num_bss_configs) {
@@ -803,6 +842,11 @@ int main(int argc, char *argv[])
 
 	eloop_register_timeout(HOSTAPD_CLEANUP_INTERVAL, 0,
 			       hostapd_periodic, &interfaces, NULL);
+#ifdef CONFIG_DEBUG_RING
+	if (debug_ring && debug_ring_mode == WPA_DEBUG_RING_BUFFERED)
+		eloop_register_timeout(HOSTAPD_DEBUG_RING_FLUSH_INTERVAL, 0,
+				       hostapd_debug_ring_flush, NULL, NULL);
+#endif /* CONFIG_DEBUG_RING */
 
 	if (fst_global_init()) {
 		wpa_printf(MSG_ERROR,
@@ -920,11 +964,16 @@ int main(int argc, char *argv[])
 	dpp_global_deinit(interfaces.dpp);
 #endif /* CONFIG_DPP */
 
-	if (interfaces.eloop_initialized)
+	if (interfaces.eloop_initialized) {
 		eloop_cancel_timeout(hostapd_periodic, &interfaces, NULL);
+#ifdef CONFIG_DEBUG_RING
+		eloop_cancel_timeout(hostapd_debug_ring_flush, NULL, NULL);
+#endif /* CONFIG_DEBUG_RING */
+	}
 	hostapd_global_deinit(pid_file, interfaces.eloop_initialized);
 	os_free(pid_file);
 
+	wpa_debug_ring_deinit();
 	wpa_debug_close_syslog();
 	if (log_file)
 		wpa_debug_close_file();
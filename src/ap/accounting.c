@@ -166,10 +166,15 @@ static struct radius_msg * accounting_msg(struct hostapd_data *hapd,
 
 static int accounting_sta_update_stats(struct hostapd_data *hapd,
 				       struct sta_info *sta,
-				       struct hostap_sta_driver_data *data)
+				       struct hostap_sta_driver_data *data,
+				       int fresh)
 {
-	if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
+	if (fresh) {
+		if (hostapd_drv_read_sta_data(hapd, data, sta->addr))
+			return -1;
+	} else if (ap_sta_read_stats(hapd, sta, STA_STATS_ACCOUNTING, data)) {
 		return -1;
+	}
 
 	if (!data->bytes_64bit) {
 		/* Extend 32-bit counters from the driver to 64-bit counters */
@@ -206,7 +211,7 @@ static void accounting_interim_update(void *eloop_ctx, void *timeout_ctx)
 		interval = sta->acct_interim_interval;
 	} else {
 		struct hostap_sta_driver_data data;
-		accounting_sta_update_stats(hapd, sta, &data);
+		accounting_sta_update_stats(hapd, sta, &data, 0);
 		interval = ACCT_DEFAULT_UPDATE_INTERVAL;
 	}
 
@@ -287,7 +292,9 @@ static void accounting_sta_report(struct hostapd_data *hapd,
 		goto fail;
 	}
 
-	if (accounting_sta_update_stats(hapd, sta, &data) == 0) {
+	/* Final counters for Accounting-Stop are always fetched from the
+	 * driver */
+	if (accounting_sta_update_stats(hapd, sta, &data, stop) == 0) {
 		if (!radius_msg_add_attr_int32(msg,
 					       RADIUS_ATTR_ACCT_INPUT_PACKETS,
 					       data.rx_packets)) {
@@ -11,6 +11,7 @@
 #include <math.h>
 
 #include "utils/common.h"
+#include "utils/eloop.h"
 #include "utils/list.h"
 #include "common/ieee802_11_defs.h"
 #include "common/hw_features_common.h"
@@ -42,6 +43,9 @@
  * 2. interference factor is calculated for each channel
  * 3. ideal channel is picked depending on channel width by using adjacent
  *    channel interference factors
+ * 4. optionally (acs_reeval_period), survey data is collected periodically
+ *    while the interface is enabled and a better channel is reported with an
+ *    ACS-CHANNEL-RECOMMENDED event
  *
  * Known limitations
  * -----------------
@@ -67,6 +71,20 @@
  * -------------------------------------------------
  * Generic interference_factor in struct hostapd_channel_data is used.
  *
+ * The surveys are not stored. Each survey dump is folded into running sums in
+ * struct acs_chan_stats right after it has been received, so the interference
+ * factor can be computed at any point in time without going through all the
+ * collected samples. The 2^(-10^(band_min_nf/10)) term is common to all the
+ * surveys, so it is applied only when the factor is computed and changes in
+ * the band minimum noise floor do not require the surveys to be processed
+ * again. During periodic re-evaluation, the earlier samples of a channel are
+ * aged by ACS_REEVAL_DECAY whenever new data is received for it.
+ *
+ * The function used to compute the factor from the statistics can be
+ * selected with acs_cost:
+ * - survey: the noise floor amplified busy time ratio described below
+ * - busy: the plain busy time ratio
+ *
  * The survey interference factor is defined as the ratio of the
  * observed busy time over the time we spent on the channel,
  * this value is then amplified by the observed noise floor on
@@ -242,8 +260,21 @@
  */
 
 
+#ifndef ACS_REEVAL_DECAY
+/* Weight of the earlier samples when new survey data is received for a
+ * channel during periodic re-evaluation */
+#define ACS_REEVAL_DECAY 0.75
+#endif /* ACS_REEVAL_DECAY */
+
+#ifndef ACS_REEVAL_MARGIN
+/* A channel is recommended only if its total interference factor is below
+ * the current channel's factor multiplied by this value */
+#define ACS_REEVAL_MARGIN 0.8
+#endif /* ACS_REEVAL_MARGIN */
+
 static int acs_request_scan(struct hostapd_iface *iface);
 static int acs_survey_is_sufficient(struct freq_survey *survey);
+static void acs_reeval_timeout(void *eloop_ctx, void *timeout_ctx);
 
 
 static void acs_clean_chan_surveys(struct hostapd_channel_data *chan)
@@ -275,10 +306,12 @@ void acs_cleanup(struct hostapd_iface *iface)
 		dl_list_init(&chan->survey_list);
 		chan->flag |= HOSTAPD_CHAN_SURVEY_LIST_INITIALIZED;
 		chan->min_nf = 0;
+		os_memset(&chan->acs_stats, 0, sizeof(chan->acs_stats));
 	}
 
 	iface->chans_surveyed = 0;
 	iface->acs_num_completed_scans = 0;
+	eloop_cancel_timeout(acs_reeval_timeout, iface, NULL);
 }
 
 
@@ -290,10 +323,11 @@ static void acs_fail(struct hostapd_iface *iface)
 }
 
 
-static long double
-acs_survey_interference_factor(struct freq_survey *survey, s8 min_nf)
+static void acs_chan_stats_add(struct hostapd_channel_data *chan,
+			       struct freq_survey *survey)
 {
-	long double factor, busy, total;
+	struct acs_chan_stats *stats = &chan->acs_stats;
+	long double busy, total, ratio;
 
 	if (survey->filled & SURVEY_HAS_CHAN_TIME_BUSY)
 		busy = survey->channel_time_busy;
@@ -303,7 +337,7 @@ acs_survey_interference_factor(struct freq_survey *survey, s8 min_nf)
 		/* This shouldn't really happen as survey data is checked in
 		 * acs_sanity_check() */
 		wpa_printf(MSG_ERROR, "ACS: Survey data missing");
-		return 0;
+		return;
 	}
 
 	total = survey->channel_time;
@@ -313,53 +347,128 @@ acs_survey_interference_factor(struct freq_survey *survey, s8 min_nf)
 		total -= survey->channel_time_tx;
 	}
 
+	ratio = total ? (busy / total) : 0;
+
 	/* TODO: figure out the best multiplier for noise floor base */
-	factor = pow(10, survey->nf / 5.0L) +
-		(total ? (busy / total) : 0) *
-		pow(2, pow(10, (long double) survey->nf / 10.0L) -
-		    pow(10, (long double) min_nf / 10.0L));
+	stats->weight += 1;
+	stats->nf_sum += pow(10, survey->nf / 5.0L);
+	stats->busy_sum += ratio;
+	stats->busy_nf_sum += ratio *
+		pow(2, pow(10, (long double) survey->nf / 10.0L));
+	stats->channel_time = survey->channel_time;
+}
+
+
+static void acs_chan_stats_decay(struct hostapd_channel_data *chan)
+{
+	struct acs_chan_stats *stats = &chan->acs_stats;
+
+	stats->weight *= ACS_REEVAL_DECAY;
+	stats->nf_sum *= ACS_REEVAL_DECAY;
+	stats->busy_sum *= ACS_REEVAL_DECAY;
+	stats->busy_nf_sum *= ACS_REEVAL_DECAY;
+}
+
+
+static void acs_fold_chan_surveys(struct hostapd_iface *iface, int reeval)
+{
+	struct hostapd_channel_data *chan;
+	struct freq_survey *survey, *tmp;
+	int i;
+
+	for (i = 0; i < iface->current_mode->num_channels; i++) {
+		chan = &iface->current_mode->channels[i];
+		if (!(chan->flag & HOSTAPD_CHAN_SURVEY_LIST_INITIALIZED))
+			continue;
+
+		dl_list_for_each_safe(survey, tmp, &chan->survey_list,
+				      struct freq_survey, list) {
+			dl_list_del(&survey->list);
+			chan->acs_stats.num_surveys++;
 
-	return factor;
+			wpa_printf(MSG_DEBUG,
+				   "ACS: Channel %d: %u: nf=%d time=%lu busy=%lu rx=%lu",
+				   chan->chan, chan->acs_stats.num_surveys,
+				   survey->nf,
+				   (unsigned long) survey->channel_time,
+				   (unsigned long) survey->channel_time_busy,
+				   (unsigned long) survey->channel_time_rx);
+
+			if (!acs_survey_is_sufficient(survey)) {
+				wpa_printf(MSG_DEBUG,
+					   "ACS: Channel %d: insufficient data",
+					   chan->chan);
+			} else if (reeval && chan->acs_stats.weight > 0 &&
+				   survey->channel_time ==
+				   chan->acs_stats.channel_time) {
+				/* No new measurements since the previous
+				 * survey */
+			} else {
+				if (reeval)
+					acs_chan_stats_decay(chan);
+				acs_chan_stats_add(chan, survey);
+			}
+
+			os_free(survey);
+		}
+	}
 }
 
 
+/**
+ * acs_update_chan_stats - Fold received survey data into channel statistics
+ * @iface: Pointer to interface data
+ *
+ * This is called after survey data has been fetched from the driver. The
+ * surveys added to the channel survey lists by hostapd_event_get_survey() are
+ * included in the running statistics of the channels and freed.
+ */
+void acs_update_chan_stats(struct hostapd_iface *iface)
+{
+	acs_fold_chan_surveys(iface, 0);
+}
+
+
+static long double acs_cost_survey(struct hostapd_iface *iface,
+				   const struct acs_chan_stats *stats)
+{
+	return (stats->nf_sum + stats->busy_nf_sum /
+		pow(2, pow(10, (long double) iface->lowest_nf / 10.0L))) /
+		stats->weight;
+}
+
+
+static long double acs_cost_busy(struct hostapd_iface *iface,
+				 const struct acs_chan_stats *stats)
+{
+	return stats->busy_sum / stats->weight;
+}
+
+
+static long double (* const acs_cost_funcs[])(
+	struct hostapd_iface *iface, const struct acs_chan_stats *stats) = {
+	[ACS_COST_SURVEY] = acs_cost_survey,
+	[ACS_COST_BUSY] = acs_cost_busy,
+};
+
+
 static void
 acs_survey_chan_interference_factor(struct hostapd_iface *iface,
 				    struct hostapd_channel_data *chan)
 {
-	struct freq_survey *survey;
-	unsigned int i = 0;
-	long double int_factor = 0;
-	unsigned count = 0;
+	const struct acs_chan_stats *stats = &chan->acs_stats;
+	unsigned int cost = iface->conf->acs_cost;
 
-	if (dl_list_empty(&chan->survey_list) ||
-	    (chan->flag & HOSTAPD_CHAN_DISABLED))
+	if (!stats->num_surveys || (chan->flag & HOSTAPD_CHAN_DISABLED))
 		return;
 
 	chan->interference_factor = 0;
+	if (stats->weight <= 0)
+		return;
 
-	dl_list_for_each(survey, &chan->survey_list, struct freq_survey, list)
-	{
-		i++;
-
-		if (!acs_survey_is_sufficient(survey)) {
-			wpa_printf(MSG_DEBUG, "ACS: %d: insufficient data", i);
-			continue;
-		}
-
-		count++;
-		int_factor = acs_survey_interference_factor(survey,
-							    iface->lowest_nf);
-		chan->interference_factor += int_factor;
-		wpa_printf(MSG_DEBUG, "ACS: %d: min_nf=%d interference_factor=%Lg nf=%d time=%lu busy=%lu rx=%lu",
-			   i, chan->min_nf, int_factor,
-			   survey->nf, (unsigned long) survey->channel_time,
-			   (unsigned long) survey->channel_time_busy,
-			   (unsigned long) survey->channel_time_rx);
-	}
-
-	if (count)
-		chan->interference_factor /= count;
+	if (cost >= ARRAY_SIZE(acs_cost_funcs))
+		cost = ACS_COST_SURVEY;
+	chan->interference_factor = acs_cost_funcs[cost](iface, stats);
 }
 
 
@@ -426,30 +535,16 @@ static int acs_survey_is_sufficient(struct freq_survey *survey)
 }
 
 
-static int acs_survey_list_is_sufficient(struct hostapd_channel_data *chan)
+static int acs_chan_stats_are_sufficient(struct hostapd_channel_data *chan)
 {
-	struct freq_survey *survey;
-	int ret = -1;
-
-	dl_list_for_each(survey, &chan->survey_list, struct freq_survey, list)
-	{
-		if (acs_survey_is_sufficient(survey)) {
-			ret = 1;
-			break;
-		}
-		ret = 0;
-	}
-
-	if (ret == -1)
-		ret = 1; /* no survey list entries */
-
-	if (!ret) {
+	if (chan->acs_stats.num_surveys && chan->acs_stats.weight <= 0) {
 		wpa_printf(MSG_INFO,
 			   "ACS: Channel %d has insufficient survey data",
 			   chan->chan);
+		return 0;
 	}
 
-	return ret;
+	return 1;
 }
 
 
@@ -462,7 +557,7 @@ static int acs_surveys_are_sufficient(struct hostapd_iface *iface)
 	for (i = 0; i < iface->current_mode->num_channels; i++) {
 		chan = &iface->current_mode->channels[i];
 		if (!(chan->flag & HOSTAPD_CHAN_DISABLED) &&
-		    acs_survey_list_is_sufficient(chan))
+		    acs_chan_stats_are_sufficient(chan))
 			valid++;
 	}
 
@@ -473,9 +568,9 @@ static int acs_surveys_are_sufficient(struct hostapd_iface *iface)
 
 static int acs_usable_chan(struct hostapd_channel_data *chan)
 {
-	return !dl_list_empty(&chan->survey_list) &&
+	return chan->acs_stats.num_surveys &&
 		!(chan->flag & HOSTAPD_CHAN_DISABLED) &&
-		acs_survey_list_is_sufficient(chan);
+		acs_chan_stats_are_sufficient(chan);
 }
 
 
@@ -570,9 +665,14 @@ static int is_common_24ghz_chan(int chan)
  * This function should be reusable regardless of interference computation
  * option (survey, BSS, spectral, ...). chan->interference factor must be
  * summable (i.e., must be always greater than zero).
+ *
+ * The total interference factor of the selected channel and of the currently
+ * configured channel are returned in ideal_factor_ret and cur_factor_ret,
+ * respectively, or -1 if not available.
  */
 static struct hostapd_channel_data *
-acs_find_ideal_chan(struct hostapd_iface *iface)
+acs_find_ideal_chan(struct hostapd_iface *iface, long double *ideal_factor_ret,
+		    long double *cur_factor_ret)
 {
 	struct hostapd_channel_data *chan, *adj_chan, *ideal_chan = NULL,
 		*rand_chan = NULL;
@@ -582,6 +682,9 @@ acs_find_ideal_chan(struct hostapd_iface *iface)
 	u32 bw;
 	unsigned int k;
 
+	*ideal_factor_ret = -1;
+	*cur_factor_ret = -1;
+
 	/* TODO: HT40- support */
 
 	if (iface->conf->ieee80211n &&
@@ -762,6 +865,9 @@ acs_find_ideal_chan(struct hostapd_iface *iface)
 				   chan->chan, factor);
 		}
 
+		if (chan->chan == iface->conf->channel && acs_usable_chan(chan))
+			*cur_factor_ret = factor;
+
 		if (acs_usable_chan(chan) &&
 		    (!ideal_chan || factor < ideal_factor)) {
 			ideal_factor = factor;
@@ -776,6 +882,7 @@ acs_find_ideal_chan(struct hostapd_iface *iface)
 	if (ideal_chan) {
 		wpa_printf(MSG_DEBUG, "ACS: Ideal channel is %d (%d MHz) with total interference factor of %Lg",
 			   ideal_chan->chan, ideal_chan->freq, ideal_factor);
+		*ideal_factor_ret = ideal_factor;
 		return ideal_chan;
 	}
 
@@ -812,7 +919,12 @@ static void acs_adjust_vht_center_freq(struct hostapd_iface *iface)
 }
 
 
-static int acs_study_survey_based(struct hostapd_iface *iface)
+/**
+ * acs_study_survey_based - Compute interference factors from survey data
+ * @iface: Pointer to interface data
+ * Returns: 0 on success, -1 if there is not enough survey data
+ */
+int acs_study_survey_based(struct hostapd_iface *iface)
 {
 	wpa_printf(MSG_DEBUG, "ACS: Trying survey-based ACS");
 
@@ -843,9 +955,55 @@ static int acs_study_options(struct hostapd_iface *iface)
 }
 
 
+static void acs_reeval_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_iface *iface = eloop_ctx;
+	struct hostapd_channel_data *ideal_chan;
+	long double ideal_factor, cur_factor;
+
+	if (!iface->conf->acs || !iface->conf->acs_reeval_period ||
+	    !iface->current_mode)
+		return;
+
+	if (iface->state != HAPD_IFACE_ENABLED)
+		goto next;
+
+	wpa_printf(MSG_DEBUG, "ACS: Re-evaluating channel %d",
+		   iface->conf->channel);
+
+	if (hostapd_drv_get_survey(iface->bss[0], 0)) {
+		wpa_printf(MSG_DEBUG, "ACS: Failed to get survey data");
+		goto next;
+	}
+
+	acs_fold_chan_surveys(iface, 1);
+	if (!acs_surveys_are_sufficient(iface))
+		goto next;
+	acs_survey_all_chans_intereference_factor(iface);
+
+	ideal_chan = acs_find_ideal_chan(iface, &ideal_factor, &cur_factor);
+	if (!ideal_chan || ideal_factor < 0 || cur_factor < 0 ||
+	    ideal_chan->chan == iface->conf->channel)
+		goto next;
+
+	if (ideal_factor < cur_factor * ACS_REEVAL_MARGIN) {
+		wpa_msg(iface->bss[0]->msg_ctx, MSG_INFO,
+			ACS_EVENT_CHANNEL_RECOMMENDED
+			"freq=%d channel=%d current_channel=%d",
+			ideal_chan->freq, ideal_chan->chan,
+			iface->conf->channel);
+	}
+
+next:
+	eloop_register_timeout(iface->conf->acs_reeval_period, 0,
+			       acs_reeval_timeout, iface, NULL);
+}
+
+
 static void acs_study(struct hostapd_iface *iface)
 {
 	struct hostapd_channel_data *ideal_chan;
+	long double ideal_factor, cur_factor;
 	int err;
 
 	err = acs_study_options(iface);
@@ -854,7 +1012,7 @@ static void acs_study(struct hostapd_iface *iface)
 		goto fail;
 	}
 
-	ideal_chan = acs_find_ideal_chan(iface);
+	ideal_chan = acs_find_ideal_chan(iface, &ideal_factor, &cur_factor);
 	if (!ideal_chan) {
 		wpa_printf(MSG_ERROR, "ACS: Failed to compute ideal channel");
 		err = -1;
@@ -873,6 +1031,13 @@ fail:
 	 * 0 on success and 0 is HOSTAPD_CHAN_VALID :)
 	 */
 	if (hostapd_acs_completed(iface, err) == HOSTAPD_CHAN_VALID) {
+		if (iface->conf->acs_reeval_period) {
+			/* Keep the collected statistics for re-evaluation */
+			eloop_register_timeout(iface->conf->acs_reeval_period,
+					       0, acs_reeval_timeout, iface,
+					       NULL);
+			return;
+		}
 		acs_cleanup(iface);
 		return;
 	}
@@ -898,6 +1063,7 @@ static void acs_scan_complete(struct hostapd_iface *iface)
 		wpa_printf(MSG_ERROR, "ACS: Failed to get survey data");
 		goto fail;
 	}
+	acs_update_chan_stats(iface);
 
 	if (++iface->acs_num_completed_scans < iface->conf->acs_num_scans) {
 		err = acs_request_scan(iface);
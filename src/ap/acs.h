@@ -14,6 +14,8 @@
 
 enum hostapd_chan_status acs_init(struct hostapd_iface *iface);
 void acs_cleanup(struct hostapd_iface *iface);
+void acs_update_chan_stats(struct hostapd_iface *iface);
+int acs_study_survey_based(struct hostapd_iface *iface);
 
 #else /* CONFIG_ACS */
 
@@ -44,6 +44,8 @@ static void hostapd_config_free_vlan(struct hostapd_bss_config *bss)
 
 void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 {
+	unsigned int i;
+
 	dl_list_init(&bss->anqp_elem);
 
 	bss->logger_syslog_level = HOSTAPD_LEVEL_INFO;
@@ -77,6 +79,8 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->radius_server_auth_port = 1812;
 	bss->eap_sim_db_timeout = 1;
 	bss->ap_max_inactivity = AP_MAX_INACTIVITY;
+	for (i = 0; i < ARRAY_SIZE(bss->sta_stats_max_age); i++)
+		bss->sta_stats_max_age[i] = -1;
 	bss->eapol_version = EAPOL_VERSION;
 
 	bss->max_listen_interval = 65535;
@@ -220,6 +224,7 @@ struct hostapd_config * hostapd_config_defaults(void)
 	conf->ap_table_max_size = 255;
 	conf->ap_table_expiration_time = 60;
 	conf->track_sta_max_age = 180;
+	conf->probe_resp_burst = 16;
 
 #ifdef CONFIG_TESTING_OPTIONS
 	conf->ignore_probe_probability = 0.0;
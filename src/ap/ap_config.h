@@ -252,6 +252,15 @@ struct sae_password_entry {
 	int vlan_id;
 };
 
+/* Users of station statistics with separate staleness bounds
+ * (sta_stats_max_age) */
+enum sta_stats_user {
+	STA_STATS_INACTIVITY,
+	STA_STATS_ACCOUNTING,
+	STA_STATS_CTRL_IFACE,
+	NUM_STA_STATS_USERS
+};
+
 /**
  * struct hostapd_bss_config - Per-BSS configuration
  */
@@ -426,6 +435,9 @@ struct hostapd_bss_config {
 				 */
 
 	int ap_max_inactivity;
+	unsigned int sta_stats_interval; /* msec; 0 = no station dumps */
+	/* msec for each enum sta_stats_user; -1 = 2 * sta_stats_interval */
+	int sta_stats_max_age[NUM_STA_STATS_USERS];
 	int ignore_broadcast_ssid;
 	int no_probe_resp_if_max_sta;
 
@@ -764,6 +776,10 @@ struct hostapd_config {
 	unsigned int track_sta_max_num;
 	unsigned int track_sta_max_age;
 
+	unsigned int probe_resp_rate_limit; /* per second and source address */
+	unsigned int probe_resp_burst;
+	unsigned int probe_req_dedup_window; /* in ms */
+
 	char country[3]; /* first two octets: country code as described in
 			  * ISO/IEC 3166-1. Third octet:
 			  * ' ' (ascii 32): all environments
@@ -836,6 +852,11 @@ struct hostapd_config {
 
 #ifdef CONFIG_ACS
 	unsigned int acs_num_scans;
+	unsigned int acs_reeval_period;
+	enum acs_cost {
+		ACS_COST_SURVEY,
+		ACS_COST_BUSY,
+	} acs_cost;
 	struct acs_bias {
 		int channel;
 		double bias;
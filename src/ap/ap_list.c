@@ -25,7 +25,37 @@
 /* AP list is a double linked list with head->prev pointing to the end of the
  * list and tail->next = NULL. Entries are moved to the head of the list
  * whenever a beacon has been received from the AP in question. The tail entry
- * in this link will thus be the least recently used entry. */
+ * in this link will thus be the least recently used entry. Expiration only
+ * needs to look at the tail of the list.
+ *
+ * Beacons from an AP that is already in the table are ignored for
+ * AP_LIST_BEACON_MIN_INTERVAL seconds after the entry was last updated, so
+ * the table is refreshed at most once per second per AP regardless of how
+ * many beacons the driver reports.
+ *
+ * The number of entries causing OLBC and non-HT OLBC is maintained as entries
+ * are updated or removed, so the state can be checked without iterating over
+ * the table. Protection is enabled immediately, but it is disabled only once
+ * the condition has not been detected in AP_LIST_OLBC_CLEAR_WAIT consecutive
+ * ap_list_timer() runs. The resulting Beacon frame updates are deferred by
+ * AP_LIST_BEACON_UPDATE_DELAY_US to merge multiple changes into a single
+ * update. */
+
+#define AP_LIST_BEACON_MIN_INTERVAL 1
+#define AP_LIST_OLBC_CLEAR_WAIT 2
+#define AP_LIST_BEACON_UPDATE_DELAY_US 100000
+
+
+static unsigned int ap_hash_idx(const u8 *addr)
+{
+	u32 h;
+
+	/* Mix in all octets since BSSIDs of the same device commonly differ
+	 * only in the first or in the last octet */
+	h = WPA_GET_BE24(addr) ^ WPA_GET_BE24(addr + 3);
+	h *= 0x9e3779b1;
+	return (h >> 24) % STA_HASH_SIZE;
+}
 
 
 static int ap_list_beacon_olbc(struct hostapd_iface *iface, struct ap_info *ap)
@@ -54,7 +84,7 @@ static struct ap_info * ap_get_ap(struct hostapd_iface *iface, const u8 *ap)
 {
 	struct ap_info *s;
 
-	s = iface->ap_hash[STA_HASH(ap)];
+	s = iface->ap_hash[ap_hash_idx(ap)];
 	while (s != NULL && os_memcmp(s->addr, ap, ETH_ALEN) != 0)
 		s = s->hnext;
 	return s;
@@ -89,19 +119,22 @@ static void ap_ap_list_del(struct hostapd_iface *iface, struct ap_info *ap)
 
 static void ap_ap_hash_add(struct hostapd_iface *iface, struct ap_info *ap)
 {
-	ap->hnext = iface->ap_hash[STA_HASH(ap->addr)];
-	iface->ap_hash[STA_HASH(ap->addr)] = ap;
+	unsigned int idx = ap_hash_idx(ap->addr);
+
+	ap->hnext = iface->ap_hash[idx];
+	iface->ap_hash[idx] = ap;
 }
 
 
 static void ap_ap_hash_del(struct hostapd_iface *iface, struct ap_info *ap)
 {
+	unsigned int idx = ap_hash_idx(ap->addr);
 	struct ap_info *s;
 
-	s = iface->ap_hash[STA_HASH(ap->addr)];
+	s = iface->ap_hash[idx];
 	if (s == NULL) return;
 	if (os_memcmp(s->addr, ap->addr, ETH_ALEN) == 0) {
-		iface->ap_hash[STA_HASH(ap->addr)] = s->hnext;
+		iface->ap_hash[idx] = s->hnext;
 		return;
 	}
 
@@ -116,8 +149,23 @@ static void ap_ap_hash_del(struct hostapd_iface *iface, struct ap_info *ap)
 }
 
 
+static void ap_set_olbc(struct hostapd_iface *iface, struct ap_info *ap,
+			int olbc, int no_ht)
+{
+	if (ap->olbc != !!olbc) {
+		ap->olbc = !!olbc;
+		iface->num_olbc_ap += olbc ? 1 : -1;
+	}
+	if (ap->no_ht != !!no_ht) {
+		ap->no_ht = !!no_ht;
+		iface->num_ap_no_ht += no_ht ? 1 : -1;
+	}
+}
+
+
 static void ap_free_ap(struct hostapd_iface *iface, struct ap_info *ap)
 {
+	ap_set_olbc(iface, ap, 0, 0);
 	ap_ap_hash_del(iface, ap);
 	ap_ap_list_del(iface, ap);
 
@@ -142,6 +190,70 @@ static void hostapd_free_aps(struct hostapd_iface *iface)
 }
 
 
+static void ap_list_update_beacons(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_iface *iface = eloop_ctx;
+
+	ieee802_11_update_beacons_cause(iface, BEACON_UPDATE_PROTECTION);
+}
+
+
+static void ap_list_schedule_beacon_update(struct hostapd_iface *iface)
+{
+	if (eloop_is_timeout_registered(ap_list_update_beacons, iface, NULL))
+		return;
+	eloop_register_timeout(0, AP_LIST_BEACON_UPDATE_DELAY_US,
+			       ap_list_update_beacons, iface, NULL);
+}
+
+
+/* Refresh the per-AP OLBC flags if the operating channel has changed since
+ * they were determined */
+static void ap_list_check_olbc_channel(struct hostapd_iface *iface)
+{
+	struct ap_info *ap;
+
+	if (iface->olbc_mode == iface->current_mode &&
+	    iface->olbc_channel == iface->conf->channel)
+		return;
+
+	iface->olbc_mode = iface->current_mode;
+	iface->olbc_channel = iface->conf->channel;
+	for (ap = iface->ap_list; ap; ap = ap->next)
+		ap_set_olbc(iface, ap, ap_list_beacon_olbc(iface, ap),
+			    ap->no_ht);
+}
+
+
+/**
+ * ap_list_beacon_rate_limited - Check whether a Beacon frame can be ignored
+ * @iface: Pointer to interface data
+ * @bssid: BSSID of the received Beacon frame
+ * Returns: 1 if the AP entry has been updated within the last
+ * AP_LIST_BEACON_MIN_INTERVAL seconds and the frame does not need to be
+ * processed, 0 otherwise
+ *
+ * This is used to skip element parsing for Beacon frames that would not
+ * change the AP table.
+ */
+int ap_list_beacon_rate_limited(struct hostapd_iface *iface, const u8 *bssid)
+{
+	struct ap_info *ap;
+	struct os_reltime now;
+
+	if (iface->conf->ap_table_max_size < 1)
+		return 1;
+
+	ap = ap_get_ap(iface, bssid);
+	if (!ap)
+		return 0;
+
+	os_get_reltime(&now);
+	return !os_reltime_expired(&now, &ap->last_beacon,
+				   AP_LIST_BEACON_MIN_INTERVAL);
+}
+
+
 static struct ap_info * ap_ap_add(struct hostapd_iface *iface, const u8 *addr)
 {
 	struct ap_info *ap;
@@ -210,6 +322,10 @@ void ap_list_process_beacon(struct hostapd_iface *iface,
 	else
 		ap->ht_support = 0;
 
+	ap_list_check_olbc_channel(iface);
+	ap_set_olbc(iface, ap, ap_list_beacon_olbc(iface, ap),
+		    !ap->ht_support);
+
 	os_get_reltime(&ap->last_beacon);
 
 	if (!new_ap && ap != iface->ap_list) {
@@ -219,8 +335,9 @@ void ap_list_process_beacon(struct hostapd_iface *iface,
 		ap_ap_list_add(iface, ap);
 	}
 
-	if (!iface->olbc &&
-	    ap_list_beacon_olbc(iface, ap)) {
+	if (ap->olbc)
+		iface->olbc_clear_wait = 0;
+	if (!iface->olbc && ap->olbc) {
 		iface->olbc = 1;
 		wpa_printf(MSG_DEBUG, "OLBC AP detected: " MACSTR
 			   " (channel %d) - enable protection",
@@ -229,7 +346,9 @@ void ap_list_process_beacon(struct hostapd_iface *iface,
 	}
 
 #ifdef CONFIG_IEEE80211N
-	if (!iface->olbc_ht && !ap->ht_support &&
+	if (ap->no_ht)
+		iface->olbc_ht_clear_wait = 0;
+	if (!iface->olbc_ht && ap->no_ht &&
 	    (ap->channel == 0 ||
 	     ap->channel == iface->conf->channel ||
 	     ap->channel == iface->conf->channel +
@@ -244,7 +363,7 @@ void ap_list_process_beacon(struct hostapd_iface *iface,
 #endif /* CONFIG_IEEE80211N */
 
 	if (set_beacon)
-		ieee802_11_update_beacons(iface);
+		ap_list_schedule_beacon_update(iface);
 }
 
 
@@ -254,7 +373,7 @@ void ap_list_timer(struct hostapd_iface *iface)
 	struct ap_info *ap;
 	int set_beacon = 0;
 
-	if (!iface->ap_list)
+	if (!iface->ap_list && !iface->olbc && !iface->olbc_ht)
 		return;
 
 	os_get_reltime(&now);
@@ -268,35 +387,32 @@ void ap_list_timer(struct hostapd_iface *iface)
 		ap_free_ap(iface, ap);
 	}
 
-	if (iface->olbc || iface->olbc_ht) {
-		int olbc = 0;
-		int olbc_ht = 0;
-
-		ap = iface->ap_list;
-		while (ap && (olbc == 0 || olbc_ht == 0)) {
-			if (ap_list_beacon_olbc(iface, ap))
-				olbc = 1;
-			if (!ap->ht_support)
-				olbc_ht = 1;
-			ap = ap->next;
-		}
-		if (!olbc && iface->olbc) {
-			wpa_printf(MSG_DEBUG, "OLBC not detected anymore");
-			iface->olbc = 0;
-			set_beacon++;
-		}
+	ap_list_check_olbc_channel(iface);
+
+	if (iface->num_olbc_ap > 0) {
+		iface->olbc_clear_wait = 0;
+	} else if (iface->olbc &&
+		   ++iface->olbc_clear_wait >= AP_LIST_OLBC_CLEAR_WAIT) {
+		wpa_printf(MSG_DEBUG, "OLBC not detected anymore");
+		iface->olbc = 0;
+		iface->olbc_clear_wait = 0;
+		set_beacon++;
+	}
 #ifdef CONFIG_IEEE80211N
-		if (!olbc_ht && iface->olbc_ht) {
-			wpa_printf(MSG_DEBUG, "OLBC HT not detected anymore");
-			iface->olbc_ht = 0;
-			hostapd_ht_operation_update(iface);
-			set_beacon++;
-		}
-#endif /* CONFIG_IEEE80211N */
+	if (iface->num_ap_no_ht > 0) {
+		iface->olbc_ht_clear_wait = 0;
+	} else if (iface->olbc_ht &&
+		   ++iface->olbc_ht_clear_wait >= AP_LIST_OLBC_CLEAR_WAIT) {
+		wpa_printf(MSG_DEBUG, "OLBC HT not detected anymore");
+		iface->olbc_ht = 0;
+		iface->olbc_ht_clear_wait = 0;
+		hostapd_ht_operation_update(iface);
+		set_beacon++;
 	}
+#endif /* CONFIG_IEEE80211N */
 
 	if (set_beacon)
-		ieee802_11_update_beacons(iface);
+		ap_list_schedule_beacon_update(iface);
 }
 
 
@@ -308,5 +424,6 @@ int ap_list_init(struct hostapd_iface *iface)
 
 void ap_list_deinit(struct hostapd_iface *iface)
 {
+	eloop_cancel_timeout(ap_list_update_beacons, iface, NULL);
 	hostapd_free_aps(iface);
 }
@@ -26,6 +26,10 @@ struct ap_info {
 
 	int ht_support;
 
+	/* Whether this AP is currently counted in num_olbc_ap/num_ap_no_ht */
+	unsigned int olbc:1;
+	unsigned int no_ht:1;
+
 	struct os_reltime last_beacon;
 };
 
@@ -36,6 +40,7 @@ void ap_list_process_beacon(struct hostapd_iface *iface,
 			    const struct ieee80211_mgmt *mgmt,
 			    struct ieee802_11_elems *elems,
 			    struct hostapd_frame_info *fi);
+int ap_list_beacon_rate_limited(struct hostapd_iface *iface, const u8 *bssid);
 #ifdef NEED_AP_MLME
 int ap_list_init(struct hostapd_iface *iface);
 void ap_list_deinit(struct hostapd_iface *iface);
@@ -725,6 +725,142 @@ void sta_track_claim_taxonomy_info(struct hostapd_iface *iface, const u8 *addr,
 #endif /* CONFIG_TAXONOMY */
 
 
+static unsigned int probe_limit_ms(struct os_reltime *now,
+				   struct os_reltime *ts)
+{
+	struct os_reltime age;
+
+	os_reltime_sub(now, ts, &age);
+	if (age.sec < 0)
+		return 0;
+	if (age.sec >= 100)
+		return 100000;
+	return age.sec * 1000 + age.usec / 1000;
+}
+
+
+static struct hostapd_probe_limit *
+probe_limit_get(struct hostapd_iface *iface, const u8 *addr,
+		const struct os_reltime *now)
+{
+	struct hostapd_probe_limit *set, *entry, *oldest = NULL;
+	u32 h;
+	int i;
+
+	h = WPA_GET_BE24(addr) ^ WPA_GET_BE24(addr + 3);
+	h *= 0x9e3779b1;
+	set = &iface->probe_limit[(h >> 24) % PROBE_LIMIT_SETS *
+				  PROBE_LIMIT_WAYS];
+
+	for (i = 0; i < PROBE_LIMIT_WAYS; i++) {
+		entry = &set[i];
+		if (os_memcmp(entry->addr, addr, ETH_ALEN) == 0)
+			return entry;
+		if (!oldest || is_zero_ether_addr(entry->addr) ||
+		    (!is_zero_ether_addr(oldest->addr) &&
+		     os_reltime_before(&entry->last, &oldest->last)))
+			oldest = entry;
+	}
+
+	/* Replace the least recently used entry of the set */
+	os_memset(oldest, 0, sizeof(*oldest));
+	os_memcpy(oldest->addr, addr, ETH_ALEN);
+	oldest->last = *now;
+	oldest->tokens = iface->conf->probe_resp_burst * 1000;
+	return oldest;
+}
+
+
+/* Returns 1 if a Probe Request frame that this BSS would otherwise answer is
+ * a duplicate of one that it already answered or if the source address has
+ * used its share of Probe Response frames on this radio. */
+static int probe_req_limited(struct hostapd_data *hapd, const u8 *addr,
+			     const u8 *ie, size_t ie_len)
+{
+	struct hostapd_iface *iface = hapd->iface;
+	struct hostapd_config *conf = hapd->iconf;
+	struct hostapd_probe_limit *entry;
+	struct os_reltime now;
+	unsigned int ms, max_tokens;
+	u32 bit = 0, hash = 2166136261U;
+	size_t i;
+
+	if (!conf->probe_resp_rate_limit && !conf->probe_req_dedup_window)
+		return 0;
+
+	if (!iface->probe_limit) {
+		iface->probe_limit = os_calloc(PROBE_LIMIT_SETS *
+					       PROBE_LIMIT_WAYS,
+					       sizeof(*iface->probe_limit));
+		if (!iface->probe_limit)
+			return 0;
+	}
+
+	os_get_reltime(&now);
+	entry = probe_limit_get(iface, addr, &now);
+
+	if (conf->probe_req_dedup_window) {
+		for (i = 0; i < iface->num_bss && i < 32; i++) {
+			if (iface->bss[i] == hapd) {
+				bit = BIT(i);
+				break;
+			}
+		}
+
+		for (i = 0; i < ie_len; i++) {
+			hash ^= ie[i];
+			hash *= 16777619;
+		}
+
+		if (hash != entry->probe_hash ||
+		    probe_limit_ms(&now, &entry->probe_time) >=
+		    conf->probe_req_dedup_window) {
+			entry->probe_hash = hash;
+			entry->probe_time = now;
+			entry->answered = 0;
+		} else if (entry->answered & bit) {
+			hapd->probe_req_stats.duplicate++;
+			return 1;
+		}
+	}
+
+	if (conf->probe_resp_rate_limit) {
+		ms = probe_limit_ms(&now, &entry->last);
+		max_tokens = conf->probe_resp_burst * 1000;
+		entry->last = now;
+		entry->tokens += ms * conf->probe_resp_rate_limit;
+		if (entry->tokens > max_tokens)
+			entry->tokens = max_tokens;
+		if (entry->tokens < 1000) {
+			hapd->probe_req_stats.rate_limited++;
+			return 1;
+		}
+		entry->tokens -= 1000;
+	} else {
+		entry->last = now;
+	}
+
+	entry->answered |= bit;
+	return 0;
+}
+
+
+int ieee802_11_probe_req_stats(struct hostapd_data *hapd, char *buf,
+			       size_t buflen)
+{
+	const struct probe_req_stats *stats = &hapd->probe_req_stats;
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "probe_req=answered:%u duplicate:%u rate_limited:%u\n",
+			  stats->answered, stats->duplicate,
+			  stats->rate_limited);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
 void handle_probe_req(struct hostapd_data *hapd,
 		      const struct ieee80211_mgmt *mgmt, size_t len,
 		      int ssi_signal)
@@ -960,6 +1096,14 @@ void handle_probe_req(struct hostapd_data *hapd,
 	wpa_msg_ctrl(hapd->msg_ctx, MSG_INFO, RX_PROBE_REQUEST "sa=" MACSTR
 		     " signal=%d", MAC2STR(mgmt->sa), ssi_signal);
 
+	if (probe_req_limited(hapd, mgmt->sa, ie, ie_len)) {
+		wpa_printf(MSG_EXCESSIVE,
+			   "Ignore Probe Request from " MACSTR
+			   " due to duplicate or rate limit",
+			   MAC2STR(mgmt->sa));
+		return;
+	}
+
 	resp = hostapd_gen_probe_resp(hapd, mgmt, elems.p2p != NULL,
 				      &resp_len);
 	if (resp == NULL)
@@ -989,6 +1133,8 @@ void handle_probe_req(struct hostapd_data *hapd,
 
 	if (ret < 0)
 		wpa_printf(MSG_INFO, "handle_probe_req: send failed");
+	else
+		hapd->probe_req_stats.answered++;
 
 	os_free(resp);
 
@@ -1046,6 +1192,10 @@ void sta_track_del(struct hostapd_sta_info *info)
 }
 
 
+static void ieee802_11_fill_ap_params(struct hostapd_data *hapd,
+				      struct wpa_driver_ap_params *params);
+
+
 int ieee802_11_build_ap_params(struct hostapd_data *hapd,
 			       struct wpa_driver_ap_params *params)
 {
@@ -1291,6 +1441,16 @@ int ieee802_11_build_ap_params(struct hostapd_data *hapd,
 	params->tail_len = tail_len;
 	params->proberesp = resp;
 	params->proberesp_len = resp_len;
+	ieee802_11_fill_ap_params(hapd, params);
+
+	return 0;
+}
+
+
+/* Fill in the parameters other than the frame templates */
+static void ieee802_11_fill_ap_params(struct hostapd_data *hapd,
+				      struct wpa_driver_ap_params *params)
+{
 	params->dtim_period = hapd->conf->dtim_period;
 	params->beacon_int = hapd->iconf->beacon_int;
 	params->basic_rates = hapd->iface->basic_rates;
@@ -1372,8 +1532,6 @@ int ieee802_11_build_ap_params(struct hostapd_data *hapd,
 				   "Not configuring FTM responder as the driver doesn't advertise support for it");
 		}
 	}
-
-	return 0;
 }
 
 
@@ -1388,33 +1546,34 @@ void ieee802_11_free_ap_params(struct wpa_driver_ap_params *params)
 }
 
 
-int ieee802_11_set_beacon(struct hostapd_data *hapd)
+void ieee802_11_free_beacon_tmpl(struct hostapd_data *hapd)
+{
+	os_free(hapd->beacon_head);
+	hapd->beacon_head = NULL;
+	hapd->beacon_head_len = 0;
+	os_free(hapd->beacon_tail);
+	hapd->beacon_tail = NULL;
+	hapd->beacon_tail_len = 0;
+}
+
+
+static int ieee802_11_set_ap(struct hostapd_data *hapd,
+			     struct wpa_driver_ap_params *params)
 {
-	struct wpa_driver_ap_params params;
 	struct hostapd_freq_params freq;
 	struct hostapd_iface *iface = hapd->iface;
 	struct hostapd_config *iconf = iface->conf;
 	struct wpabuf *beacon, *proberesp, *assocresp;
-	int res, ret = -1;
-
-	if (hapd->csa_in_progress) {
-		wpa_printf(MSG_ERROR, "Cannot set beacons during CSA period");
-		return -1;
-	}
-
-	hapd->beacon_set_done = 1;
-
-	if (ieee802_11_build_ap_params(hapd, &params) < 0)
-		return -1;
+	int res;
 
 	if (hostapd_build_ap_extra_ies(hapd, &beacon, &proberesp, &assocresp) <
 	    0)
-		goto fail;
+		return -1;
 
-	params.beacon_ies = beacon;
-	params.proberesp_ies = proberesp;
-	params.assocresp_ies = assocresp;
-	params.reenable = hapd->reenable_beacon;
+	params->beacon_ies = beacon;
+	params->proberesp_ies = proberesp;
+	params->assocresp_ies = assocresp;
+	params->reenable = hapd->reenable_beacon;
 	hapd->reenable_beacon = 0;
 
 	if (iface->current_mode &&
@@ -1426,20 +1585,157 @@ int ieee802_11_set_beacon(struct hostapd_data *hapd)
 				    iconf->vht_oper_centr_freq_seg0_idx,
 				    iconf->vht_oper_centr_freq_seg1_idx,
 				    iface->current_mode->vht_capab) == 0)
-		params.freq = &freq;
+		params->freq = &freq;
 
-	res = hostapd_drv_set_ap(hapd, &params);
+	res = hostapd_drv_set_ap(hapd, params);
+	params->freq = NULL;
 	hostapd_free_ap_extra_ies(hapd, beacon, proberesp, assocresp);
-	if (res)
+	if (res) {
 		wpa_printf(MSG_ERROR, "Failed to set beacon parameters");
-	else
-		ret = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+
+int ieee802_11_set_beacon(struct hostapd_data *hapd)
+{
+	return ieee802_11_set_beacon_cause(hapd, BEACON_UPDATE_OTHER);
+}
+
+
+/**
+ * ieee802_11_set_beacon_cause - Build and set the Beacon frame of a BSS
+ * @hapd: Pointer to BSS data
+ * @cause: Reason for the update, for statistics
+ * Returns: 0 on success, -1 on failure
+ *
+ * The head and tail of the frame are kept as a template for the following
+ * updates of the dynamic elements.
+ */
+int ieee802_11_set_beacon_cause(struct hostapd_data *hapd,
+				enum beacon_update_cause cause)
+{
+	struct wpa_driver_ap_params params;
+	struct beacon_update_stats *stats = &hapd->beacon_stats[cause];
+	int ret = -1;
+
+	if (hapd->csa_in_progress) {
+		wpa_printf(MSG_ERROR, "Cannot set beacons during CSA period");
+		return -1;
+	}
+
+	hapd->beacon_set_done = 1;
+
+	if (ieee802_11_build_ap_params(hapd, &params) < 0)
+		return -1;
+
+	stats->rebuilds++;
+	stats->bytes += params.head_len + params.tail_len;
+
+	ieee802_11_free_beacon_tmpl(hapd);
+	if (ieee802_11_set_ap(hapd, &params) < 0)
+		goto fail;
+
+	hapd->beacon_head = params.head;
+	hapd->beacon_head_len = params.head_len;
+	params.head = NULL;
+	hapd->beacon_tail = params.tail;
+	hapd->beacon_tail_len = params.tail_len;
+	params.tail = NULL;
+	ret = 0;
 fail:
 	ieee802_11_free_ap_params(&params);
 	return ret;
 }
 
 
+/**
+ * ieee802_11_update_bss_load - Update the BSS Load element in Beacon frames
+ * @hapd: Pointer to BSS data
+ * Returns: 0 on success, -1 on failure
+ *
+ * Only the BSS Load element of the cached Beacon frame template is updated.
+ * The driver is not called if the element did not change. The full frame is
+ * built if there is no usable template or if the Time Advertisement element
+ * needs to be refreshed as well.
+ */
+int ieee802_11_update_bss_load(struct hostapd_data *hapd)
+{
+#ifdef NEED_AP_MLME
+	struct beacon_update_stats *stats =
+		&hapd->beacon_stats[BEACON_UPDATE_BSS_LOAD];
+	struct wpa_driver_ap_params params;
+	u8 elem[2 + 5], old[5], *pos;
+
+	if (!hapd->beacon_tail || hapd->csa_in_progress ||
+	    hapd->reenable_beacon || hapd->conf->time_advertisement == 2 ||
+	    (hapd->iface->drv_flags & WPA_DRIVER_FLAGS_PROBE_RESP_OFFLOAD))
+		goto rebuild;
+
+	pos = (u8 *) get_ie(hapd->beacon_tail, hapd->beacon_tail_len,
+			    WLAN_EID_BSS_LOAD);
+	if (!pos || pos[1] != 5 ||
+	    hostapd_eid_bss_load(hapd, elem, sizeof(elem)) !=
+	    elem + sizeof(elem))
+		goto rebuild;
+
+	if (os_memcmp(pos + 2, elem + 2, 5) == 0) {
+		stats->skipped++;
+		return 0;
+	}
+	os_memcpy(old, pos + 2, 5);
+	os_memcpy(pos + 2, elem + 2, 5);
+
+	os_memset(&params, 0, sizeof(params));
+	params.head = hapd->beacon_head;
+	params.head_len = hapd->beacon_head_len;
+	params.tail = hapd->beacon_tail;
+	params.tail_len = hapd->beacon_tail_len;
+	ieee802_11_fill_ap_params(hapd, &params);
+	if (ieee802_11_set_ap(hapd, &params) < 0) {
+		/* Keep the template matching what the driver is using */
+		os_memcpy(pos + 2, old, 5);
+		return -1;
+	}
+	stats->patched++;
+	stats->bytes += 5;
+	return 0;
+
+rebuild:
+#endif /* NEED_AP_MLME */
+	return ieee802_11_set_beacon_cause(hapd, BEACON_UPDATE_BSS_LOAD);
+}
+
+
+int ieee802_11_beacon_stats(struct hostapd_data *hapd, char *buf,
+			    size_t buflen)
+{
+	static const char * const names[NUM_BEACON_UPDATE_CAUSES] = {
+		"other", "bss_load", "protection", "csa"
+	};
+	char *pos = buf, *end = buf + buflen;
+	int i, ret;
+
+	for (i = 0; i < NUM_BEACON_UPDATE_CAUSES; i++) {
+		const struct beacon_update_stats *stats =
+			&hapd->beacon_stats[i];
+
+		ret = os_snprintf(pos, end - pos,
+				  "beacon_update[%s]=rebuilds:%u patched:%u skipped:%u bytes:%llu\n",
+				  names[i], stats->rebuilds, stats->patched,
+				  stats->skipped,
+				  (unsigned long long) stats->bytes);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
 int ieee802_11_set_beacons(struct hostapd_iface *iface)
 {
 	size_t i;
@@ -1457,13 +1753,20 @@ int ieee802_11_set_beacons(struct hostapd_iface *iface)
 
 /* only update beacons if started */
 int ieee802_11_update_beacons(struct hostapd_iface *iface)
+{
+	return ieee802_11_update_beacons_cause(iface, BEACON_UPDATE_OTHER);
+}
+
+
+int ieee802_11_update_beacons_cause(struct hostapd_iface *iface,
+				    enum beacon_update_cause cause)
 {
 	size_t i;
 	int ret = 0;
 
 	for (i = 0; i < iface->num_bss; i++) {
 		if (iface->bss[i]->beacon_set_done && iface->bss[i]->started &&
-		    ieee802_11_set_beacon(iface->bss[i]) < 0)
+		    ieee802_11_set_beacon_cause(iface->bss[i], cause) < 0)
 			ret = -1;
 	}
 
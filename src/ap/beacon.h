@@ -16,8 +16,18 @@ void handle_probe_req(struct hostapd_data *hapd,
 		      const struct ieee80211_mgmt *mgmt, size_t len,
 		      int ssi_signal);
 int ieee802_11_set_beacon(struct hostapd_data *hapd);
+int ieee802_11_set_beacon_cause(struct hostapd_data *hapd,
+				enum beacon_update_cause cause);
 int ieee802_11_set_beacons(struct hostapd_iface *iface);
 int ieee802_11_update_beacons(struct hostapd_iface *iface);
+int ieee802_11_update_beacons_cause(struct hostapd_iface *iface,
+				    enum beacon_update_cause cause);
+int ieee802_11_update_bss_load(struct hostapd_data *hapd);
+void ieee802_11_free_beacon_tmpl(struct hostapd_data *hapd);
+int ieee802_11_beacon_stats(struct hostapd_data *hapd, char *buf,
+			    size_t buflen);
+int ieee802_11_probe_req_stats(struct hostapd_data *hapd, char *buf,
+			       size_t buflen);
 int ieee802_11_build_ap_params(struct hostapd_data *hapd,
 			       struct wpa_driver_ap_params *params);
 void ieee802_11_free_ap_params(struct wpa_driver_ap_params *params);
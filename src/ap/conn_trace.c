@@ -0,0 +1,235 @@
+/*
+ * hostapd / Per-station connection event trace
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * A small fixed size ring of timestamped connection setup events (Auth,
+ * (Re)Association, EAP and RADIUS exchanges, 4-way and group key handshake
+ * messages, key configuration) is maintained for each station. The trace can
+ * be fetched with the CONN_TRACE control interface command to determine how
+ * long each phase of the connection took without enabling debug logging.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "crypto/aes.h"
+#include "common/eapol_common.h"
+#include "common/wpa_common.h"
+#include "sta_info.h"
+#include "wpa_auth.h"
+#include "conn_trace.h"
+
+
+static const char * sta_conn_trace_event_txt(enum sta_conn_trace_event event)
+{
+	switch (event) {
+	case STA_CONN_TRACE_AUTH_RX:
+		return "auth-rx";
+	case STA_CONN_TRACE_AUTH_ACK:
+		return "auth-ack";
+	case STA_CONN_TRACE_ASSOC_RX:
+		return "assoc-rx";
+	case STA_CONN_TRACE_ASSOC_RESP_ACK:
+		return "assoc-resp-ack";
+	case STA_CONN_TRACE_EAP_REQ_TX:
+		return "eap-req-tx";
+	case STA_CONN_TRACE_EAP_RESP_RX:
+		return "eap-resp-rx";
+	case STA_CONN_TRACE_EAP_SUCCESS_TX:
+		return "eap-success-tx";
+	case STA_CONN_TRACE_EAP_FAILURE_TX:
+		return "eap-failure-tx";
+	case STA_CONN_TRACE_RADIUS_REQ_TX:
+		return "radius-req-tx";
+	case STA_CONN_TRACE_RADIUS_CHALLENGE_RX:
+		return "radius-challenge-rx";
+	case STA_CONN_TRACE_RADIUS_ACCEPT_RX:
+		return "radius-accept-rx";
+	case STA_CONN_TRACE_RADIUS_REJECT_RX:
+		return "radius-reject-rx";
+	case STA_CONN_TRACE_EAPOL_M1_TX:
+		return "eapol-m1-tx";
+	case STA_CONN_TRACE_EAPOL_M2_RX:
+		return "eapol-m2-rx";
+	case STA_CONN_TRACE_EAPOL_M3_TX:
+		return "eapol-m3-tx";
+	case STA_CONN_TRACE_EAPOL_M4_RX:
+		return "eapol-m4-rx";
+	case STA_CONN_TRACE_GROUP_M1_TX:
+		return "group-m1-tx";
+	case STA_CONN_TRACE_GROUP_M2_RX:
+		return "group-m2-rx";
+	case STA_CONN_TRACE_PTK_SET:
+		return "ptk-set";
+	case STA_CONN_TRACE_AUTHORIZED:
+		return "authorized";
+	case NUM_STA_CONN_TRACE_EVENTS:
+		break;
+	}
+
+	return "?";
+}
+
+
+/* A new Authentication or (Re)Association Request frame starts a new trace
+ * unless it continues the exchange that is already in the trace (e.g., SAE
+ * commit/confirm, Authentication followed by Association, or a retransmitted
+ * (Re)Association Request frame). */
+static int sta_conn_trace_restart(struct sta_conn_trace *trace,
+				  enum sta_conn_trace_event event)
+{
+	u8 last;
+
+	if (trace->count == 0)
+		return 1;
+	if (event != STA_CONN_TRACE_AUTH_RX && event != STA_CONN_TRACE_ASSOC_RX)
+		return 0;
+
+	last = trace->entry[(trace->count - 1) % STA_CONN_TRACE_LEN].event;
+	if (last == STA_CONN_TRACE_AUTH_RX || last == STA_CONN_TRACE_AUTH_ACK)
+		return 0;
+	return !(event == STA_CONN_TRACE_ASSOC_RX &&
+		 last == STA_CONN_TRACE_ASSOC_RX);
+}
+
+
+void sta_conn_trace(struct sta_info *sta, enum sta_conn_trace_event event)
+{
+	struct sta_conn_trace *trace = &sta->conn_trace;
+	struct sta_conn_trace_entry *entry;
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	if (sta_conn_trace_restart(trace, event)) {
+		trace->start = now;
+		trace->count = 0;
+	}
+
+	os_reltime_sub(&now, &trace->start, &diff);
+	entry = &trace->entry[trace->count % STA_CONN_TRACE_LEN];
+	if (diff.sec >= 4000)
+		entry->usec = 0xffffffff;
+	else
+		entry->usec = diff.sec * 1000000 + diff.usec;
+	entry->event = event;
+	trace->count++;
+}
+
+
+/* The length of the Key MIC field depends on the AKM and PMK length that
+ * have been negotiated for the station. */
+static int sta_conn_trace_key_data_len(struct sta_info *sta,
+				       const struct wpa_eapol_key *key,
+				       size_t len, size_t *mic_len)
+{
+	const u8 *pos = (const u8 *) (key + 1);
+	int key_mgmt, pmk_len = 0;
+	u16 key_data_len;
+
+	key_mgmt = wpa_auth_sta_key_mgmt(sta->wpa_sm);
+	if (key_mgmt < 0 || !wpa_auth_get_pmk(sta->wpa_sm, &pmk_len))
+		return -1;
+	*mic_len = wpa_mic_len(key_mgmt, pmk_len);
+	if (len < sizeof(*key) + *mic_len + 2)
+		return -1;
+	key_data_len = WPA_GET_BE16(pos + *mic_len);
+	if (key_data_len > len - sizeof(*key) - *mic_len - 2)
+		return -1;
+
+	return key_data_len;
+}
+
+
+/**
+ * sta_conn_trace_eapol_key - Record an EAPOL-Key frame in the trace
+ * @sta: Station
+ * @buf: IEEE 802.1X header and EAPOL-Key frame
+ * @len: Length of buf
+ * @tx: 1 if the frame is sent to the station, 0 if received from it
+ *
+ * Received frames are classified the same way as in wpa_receive(). EAPOL-Key
+ * Request frames from the station are not recorded.
+ */
+void sta_conn_trace_eapol_key(struct sta_info *sta, const u8 *buf, size_t len,
+			      int tx)
+{
+	const struct ieee802_1x_hdr *hdr = (const struct ieee802_1x_hdr *) buf;
+	const struct wpa_eapol_key *key;
+	size_t mic_len = 0;
+	u16 key_info;
+	int key_data_len;
+
+	if (len < sizeof(*hdr) + sizeof(*key) ||
+	    hdr->type != IEEE802_1X_TYPE_EAPOL_KEY)
+		return;
+	key = (const struct wpa_eapol_key *) (hdr + 1);
+	key_info = WPA_GET_BE16(key->key_info);
+
+	if (tx) {
+		if (!(key_info & WPA_KEY_INFO_KEY_TYPE))
+			sta_conn_trace(sta, STA_CONN_TRACE_GROUP_M1_TX);
+		else
+			sta_conn_trace(sta, (key_info & WPA_KEY_INFO_INSTALL) ?
+				       STA_CONN_TRACE_EAPOL_M3_TX :
+				       STA_CONN_TRACE_EAPOL_M1_TX);
+		return;
+	}
+
+	if (key_info & WPA_KEY_INFO_REQUEST)
+		return;
+	if (!(key_info & WPA_KEY_INFO_KEY_TYPE)) {
+		sta_conn_trace(sta, STA_CONN_TRACE_GROUP_M2_RX);
+		return;
+	}
+
+	key_data_len = sta_conn_trace_key_data_len(sta, key, len - sizeof(*hdr),
+						   &mic_len);
+	if (key_data_len < 0)
+		return;
+	if (key_data_len == 0 ||
+	    (mic_len == 0 && (key_info & WPA_KEY_INFO_ENCR_KEY_DATA) &&
+	     key_data_len == AES_BLOCK_SIZE))
+		sta_conn_trace(sta, STA_CONN_TRACE_EAPOL_M4_RX);
+	else
+		sta_conn_trace(sta, STA_CONN_TRACE_EAPOL_M2_RX);
+}
+
+
+/**
+ * sta_conn_trace_get - Write the connection trace of a station into a buffer
+ * @sta: Station
+ * @buf: Buffer for the trace
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written
+ */
+int sta_conn_trace_get(struct sta_info *sta, char *buf, size_t buflen)
+{
+	struct sta_conn_trace *trace = &sta->conn_trace;
+	unsigned int i, first;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	first = trace->count > STA_CONN_TRACE_LEN ?
+		trace->count - STA_CONN_TRACE_LEN : 0;
+
+	ret = os_snprintf(pos, end - pos, "events=%u\ndropped=%u\n",
+			  trace->count, first);
+	if (os_snprintf_error(end - pos, ret))
+		return 0;
+	pos += ret;
+
+	for (i = first; i < trace->count; i++) {
+		const struct sta_conn_trace_entry *entry;
+
+		entry = &trace->entry[i % STA_CONN_TRACE_LEN];
+		ret = os_snprintf(pos, end - pos, "%u %s\n", entry->usec,
+				  sta_conn_trace_event_txt(entry->event));
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
@@ -0,0 +1,72 @@
+/*
+ * hostapd / Per-station connection event trace
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef CONN_TRACE_H
+#define CONN_TRACE_H
+
+struct hostapd_data;
+struct sta_info;
+
+enum sta_conn_trace_event {
+	STA_CONN_TRACE_AUTH_RX,
+	STA_CONN_TRACE_AUTH_ACK,
+	STA_CONN_TRACE_ASSOC_RX,
+	STA_CONN_TRACE_ASSOC_RESP_ACK,
+	STA_CONN_TRACE_EAP_REQ_TX,
+	STA_CONN_TRACE_EAP_RESP_RX,
+	STA_CONN_TRACE_EAP_SUCCESS_TX,
+	STA_CONN_TRACE_EAP_FAILURE_TX,
+	STA_CONN_TRACE_RADIUS_REQ_TX,
+	STA_CONN_TRACE_RADIUS_CHALLENGE_RX,
+	STA_CONN_TRACE_RADIUS_ACCEPT_RX,
+	STA_CONN_TRACE_RADIUS_REJECT_RX,
+	STA_CONN_TRACE_EAPOL_M1_TX,
+	STA_CONN_TRACE_EAPOL_M2_RX,
+	STA_CONN_TRACE_EAPOL_M3_TX,
+	STA_CONN_TRACE_EAPOL_M4_RX,
+	STA_CONN_TRACE_GROUP_M1_TX,
+	STA_CONN_TRACE_GROUP_M2_RX,
+	STA_CONN_TRACE_PTK_SET,
+	STA_CONN_TRACE_AUTHORIZED,
+	NUM_STA_CONN_TRACE_EVENTS
+};
+
+#define STA_CONN_TRACE_LEN 32
+
+struct sta_conn_trace_entry {
+	u32 usec; /* time since the first event of the trace */
+	u8 event; /* enum sta_conn_trace_event */
+};
+
+struct sta_conn_trace {
+	struct os_reltime start;
+	struct sta_conn_trace_entry entry[STA_CONN_TRACE_LEN];
+	unsigned int count; /* total number of events since start */
+};
+
+#ifdef CONFIG_STA_CONN_TRACE
+
+void sta_conn_trace(struct sta_info *sta, enum sta_conn_trace_event event);
+void sta_conn_trace_eapol_key(struct sta_info *sta, const u8 *buf, size_t len,
+			      int tx);
+int sta_conn_trace_get(struct sta_info *sta, char *buf, size_t buflen);
+
+#else /* CONFIG_STA_CONN_TRACE */
+
+static inline void sta_conn_trace(struct sta_info *sta,
+				  enum sta_conn_trace_event event)
+{
+}
+
+static inline void sta_conn_trace_eapol_key(struct sta_info *sta,
+					    const u8 *buf, size_t len, int tx)
+{
+}
+
+#endif /* CONFIG_STA_CONN_TRACE */
+
+#endif /* CONN_TRACE_H */
@@ -22,6 +22,7 @@
 #include "p2p_hostapd.h"
 #include "ctrl_iface_ap.h"
 #include "ap_drv_ops.h"
+#include "beacon.h"
 #include "mbo_ap.h"
 #include "taxonomy.h"
 
@@ -58,7 +59,7 @@ static int hostapd_get_sta_tx_rx(struct hostapd_data *hapd,
 	int ret;
 	int len = 0;
 
-	if (hostapd_drv_read_sta_data(hapd, &data, sta->addr) < 0)
+	if (ap_sta_read_stats(hapd, sta, STA_STATS_CTRL_IFACE, &data) < 0)
 		return 0;
 
 	ret = os_snprintf(buf, buflen, "rx_packets=%lu\ntx_packets=%lu\n"
@@ -266,6 +267,11 @@ static int hostapd_ctrl_iface_sta_mib(struct hostapd_data *hapd,
 	len += hostapd_get_sta_tx_rx(hapd, sta, buf + len, buflen - len);
 	len += hostapd_get_sta_conn_time(sta, buf + len, buflen - len);
 
+	ret = os_snprintf(buf + len, buflen - len, "mem_usage=%u\n",
+			  (unsigned int) ap_sta_mem_usage(sta));
+	if (!os_snprintf_error(buflen - len, ret))
+		len += ret;
+
 #ifdef CONFIG_SAE
 	if (sta->sae && sta->sae->state == SAE_ACCEPTED) {
 		res = os_snprintf(buf + len, buflen - len, "sae_group=%d\n",
@@ -625,6 +631,26 @@ int hostapd_ctrl_iface_signature(struct hostapd_data *hapd,
 #endif /* CONFIG_TAXONOMY */
 
 
+#ifdef CONFIG_STA_CONN_TRACE
+int hostapd_ctrl_iface_conn_trace(struct hostapd_data *hapd,
+				  const char *txtaddr,
+				  char *buf, size_t buflen)
+{
+	u8 addr[ETH_ALEN];
+	struct sta_info *sta;
+
+	if (hwaddr_aton(txtaddr, addr))
+		return -1;
+
+	sta = ap_get_sta(hapd, addr);
+	if (!sta)
+		return -1;
+
+	return sta_conn_trace_get(sta, buf, buflen);
+}
+#endif /* CONFIG_STA_CONN_TRACE */
+
+
 int hostapd_ctrl_iface_poll_sta(struct hostapd_data *hapd,
 				const char *txtaddr)
 {
@@ -817,6 +843,25 @@ int hostapd_ctrl_iface_status(struct hostapd_data *hapd, char *buf,
 		len += ret;
 	}
 
+	len += ieee802_11_beacon_stats(hapd, buf + len, buflen - len);
+	len += ieee802_11_mgmt_rx_stats(hapd, buf + len, buflen - len);
+	len += ieee802_11_probe_req_stats(hapd, buf + len, buflen - len);
+
+#ifdef CONFIG_PROXYARP
+	if (hapd->conf->proxy_arp) {
+		ret = os_snprintf(buf + len, buflen - len,
+				  "ndisc_ns_proxied=%u\n"
+				  "ndisc_ns_forwarded=%u\n"
+				  "proxyarp_addr_moved=%u\n",
+				  hapd->ndisc_ns_proxied,
+				  hapd->ndisc_ns_forwarded,
+				  hapd->proxyarp_addr_moved);
+		if (os_snprintf_error(buflen - len, ret))
+			return len;
+		len += ret;
+	}
+#endif /* CONFIG_PROXYARP */
+
 	if (hapd->conf->chan_util_avg_period) {
 		ret = os_snprintf(buf + len, buflen - len,
 				  "chan_util_avg=%u\n",
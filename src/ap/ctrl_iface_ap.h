@@ -22,6 +22,9 @@ int hostapd_ctrl_iface_disassociate(struct hostapd_data *hapd,
 int hostapd_ctrl_iface_signature(struct hostapd_data *hapd,
 				 const char *txtaddr,
 				 char *buf, size_t buflen);
+int hostapd_ctrl_iface_conn_trace(struct hostapd_data *hapd,
+				  const char *txtaddr,
+				  char *buf, size_t buflen);
 int hostapd_ctrl_iface_poll_sta(struct hostapd_data *hapd,
 				const char *txtaddr);
 int hostapd_ctrl_iface_status(struct hostapd_data *hapd, char *buf,
@@ -29,12 +29,81 @@ static const char * ipaddr_str(u32 addr)
 }
 
 
+static unsigned int ip4_hash(be32 ipaddr)
+{
+	u32 a = (u32) ipaddr;
+
+	return (a ^ (a >> 8) ^ (a >> 16) ^ (a >> 24)) % X_SNOOP_HASH_SIZE;
+}
+
+
+/* Get the station in the BSS that has been assigned an IPv4 address */
+static struct sta_info * dhcp_snoop_get_sta(struct hostapd_data *hapd,
+					    be32 ipaddr)
+{
+	struct sta_info *sta;
+
+	if (!hapd->ip4_hash || !ipaddr)
+		return NULL;
+
+	for (sta = hapd->ip4_hash[ip4_hash(ipaddr)]; sta; sta = sta->ip4_hnext) {
+		if (sta->ipaddr == ipaddr)
+			return sta;
+	}
+
+	return NULL;
+}
+
+
+static void dhcp_snoop_hash_add(struct hostapd_data *hapd,
+				struct sta_info *sta)
+{
+	unsigned int h = ip4_hash(sta->ipaddr);
+
+	sta->ip4_hnext = hapd->ip4_hash[h];
+	hapd->ip4_hash[h] = sta;
+}
+
+
+static void dhcp_snoop_hash_del(struct hostapd_data *hapd,
+				struct sta_info *sta)
+{
+	struct sta_info **s;
+
+	if (!hapd->ip4_hash || !sta->ipaddr)
+		return;
+
+	for (s = &hapd->ip4_hash[ip4_hash(sta->ipaddr)]; *s;
+	     s = &(*s)->ip4_hnext) {
+		if (*s == sta) {
+			*s = sta->ip4_hnext;
+			break;
+		}
+	}
+	sta->ip4_hnext = NULL;
+}
+
+
+/**
+ * dhcp_snoop_sta_free - Forget the IPv4 address of a station being freed
+ * @hapd: Pointer to BSS data
+ * @sta: Station
+ *
+ * The ip neigh entry of the address is not removed by this function.
+ */
+void dhcp_snoop_sta_free(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	dhcp_snoop_hash_del(hapd, sta);
+	sta->ipaddr = 0;
+}
+
+
 static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 			size_t len)
 {
 	struct hostapd_data *hapd = ctx;
 	const struct bootp_pkt *b;
-	struct sta_info *sta;
+	struct sta_info *sta, *owner;
 	int exten_len;
 	const u8 *end, *pos;
 	int res, msgtype = 0, prefixlen = 32;
@@ -88,14 +157,8 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 		}
 	}
 
-	if (hapd->conf->disable_dgaf && is_broadcast_ether_addr(buf)) {
-		for (sta = hapd->sta_list; sta; sta = sta->next) {
-			if (!(sta->flags & WLAN_STA_AUTHORIZED))
-				continue;
-			x_snoop_mcast_to_ucast_convert_send(hapd, sta,
-							    (u8 *) buf, len);
-		}
-	}
+	if (hapd->conf->disable_dgaf && is_broadcast_ether_addr(buf))
+		x_snoop_mcast_to_ucast_convert_send_all(hapd, (u8 *) buf, len);
 
 	if (msgtype == DHCPACK) {
 		if (b->your_ip == 0)
@@ -115,12 +178,25 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 		if (sta->ipaddr == b->your_ip)
 			return;
 
+		owner = dhcp_snoop_get_sta(hapd, b->your_ip);
+		if (owner) {
+			wpa_printf(MSG_DEBUG,
+				   "dhcp_snoop: IPv4 address %s moved from "
+				   MACSTR, ipaddr_str(be_to_host32(b->your_ip)),
+				   MAC2STR(owner->addr));
+			hostapd_drv_br_delete_ip_neigh(hapd, 4,
+						       (u8 *) &owner->ipaddr);
+			dhcp_snoop_sta_free(hapd, owner);
+			hapd->proxyarp_addr_moved++;
+		}
+
 		if (sta->ipaddr != 0) {
 			wpa_printf(MSG_DEBUG,
 				   "dhcp_snoop: Removing IPv4 address %s from the ip neigh table",
 				   ipaddr_str(be_to_host32(sta->ipaddr)));
 			hostapd_drv_br_delete_ip_neigh(hapd, 4,
 						       (u8 *) &sta->ipaddr);
+			dhcp_snoop_sta_free(hapd, sta);
 		}
 
 		res = hostapd_drv_br_add_ip_neigh(hapd, 4, (u8 *) &b->your_ip,
@@ -132,12 +208,18 @@ static void handle_dhcp(void *ctx, const u8 *src_addr, const u8 *buf,
 			return;
 		}
 		sta->ipaddr = b->your_ip;
+		dhcp_snoop_hash_add(hapd, sta);
 	}
 }
 
 
 int dhcp_snoop_init(struct hostapd_data *hapd)
 {
+	hapd->ip4_hash = os_calloc(X_SNOOP_HASH_SIZE,
+				   sizeof(struct sta_info *));
+	if (!hapd->ip4_hash)
+		return -1;
+
 	hapd->sock_dhcp = x_snoop_get_l2_packet(hapd, handle_dhcp,
 						L2_PACKET_FILTER_DHCP);
 	if (hapd->sock_dhcp == NULL) {
@@ -155,4 +237,6 @@ void dhcp_snoop_deinit(struct hostapd_data *hapd)
 {
 	l2_packet_deinit(hapd->sock_dhcp);
 	hapd->sock_dhcp = NULL;
+	os_free(hapd->ip4_hash);
+	hapd->ip4_hash = NULL;
 }
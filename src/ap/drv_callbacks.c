@@ -180,6 +180,7 @@ int hostapd_notif_assoc(struct hostapd_data *hapd, const u8 *addr,
 			return -1;
 		}
 	}
+	sta_conn_trace(sta, STA_CONN_TRACE_ASSOC_RX);
 	sta->flags &= ~(WLAN_STA_WPS | WLAN_STA_MAYBE_WPS | WLAN_STA_WPS2);
 
 	/*
@@ -855,6 +856,10 @@ void hostapd_event_ch_switch(struct hostapd_data *hapd, int freq, int ht,
 	hapd->iconf->vht_oper_centr_freq_seg0_idx = seg0_idx;
 	hapd->iconf->vht_oper_centr_freq_seg1_idx = seg1_idx;
 
+	/* The cached Beacon templates still describe the old channel */
+	for (i = 0; i < hapd->iface->num_bss; i++)
+		ieee802_11_free_beacon_tmpl(hapd->iface->bss[i]);
+
 	is_dfs = ieee80211_is_dfs(freq, hapd->iface->hw_features,
 				  hapd->iface->num_hw_features);
 
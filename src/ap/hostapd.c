@@ -346,6 +346,8 @@ static void hostapd_free_hapd_data(struct hostapd_data *hapd)
 	hapd->p2p_probe_resp_ie = NULL;
 #endif /* CONFIG_P2P */
 
+	ieee802_11_free_beacon_tmpl(hapd);
+
 	if (!hapd->started) {
 		wpa_printf(MSG_ERROR, "%s: Interface %s wasn't started",
 			   __func__, hapd->conf ? hapd->conf->iface : "N/A");
@@ -491,6 +493,8 @@ static void hostapd_cleanup_iface_partial(struct hostapd_iface *iface)
 	iface->basic_rates = NULL;
 	ap_list_deinit(iface);
 	sta_track_deinit(iface);
+	os_free(iface->probe_limit);
+	iface->probe_limit = NULL;
 }
 
 
@@ -1021,18 +1025,40 @@ hostapd_das_coa(void *ctx, struct radius_das_attrs *attr)
 #endif /* CONFIG_NO_RADIUS */
 
 
+/**
+ * hostapd_start_bss - Start beaconing on a BSS that has been set up
+ * @hapd: Pointer to BSS data
+ * Returns: 0 on success, -1 on failure
+ */
+static int hostapd_start_bss(struct hostapd_data *hapd)
+{
+	if (!hapd->conf->start_disabled && ieee802_11_set_beacon(hapd) < 0)
+		return -1;
+
+	if (hapd->wpa_auth && wpa_init_keys(hapd->wpa_auth) < 0)
+		return -1;
+
+	if (hapd->driver && hapd->driver->set_operstate)
+		hapd->driver->set_operstate(hapd->drv_priv, 1);
+
+	return 0;
+}
+
+
 /**
  * hostapd_setup_bss - Per-BSS setup (initialization)
  * @hapd: Pointer to BSS data
  * @first: Whether this BSS is the first BSS of an interface; -1 = not first,
  *	but interface may exist
+ * @start: Whether to start the BSS with hostapd_start_bss() once it has been
+ *	set up
  *
  * This function is used to initialize all per-BSS data structures and
  * resources. This gets called in a loop for each BSS when an interface is
  * initialized. Most of the modules that are initialized here will be
  * deinitialized in hostapd_cleanup().
  */
-static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
+static int hostapd_setup_bss(struct hostapd_data *hapd, int first, int start)
 {
 	struct hostapd_bss_config *conf = hapd->conf;
 	u8 ssid[SSID_MAX_LEN + 1];
@@ -1284,14 +1310,8 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 		return -1;
 	}
 
-	if (!conf->start_disabled && ieee802_11_set_beacon(hapd) < 0)
-		return -1;
-
-	if (hapd->wpa_auth && wpa_init_keys(hapd->wpa_auth) < 0)
-		return -1;
-
-	if (hapd->driver && hapd->driver->set_operstate)
-		hapd->driver->set_operstate(hapd->drv_priv, 1);
+	if (start)
+		return hostapd_start_bss(hapd);
 
 	return 0;
 }
@@ -1795,6 +1815,37 @@ static void hostapd_interface_setup_failure_handler(void *eloop_ctx,
 }
 
 
+/* Log the time spent in a setup stage and start timing the next one */
+static void hostapd_setup_stage_done(struct hostapd_iface *iface,
+				     const char *stage,
+				     struct os_reltime *stage_start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, stage_start, &diff);
+	wpa_printf(MSG_DEBUG, "%s: Setup stage %s took %ld ms",
+		   iface->bss[0]->conf->iface, stage,
+		   (long) (diff.sec * 1000 + diff.usec / 1000));
+	*stage_start = now;
+}
+
+
+static void hostapd_setup_bss_rollback(struct hostapd_iface *iface, size_t j)
+{
+	struct hostapd_data *hapd;
+
+	for (;;) {
+		hapd = iface->bss[j];
+		hostapd_bss_deinit_no_free(hapd);
+		hostapd_free_hapd_data(hapd);
+		if (j == 0)
+			break;
+		j--;
+	}
+}
+
+
 static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 						 int err)
 {
@@ -1803,11 +1854,14 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 	u8 *prev_addr;
 	int delay_apply_cfg = 0;
 	int res_dfs_offload = 0;
+	struct os_reltime setup_start, stage_start;
 
 	if (err)
 		goto fail;
 
 	wpa_printf(MSG_DEBUG, "Completing interface initialization");
+	os_get_reltime(&setup_start);
+	stage_start = setup_start;
 	if (iface->conf->channel) {
 #ifdef NEED_AP_MLME
 		int res;
@@ -1871,6 +1925,7 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 				   "kernel driver");
 			goto fail;
 		}
+		hostapd_setup_stage_done(iface, "channel", &stage_start);
 	}
 
 	if (iface->current_mode) {
@@ -1901,26 +1956,38 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 	}
 
 	prev_addr = hapd->own_addr;
+	hostapd_setup_stage_done(iface, "radio", &stage_start);
 
 	for (j = 0; j < iface->num_bss; j++) {
 		hapd = iface->bss[j];
 		if (j)
 			os_memcpy(hapd->own_addr, prev_addr, ETH_ALEN);
-		if (hostapd_setup_bss(hapd, j == 0)) {
-			for (;;) {
-				hapd = iface->bss[j];
-				hostapd_bss_deinit_no_free(hapd);
-				hostapd_free_hapd_data(hapd);
-				if (j == 0)
-					break;
-				j--;
-			}
+		if (hostapd_setup_bss(hapd, j == 0, 0)) {
+			hostapd_setup_bss_rollback(iface, j);
+			hapd = iface->bss[0];
 			goto fail;
 		}
 		if (is_zero_ether_addr(hapd->conf->bssid))
 			prev_addr = hapd->own_addr;
 	}
 	hapd = iface->bss[0];
+	hostapd_setup_stage_done(iface, "bss", &stage_start);
+
+	/*
+	 * Start the BSSes only once all of them have been set up. This keeps
+	 * the per-BSS interface creation and module initialization separate
+	 * from the beacon and key configuration, so that the latter driver
+	 * commands are issued back-to-back for all BSSes and the drivers that
+	 * support it can pipeline the requests that do not need to be waited
+	 * for.
+	 */
+	for (j = 0; j < iface->num_bss; j++) {
+		if (hostapd_start_bss(iface->bss[j])) {
+			hostapd_setup_bss_rollback(iface, iface->num_bss - 1);
+			goto fail;
+		}
+	}
+	hostapd_setup_stage_done(iface, "start", &stage_start);
 
 	hostapd_tx_queue_params(iface);
 
@@ -1933,6 +2000,7 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 			   "configuration", __func__);
 		goto fail;
 	}
+	hostapd_setup_stage_done(iface, "commit", &stage_start);
 
 	/*
 	 * WPS UPnP module can be initialized only when the "upnp_iface" is up.
@@ -1944,6 +2012,7 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 		if (hostapd_init_wps_complete(iface->bss[j]))
 			goto fail;
 	}
+	hostapd_setup_stage_done(iface, "wps", &stage_start);
 
 	if ((iface->drv_flags & WPA_DRIVER_FLAGS_DFS_OFFLOAD) &&
 	    !res_dfs_offload) {
@@ -1982,6 +2051,7 @@ dfs_offload:
 
 	wpa_printf(MSG_DEBUG, "%s: Setup of interface done.",
 		   iface->bss[0]->conf->iface);
+	hostapd_setup_stage_done(iface, "total", &setup_start);
 	if (iface->interfaces && iface->interfaces->terminate_on_error > 0)
 		iface->interfaces->terminate_on_error--;
 
@@ -2778,7 +2848,7 @@ int hostapd_add_iface(struct hapd_interfaces *interfaces, char *buf)
 
 			if (start_ctrl_iface_bss(hapd) < 0 ||
 			    (hapd_iface->state == HAPD_IFACE_ENABLED &&
-			     hostapd_setup_bss(hapd, -1))) {
+			     hostapd_setup_bss(hapd, -1, 1))) {
 				hostapd_cleanup(hapd);
 				hapd_iface->bss[hapd_iface->num_bss - 1] = NULL;
 				hapd_iface->conf->num_bss--;
@@ -3132,6 +3202,10 @@ static int hostapd_build_beacon_data(struct hostapd_data *hapd,
 
 	beacon->tail_len = params.tail_len;
 
+	hapd->beacon_stats[BEACON_UPDATE_CSA].rebuilds++;
+	hapd->beacon_stats[BEACON_UPDATE_CSA].bytes +=
+		params.head_len + params.tail_len;
+
 	if (params.proberesp != NULL) {
 		beacon->probe_resp = os_memdup(params.proberesp,
 					       params.proberesp_len);
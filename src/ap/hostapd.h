@@ -115,8 +115,42 @@ struct wps_stat {
 	u8 peer_addr[ETH_ALEN];
 };
 
+enum beacon_update_cause {
+	BEACON_UPDATE_OTHER,
+	BEACON_UPDATE_BSS_LOAD,
+	BEACON_UPDATE_PROTECTION,
+	BEACON_UPDATE_CSA,
+	NUM_BEACON_UPDATE_CAUSES
+};
+
+struct beacon_update_stats {
+	unsigned int rebuilds; /* full builds of the Beacon frame */
+	unsigned int patched; /* element patched in the cached template */
+	unsigned int skipped; /* no change in the Beacon frame */
+	u64 bytes; /* head and tail bytes built or patched */
+};
+
+#define MGMT_RX_HIST_BUCKETS 8
+
+/* Received Management frames of one subtype */
+struct mgmt_rx_stats {
+	unsigned int frames;
+	unsigned int ignored; /* not processed, e.g., not for this BSS */
+	u64 usec; /* total processing time */
+	/* Processing time histogram: bucket i counts the frames that took less
+	 * than 4^(i+1) usec; the last bucket counts all slower frames. */
+	unsigned int hist[MGMT_RX_HIST_BUCKETS];
+};
+
+struct probe_req_stats {
+	unsigned int answered;
+	unsigned int duplicate; /* already answered within the dedup window */
+	unsigned int rate_limited; /* no tokens left for the source address */
+};
+
 struct hostapd_neighbor_entry {
 	struct dl_list list;
+	struct hostapd_neighbor_entry *hnext; /* next entry in nr_hash list */
 	u8 bssid[ETH_ALEN];
 	struct wpa_ssid_value ssid;
 	struct wpabuf *nr;
@@ -161,6 +195,8 @@ struct hostapd_data {
 	 */
 #define AID_WORDS ((2008 + 31) / 32)
 	u32 sta_aid[AID_WORDS];
+	/* Bitfield of the sta_aid[] words that have all AIDs allocated */
+	u64 sta_aid_full;
 
 	const struct wpa_driver_ops *driver;
 	void *drv_priv;
@@ -221,6 +257,15 @@ struct hostapd_data {
 	struct wps_context *wps;
 
 	int beacon_set_done;
+	/* Beacon head/tail from the last full build. Dynamic elements are
+	 * patched in this copy instead of rebuilding the whole frame. */
+	u8 *beacon_head;
+	size_t beacon_head_len;
+	u8 *beacon_tail;
+	size_t beacon_tail_len;
+	struct beacon_update_stats beacon_stats[NUM_BEACON_UPDATE_CAUSES];
+	struct mgmt_rx_stats mgmt_rx_stats[16]; /* indexed by subtype */
+	struct probe_req_stats probe_req_stats;
 	struct wpabuf *wps_beacon_ie;
 	struct wpabuf *wps_probe_resp_ie;
 #ifdef CONFIG_WPS
@@ -293,6 +338,12 @@ struct hostapd_data {
 #ifdef CONFIG_PROXYARP
 	struct l2_packet_data *sock_dhcp;
 	struct l2_packet_data *sock_ndisc;
+	/* Snooped IP addresses of the associated stations */
+	struct sta_info **ip4_hash; /* X_SNOOP_HASH_SIZE entries */
+	struct ip6addr **ip6_hash; /* X_SNOOP_HASH_SIZE entries */
+	unsigned int ndisc_ns_proxied; /* NS for an address of a STA */
+	unsigned int ndisc_ns_forwarded; /* NS for other addresses */
+	unsigned int proxyarp_addr_moved; /* address taken over by other STA */
 #endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_MESH
 	int num_plinks;
@@ -342,6 +393,13 @@ struct hostapd_data {
 #endif /* CONFIG_MBO */
 
 	struct dl_list nr_db;
+#define NR_HASH_SIZE 64
+#define NR_HASH(bssid) ((bssid)[5] % NR_HASH_SIZE)
+	struct hostapd_neighbor_entry *nr_hash[NR_HASH_SIZE];
+	/* Neighbor Report elements for nr_resp_ssid without LCI/civic; cleared
+	 * on any change to the neighbor database */
+	struct wpabuf *nr_resp_cache;
+	struct wpa_ssid_value nr_resp_ssid;
 
 	u8 beacon_req_token;
 	u8 lci_req_token;
@@ -392,6 +450,19 @@ struct hostapd_sta_info {
 #endif /* CONFIG_TAXONOMY */
 };
 
+#define PROBE_LIMIT_SETS 64
+#define PROBE_LIMIT_WAYS 4
+
+/* Probe Request frames from one source address on a radio */
+struct hostapd_probe_limit {
+	u8 addr[ETH_ALEN];
+	struct os_reltime last; /* last token bucket update */
+	unsigned int tokens; /* in 1/1000 of a Probe Response frame */
+	u32 probe_hash; /* hash of the elements of the last Probe Request */
+	struct os_reltime probe_time; /* when probe_hash was first seen */
+	u32 answered; /* BSS indexes that have replied to probe_hash */
+};
+
 enum hostapd_iface_state {
 	HAPD_IFACE_UNINITIALIZED,
 	HAPD_IFACE_DISABLED,
@@ -445,6 +516,17 @@ struct hostapd_iface {
 	int num_ap; /* number of entries in ap_list */
 	struct ap_info *ap_list; /* AP info list head */
 	struct ap_info *ap_hash[STA_HASH_SIZE];
+	/* Number of entries in ap_list that cause OLBC on the operating
+	 * channel and that do not support HT, respectively */
+	int num_olbc_ap;
+	int num_ap_no_ht;
+	/* Operating mode/channel used for the per-AP OLBC flags */
+	struct hostapd_hw_modes *olbc_mode;
+	u8 olbc_channel;
+	/* Number of ap_list_timer() runs for which the OLBC conditions have
+	 * not been detected while protection is still enabled */
+	u8 olbc_clear_wait;
+	u8 olbc_ht_clear_wait;
 
 	u64 drv_flags;
 
@@ -541,6 +623,10 @@ struct hostapd_iface {
 	struct dl_list sta_seen; /* struct hostapd_sta_info */
 	unsigned int num_sta_seen;
 
+	/* PROBE_LIMIT_SETS sets of PROBE_LIMIT_WAYS entries indexed by source
+	 * address; allocated when Probe Request limiting is enabled */
+	struct hostapd_probe_limit *probe_limit;
+
 	u8 dfs_domain;
 };
 
@@ -2067,14 +2067,15 @@ static void handle_auth(struct hostapd_data *hapd,
 	    mgmt->u.auth.variable[1] == WLAN_AUTH_CHALLENGE_LEN)
 		challenge = &mgmt->u.auth.variable[2];
 
-	wpa_printf(MSG_DEBUG, "authentication: STA=" MACSTR " auth_alg=%d "
-		   "auth_transaction=%d status_code=%d wep=%d%s "
-		   "seq_ctrl=0x%x%s%s",
-		   MAC2STR(mgmt->sa), auth_alg, auth_transaction,
-		   status_code, !!(fc & WLAN_FC_ISWEP),
-		   challenge ? " challenge" : "",
-		   seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "",
-		   from_queue ? " (from queue)" : "");
+	wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+		       "authentication: STA=" MACSTR " auth_alg=%d "
+		       "auth_transaction=%d status_code=%d wep=%d%s "
+		       "seq_ctrl=0x%x%s%s",
+		       MAC2STR(mgmt->sa), auth_alg, auth_transaction,
+		       status_code, !!(fc & WLAN_FC_ISWEP),
+		       challenge ? " challenge" : "",
+		       seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "",
+		       from_queue ? " (from queue)" : "");
 
 #ifdef CONFIG_NO_RC4
 	if (auth_alg == WLAN_AUTH_SHARED_KEY) {
@@ -2270,6 +2271,7 @@ static void handle_auth(struct hostapd_data *hapd,
 	}
 	sta->last_seq_ctrl = seq_ctrl;
 	sta->last_subtype = WLAN_FC_STYPE_AUTH;
+	sta_conn_trace(sta, STA_CONN_TRACE_AUTH_RX);
 #ifdef CONFIG_MBO
 	sta->auth_rssi = rssi;
 #endif /* CONFIG_MBO */
@@ -2431,9 +2433,32 @@ static void handle_auth(struct hostapd_data *hapd,
 }
 
 
+/* Index of the least significant zero bit; val must have a zero bit */
+static int aid_first_zero32(u32 val)
+{
+#ifdef __GNUC__
+	return __builtin_ctz(~val);
+#else /* __GNUC__ */
+	int i;
+
+	for (i = 0; val & BIT(i); i++)
+		;
+	return i;
+#endif /* __GNUC__ */
+}
+
+
+static int aid_first_zero64(u64 val)
+{
+	if ((u32) val != 0xffffffff)
+		return aid_first_zero32(val);
+	return 32 + aid_first_zero32(val >> 32);
+}
+
+
 int hostapd_get_aid(struct hostapd_data *hapd, struct sta_info *sta)
 {
-	int i, j = 32, aid;
+	int i, j, aid;
 
 	/* get a unique AID */
 	if (sta->aid > 0) {
@@ -2444,29 +2469,40 @@ int hostapd_get_aid(struct hostapd_data *hapd, struct sta_info *sta)
 	if (TEST_FAIL())
 		return -1;
 
-	for (i = 0; i < AID_WORDS; i++) {
-		if (hapd->sta_aid[i] == (u32) -1)
-			continue;
-		for (j = 0; j < 32; j++) {
-			if (!(hapd->sta_aid[i] & BIT(j)))
-				break;
-		}
-		if (j < 32)
-			break;
-	}
-	if (j == 32)
+	/* sta_aid_full tracks the full words, so the lowest free AID is found
+	 * without going through the words one by one */
+	if (hapd->sta_aid_full == (u64) -1)
 		return -1;
+	i = aid_first_zero64(hapd->sta_aid_full);
+	if (i >= AID_WORDS)
+		return -1;
+	j = aid_first_zero32(hapd->sta_aid[i]);
 	aid = i * 32 + j + 1;
 	if (aid > 2007)
 		return -1;
 
 	sta->aid = aid;
 	hapd->sta_aid[i] |= BIT(j);
+	if (hapd->sta_aid[i] == (u32) -1)
+		hapd->sta_aid_full |= (u64) 1 << i;
 	wpa_printf(MSG_DEBUG, "  new AID %d", sta->aid);
 	return 0;
 }
 
 
+void hostapd_free_aid(struct hostapd_data *hapd, struct sta_info *sta)
+{
+	int i;
+
+	if (sta->aid == 0)
+		return;
+
+	i = (sta->aid - 1) / 32;
+	hapd->sta_aid[i] &= ~BIT((sta->aid - 1) % 32);
+	hapd->sta_aid_full &= ~((u64) 1 << i);
+}
+
+
 static u16 check_ssid(struct hostapd_data *hapd, struct sta_info *sta,
 		      const u8 *ssid_ie, size_t ssid_ie_len)
 {
@@ -2792,40 +2828,34 @@ static u16 owe_process_assoc_req(struct hostapd_data *hapd,
 
 
 static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
-			   const u8 *ies, size_t ies_len, int reassoc)
+			   const u8 *ies, size_t ies_len,
+			   struct ieee802_11_elems *elems, int reassoc)
 {
-	struct ieee802_11_elems elems;
 	u16 resp;
 	const u8 *wpa_ie;
 	size_t wpa_ie_len;
 	const u8 *p2p_dev_addr = NULL;
 
-	if (ieee802_11_parse_elems(ies, ies_len, &elems, 1) == ParseFailed) {
-		hostapd_logger(hapd, sta->addr, HOSTAPD_MODULE_IEEE80211,
-			       HOSTAPD_LEVEL_INFO, "Station sent an invalid "
-			       "association request");
-		return WLAN_STATUS_UNSPECIFIED_FAILURE;
-	}
-
-	resp = check_ssid(hapd, sta, elems.ssid, elems.ssid_len);
+	resp = check_ssid(hapd, sta, elems->ssid, elems->ssid_len);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
-	resp = check_wmm(hapd, sta, elems.wmm, elems.wmm_len);
+	resp = check_wmm(hapd, sta, elems->wmm, elems->wmm_len);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
-	resp = check_ext_capab(hapd, sta, elems.ext_capab, elems.ext_capab_len);
+	resp = check_ext_capab(hapd, sta, elems->ext_capab,
+			       elems->ext_capab_len);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
-	resp = copy_supp_rates(hapd, sta, &elems);
+	resp = copy_supp_rates(hapd, sta, elems);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
 
-	resp = check_multi_ap(hapd, sta, elems.multi_ap, elems.multi_ap_len);
+	resp = check_multi_ap(hapd, sta, elems->multi_ap, elems->multi_ap_len);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
 
 #ifdef CONFIG_IEEE80211N
-	resp = copy_sta_ht_capab(hapd, sta, elems.ht_capabilities);
+	resp = copy_sta_ht_capab(hapd, sta, elems->ht_capabilities);
 	if (resp != WLAN_STATUS_SUCCESS)
 		return resp;
 	if (hapd->iconf->ieee80211n && hapd->iconf->require_ht &&
@@ -2839,15 +2869,15 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 
 #ifdef CONFIG_IEEE80211AC
 	if (hapd->iconf->ieee80211ac) {
-		resp = copy_sta_vht_capab(hapd, sta, elems.vht_capabilities);
+		resp = copy_sta_vht_capab(hapd, sta, elems->vht_capabilities);
 		if (resp != WLAN_STATUS_SUCCESS)
 			return resp;
 
-		resp = copy_sta_vht_oper(hapd, sta, elems.vht_operation);
+		resp = copy_sta_vht_oper(hapd, sta, elems->vht_operation);
 		if (resp != WLAN_STATUS_SUCCESS)
 			return resp;
 
-		resp = set_sta_vht_opmode(hapd, sta, elems.vht_opmode_notif);
+		resp = set_sta_vht_opmode(hapd, sta, elems->vht_opmode_notif);
 		if (resp != WLAN_STATUS_SUCCESS)
 			return resp;
 	}
@@ -2860,16 +2890,16 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 		return WLAN_STATUS_ASSOC_DENIED_NO_VHT;
 	}
 
-	if (hapd->conf->vendor_vht && !elems.vht_capabilities) {
-		resp = copy_sta_vendor_vht(hapd, sta, elems.vendor_vht,
-					   elems.vendor_vht_len);
+	if (hapd->conf->vendor_vht && !elems->vht_capabilities) {
+		resp = copy_sta_vendor_vht(hapd, sta, elems->vendor_vht,
+					   elems->vendor_vht_len);
 		if (resp != WLAN_STATUS_SUCCESS)
 			return resp;
 	}
 #endif /* CONFIG_IEEE80211AC */
 
 #ifdef CONFIG_P2P
-	if (elems.p2p) {
+	if (elems->p2p) {
 		wpabuf_free(sta->p2p_ie);
 		sta->p2p_ie = ieee802_11_vendor_ie_concat(ies, ies_len,
 							  P2P_IE_VENDOR_TYPE);
@@ -2881,13 +2911,13 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 	}
 #endif /* CONFIG_P2P */
 
-	if ((hapd->conf->wpa & WPA_PROTO_RSN) && elems.rsn_ie) {
-		wpa_ie = elems.rsn_ie;
-		wpa_ie_len = elems.rsn_ie_len;
+	if ((hapd->conf->wpa & WPA_PROTO_RSN) && elems->rsn_ie) {
+		wpa_ie = elems->rsn_ie;
+		wpa_ie_len = elems->rsn_ie_len;
 	} else if ((hapd->conf->wpa & WPA_PROTO_WPA) &&
-		   elems.wpa_ie) {
-		wpa_ie = elems.wpa_ie;
-		wpa_ie_len = elems.wpa_ie_len;
+		   elems->wpa_ie) {
+		wpa_ie = elems->wpa_ie;
+		wpa_ie_len = elems->wpa_ie_len;
 	} else {
 		wpa_ie = NULL;
 		wpa_ie_len = 0;
@@ -2895,7 +2925,7 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 
 #ifdef CONFIG_WPS
 	sta->flags &= ~(WLAN_STA_WPS | WLAN_STA_MAYBE_WPS | WLAN_STA_WPS2);
-	if (hapd->conf->wps_state && elems.wps_ie) {
+	if (hapd->conf->wps_state && elems->wps_ie) {
 		wpa_printf(MSG_DEBUG, "STA included WPS IE in (Re)Association "
 			   "Request - assume WPS is used");
 		sta->flags |= WLAN_STA_WPS;
@@ -2943,8 +2973,8 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 		res = wpa_validate_wpa_ie(hapd->wpa_auth, sta->wpa_sm,
 					  hapd->iface->freq,
 					  wpa_ie, wpa_ie_len,
-					  elems.mdie, elems.mdie_len,
-					  elems.owe_dh, elems.owe_dh_len);
+					  elems->mdie, elems->mdie_len,
+					  elems->owe_dh, elems->owe_dh_len);
 		resp = wpa_res_to_status_code(res);
 		if (resp != WLAN_STATUS_SUCCESS)
 			return resp;
@@ -3025,9 +3055,9 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 #ifdef CONFIG_OWE
 		if ((hapd->conf->wpa_key_mgmt & WPA_KEY_MGMT_OWE) &&
 		    wpa_auth_sta_key_mgmt(sta->wpa_sm) == WPA_KEY_MGMT_OWE &&
-		    elems.owe_dh) {
-			resp = owe_process_assoc_req(hapd, sta, elems.owe_dh,
-						     elems.owe_dh_len);
+		    elems->owe_dh) {
+			resp = owe_process_assoc_req(hapd, sta, elems->owe_dh,
+						     elems->owe_dh_len);
 			if (resp != WLAN_STATUS_SUCCESS)
 				return resp;
 		}
@@ -3040,7 +3070,7 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 		if ((hapd->conf->wpa_key_mgmt & WPA_KEY_MGMT_DPP) &&
 		    hapd->conf->dpp_netaccesskey && sta->wpa_sm &&
 		    wpa_auth_sta_key_mgmt(sta->wpa_sm) == WPA_KEY_MGMT_DPP &&
-		    elems.owe_dh) {
+		    elems->owe_dh) {
 			sta->dpp_pfs = dpp_pfs_init(
 				wpabuf_head(hapd->conf->dpp_netaccesskey),
 				wpabuf_len(hapd->conf->dpp_netaccesskey));
@@ -3051,8 +3081,8 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 				goto pfs_fail;
 			}
 
-			if (dpp_pfs_process(sta->dpp_pfs, elems.owe_dh,
-					    elems.owe_dh_len) < 0) {
+			if (dpp_pfs_process(sta->dpp_pfs, elems->owe_dh,
+					    elems->owe_dh_len) < 0) {
 				dpp_pfs_free(sta->dpp_pfs);
 				sta->dpp_pfs = NULL;
 				return WLAN_STATUS_UNSPECIFIED_FAILURE;
@@ -3077,7 +3107,7 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 #endif /* CONFIG_IEEE80211N */
 #ifdef CONFIG_HS20
 	} else if (hapd->conf->osen) {
-		if (elems.osen == NULL) {
+		if (elems->osen == NULL) {
 			hostapd_logger(
 				hapd, sta->addr, HOSTAPD_MODULE_IEEE80211,
 				HOSTAPD_LEVEL_INFO,
@@ -3095,7 +3125,7 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 			return WLAN_STATUS_UNSPECIFIED_FAILURE;
 		}
 		if (wpa_validate_osen(hapd->wpa_auth, sta->wpa_sm,
-				      elems.osen - 2, elems.osen_len + 2) < 0)
+				      elems->osen - 2, elems->osen_len + 2) < 0)
 			return WLAN_STATUS_INVALID_IE;
 #endif /* CONFIG_HS20 */
 	} else
@@ -3107,12 +3137,12 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 
 #ifdef CONFIG_HS20
 	wpabuf_free(sta->hs20_ie);
-	if (elems.hs20 && elems.hs20_len > 4) {
+	if (elems->hs20 && elems->hs20_len > 4) {
 		int release;
 
-		sta->hs20_ie = wpabuf_alloc_copy(elems.hs20 + 4,
-						 elems.hs20_len - 4);
-		release = ((elems.hs20[4] >> 4) & 0x0f) + 1;
+		sta->hs20_ie = wpabuf_alloc_copy(elems->hs20 + 4,
+						 elems->hs20_len - 4);
+		release = ((elems->hs20[4] >> 4) & 0x0f) + 1;
 		if (release >= 2 && !wpa_auth_uses_mfp(sta->wpa_sm)) {
 			wpa_printf(MSG_DEBUG,
 				   "HS 2.0: PMF not negotiated by release %d station "
@@ -3124,10 +3154,10 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 	}
 
 	wpabuf_free(sta->roaming_consortium);
-	if (elems.roaming_cons_sel)
+	if (elems->roaming_cons_sel)
 		sta->roaming_consortium = wpabuf_alloc_copy(
-			elems.roaming_cons_sel + 4,
-			elems.roaming_cons_sel_len - 4);
+			elems->roaming_cons_sel + 4,
+			elems->roaming_cons_sel_len - 4);
 	else
 		sta->roaming_consortium = NULL;
 #endif /* CONFIG_HS20 */
@@ -3135,16 +3165,16 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 #ifdef CONFIG_FST
 	wpabuf_free(sta->mb_ies);
 	if (hapd->iface->fst)
-		sta->mb_ies = mb_ies_by_info(&elems.mb_ies);
+		sta->mb_ies = mb_ies_by_info(&elems->mb_ies);
 	else
 		sta->mb_ies = NULL;
 #endif /* CONFIG_FST */
 
 #ifdef CONFIG_MBO
-	mbo_ap_check_sta_assoc(hapd, sta, &elems);
+	mbo_ap_check_sta_assoc(hapd, sta, elems);
 
 	if (hapd->conf->mbo_enabled && (hapd->conf->wpa & 2) &&
-	    elems.mbo && sta->cell_capa && !(sta->flags & WLAN_STA_MFP) &&
+	    elems->mbo && sta->cell_capa && !(sta->flags & WLAN_STA_MFP) &&
 	    hapd->conf->ieee80211w != NO_MGMT_FRAME_PROTECTION) {
 		wpa_printf(MSG_INFO,
 			   "MBO: Reject WPA2 association without PMF");
@@ -3173,7 +3203,7 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 					  &tx_seg1_idx) < 0)
 			return WLAN_STATUS_UNSPECIFIED_FAILURE;
 
-		if (ocv_verify_tx_params(elems.oci, elems.oci_len, &ci,
+		if (ocv_verify_tx_params(elems->oci, elems->oci_len, &ci,
 					 tx_chanwidth, tx_seg1_idx) != 0) {
 			wpa_printf(MSG_WARNING, "FILS: %s", ocv_errorstr);
 			return WLAN_STATUS_UNSPECIFIED_FAILURE;
@@ -3181,18 +3211,18 @@ static u16 check_assoc_ies(struct hostapd_data *hapd, struct sta_info *sta,
 	}
 #endif /* CONFIG_FILS && CONFIG_OCV */
 
-	ap_copy_sta_supp_op_classes(sta, elems.supp_op_classes,
-				    elems.supp_op_classes_len);
+	ap_copy_sta_supp_op_classes(sta, elems->supp_op_classes,
+				    elems->supp_op_classes_len);
 
 	if ((sta->capability & WLAN_CAPABILITY_RADIO_MEASUREMENT) &&
-	    elems.rrm_enabled &&
-	    elems.rrm_enabled_len >= sizeof(sta->rrm_enabled_capa))
-		os_memcpy(sta->rrm_enabled_capa, elems.rrm_enabled,
+	    elems->rrm_enabled &&
+	    elems->rrm_enabled_len >= sizeof(sta->rrm_enabled_capa))
+		os_memcpy(sta->rrm_enabled_capa, elems->rrm_enabled,
 			  sizeof(sta->rrm_enabled_capa));
 
-	if (elems.power_capab) {
-		sta->min_tx_power = elems.power_capab[0];
-		sta->max_tx_power = elems.power_capab[1];
+	if (elems->power_capab) {
+		sta->min_tx_power = elems->power_capab[0];
+		sta->max_tx_power = elems->power_capab[1];
 		sta->power_capab = 1;
 	} else {
 		sta->power_capab = 0;
@@ -3314,9 +3344,11 @@ static int add_associated_sta(struct hostapd_data *hapd,
 }
 
 
+/* elems: parsed ies or %NULL if the caller has not parsed them */
 static u16 send_assoc_resp(struct hostapd_data *hapd, struct sta_info *sta,
 			   const u8 *addr, u16 status_code, int reassoc,
-			   const u8 *ies, size_t ies_len, int rssi)
+			   const u8 *ies, size_t ies_len,
+			   const struct ieee802_11_elems *elems, int rssi)
 {
 	int send_len;
 	u8 *buf;
@@ -3550,10 +3582,17 @@ static u16 send_assoc_resp(struct hostapd_data *hapd, struct sta_info *sta,
 	     sta->auth_alg == WLAN_AUTH_FILS_SK_PFS ||
 	     sta->auth_alg == WLAN_AUTH_FILS_PK) &&
 	    status_code == WLAN_STATUS_SUCCESS) {
-		struct ieee802_11_elems elems;
+		struct ieee802_11_elems parsed;
 
-		if (ieee802_11_parse_elems(ies, ies_len, &elems, 0) ==
-		    ParseFailed || !elems.fils_session) {
+		if (!elems) {
+			if (ieee802_11_parse_elems(ies, ies_len, &parsed, 0) ==
+			    ParseFailed) {
+				res = WLAN_STATUS_UNSPECIFIED_FAILURE;
+				goto done;
+			}
+			elems = &parsed;
+		}
+		if (!elems->fils_session) {
 			res = WLAN_STATUS_UNSPECIFIED_FAILURE;
 			goto done;
 		}
@@ -3562,7 +3601,7 @@ static u16 send_assoc_resp(struct hostapd_data *hapd, struct sta_info *sta,
 		*p++ = WLAN_EID_EXTENSION; /* Element ID */
 		*p++ = 1 + FILS_SESSION_LEN; /* Length */
 		*p++ = WLAN_EID_EXT_FILS_SESSION; /* Element ID Extension */
-		os_memcpy(p, elems.fils_session, FILS_SESSION_LEN);
+		os_memcpy(p, elems->fils_session, FILS_SESSION_LEN);
 		send_len += 2 + 1 + FILS_SESSION_LEN;
 
 		send_len = fils_encrypt_assoc(sta->wpa_sm, buf, send_len,
@@ -3655,7 +3694,7 @@ void fils_hlp_finish_assoc(struct hostapd_data *hapd, struct sta_info *sta)
 	reply_res = send_assoc_resp(hapd, sta, sta->addr, WLAN_STATUS_SUCCESS,
 				    sta->fils_pending_assoc_is_reassoc,
 				    sta->fils_pending_assoc_req,
-				    sta->fils_pending_assoc_req_len, 0);
+				    sta->fils_pending_assoc_req_len, NULL, 0);
 	os_free(sta->fils_pending_assoc_req);
 	sta->fils_pending_assoc_req = NULL;
 	sta->fils_pending_assoc_req_len = 0;
@@ -3700,6 +3739,7 @@ static void handle_assoc(struct hostapd_data *hapd,
 	int left, i;
 	struct sta_info *sta;
 	u8 *tmp = NULL;
+	struct ieee802_11_elems elems, *parsed = NULL;
 	struct hostapd_sta_wpa_psk_short *psk = NULL;
 	char *identity = NULL;
 	char *radius_cui = NULL;
@@ -3741,23 +3781,25 @@ static void handle_assoc(struct hostapd_data *hapd,
 		capab_info = le_to_host16(mgmt->u.reassoc_req.capab_info);
 		listen_interval = le_to_host16(
 			mgmt->u.reassoc_req.listen_interval);
-		wpa_printf(MSG_DEBUG, "reassociation request: STA=" MACSTR
-			   " capab_info=0x%02x listen_interval=%d current_ap="
-			   MACSTR " seq_ctrl=0x%x%s",
-			   MAC2STR(mgmt->sa), capab_info, listen_interval,
-			   MAC2STR(mgmt->u.reassoc_req.current_ap),
-			   seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "reassociation request: STA=" MACSTR
+			       " capab_info=0x%02x listen_interval=%d "
+			       "current_ap=" MACSTR " seq_ctrl=0x%x%s",
+			       MAC2STR(mgmt->sa), capab_info, listen_interval,
+			       MAC2STR(mgmt->u.reassoc_req.current_ap),
+			       seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "");
 		left = len - (IEEE80211_HDRLEN + sizeof(mgmt->u.reassoc_req));
 		pos = mgmt->u.reassoc_req.variable;
 	} else {
 		capab_info = le_to_host16(mgmt->u.assoc_req.capab_info);
 		listen_interval = le_to_host16(
 			mgmt->u.assoc_req.listen_interval);
-		wpa_printf(MSG_DEBUG, "association request: STA=" MACSTR
-			   " capab_info=0x%02x listen_interval=%d "
-			   "seq_ctrl=0x%x%s",
-			   MAC2STR(mgmt->sa), capab_info, listen_interval,
-			   seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "association request: STA=" MACSTR
+			       " capab_info=0x%02x listen_interval=%d "
+			       "seq_ctrl=0x%x%s",
+			       MAC2STR(mgmt->sa), capab_info, listen_interval,
+			       seq_ctrl, (fc & WLAN_FC_RETRY) ? " retry" : "");
 		left = len - (IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_req));
 		pos = mgmt->u.assoc_req.variable;
 	}
@@ -3855,6 +3897,7 @@ static void handle_assoc(struct hostapd_data *hapd,
 	sta->last_seq_ctrl = seq_ctrl;
 	sta->last_subtype = reassoc ? WLAN_FC_STYPE_REASSOC_REQ :
 		WLAN_FC_STYPE_ASSOC_REQ;
+	sta_conn_trace(sta, STA_CONN_TRACE_ASSOC_RX);
 
 	if (hapd->tkip_countermeasures) {
 		resp = WLAN_STATUS_UNSPECIFIED_FAILURE;
@@ -3918,8 +3961,18 @@ static void handle_assoc(struct hostapd_data *hapd,
 #endif /* CONFIG_FILS */
 
 	/* followed by SSID and Supported rates; and HT capabilities if 802.11n
-	 * is used */
-	resp = check_assoc_ies(hapd, sta, pos, left, reassoc);
+	 * is used. The elements are parsed only once here and the result is
+	 * shared by the checks and the response. */
+	if (ieee802_11_parse_elems(pos, left, &elems, 1) == ParseFailed) {
+		hostapd_logger(hapd, sta->addr, HOSTAPD_MODULE_IEEE80211,
+			       HOSTAPD_LEVEL_INFO, "Station sent an invalid "
+			       "association request");
+		resp = WLAN_STATUS_UNSPECIFIED_FAILURE;
+		goto fail;
+	}
+	parsed = &elems;
+
+	resp = check_assoc_ies(hapd, sta, pos, left, parsed, reassoc);
 	if (resp != WLAN_STATUS_SUCCESS)
 		goto fail;
 
@@ -4082,7 +4135,7 @@ static void handle_assoc(struct hostapd_data *hapd,
 #endif /* CONFIG_FILS */
 
 	reply_res = send_assoc_resp(hapd, sta, mgmt->sa, resp, reassoc, pos,
-				    left, rssi);
+				    left, parsed, rssi);
 	os_free(tmp);
 
 	/*
@@ -4109,9 +4162,10 @@ static void handle_disassoc(struct hostapd_data *hapd,
 		return;
 	}
 
-	wpa_printf(MSG_DEBUG, "disassocation: STA=" MACSTR " reason_code=%d",
-		   MAC2STR(mgmt->sa),
-		   le_to_host16(mgmt->u.disassoc.reason_code));
+	wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+		       "disassocation: STA=" MACSTR " reason_code=%d",
+		       MAC2STR(mgmt->sa),
+		       le_to_host16(mgmt->u.disassoc.reason_code));
 
 	sta = ap_get_sta(hapd, mgmt->sa);
 	if (sta == NULL) {
@@ -4212,6 +4266,9 @@ static void handle_beacon(struct hostapd_data *hapd,
 		return;
 	}
 
+	if (ap_list_beacon_rate_limited(hapd->iface, mgmt->bssid))
+		return;
+
 	(void) ieee802_11_parse_elems(mgmt->u.beacon.variable,
 				      len - (IEEE80211_HDRLEN +
 					     sizeof(mgmt->u.beacon)), &elems,
@@ -4427,21 +4484,8 @@ static int handle_action(struct hostapd_data *hapd,
 }
 
 
-/**
- * ieee802_11_mgmt - process incoming IEEE 802.11 management frames
- * @hapd: hostapd BSS data structure (the BSS to which the management frame was
- * sent to)
- * @buf: management frame data (starting from IEEE 802.11 header)
- * @len: length of frame data in octets
- * @fi: meta data about received frame (signal level, etc.)
- *
- * Process all incoming IEEE 802.11 management frames. This will be called for
- * each frame received from the kernel driver through wlan#ap interface. In
- * addition, it can be called to re-inserted pending frames (e.g., when using
- * external RADIUS server as an MAC ACL).
- */
-int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
-		    struct hostapd_frame_info *fi)
+static int ieee802_11_mgmt_rx(struct hostapd_data *hapd, const u8 *buf,
+			      size_t len, struct hostapd_frame_info *fi)
 {
 	struct ieee80211_mgmt *mgmt;
 	u16 fc, stype;
@@ -4449,9 +4493,6 @@ int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
 	unsigned int freq;
 	int ssi_signal = fi ? fi->ssi_signal : 0;
 
-	if (len < 24)
-		return 0;
-
 	if (fi && fi->freq)
 		freq = fi->freq;
 	else
@@ -4476,8 +4517,9 @@ int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
 	    !(hapd->conf->mesh & MESH_ENABLED) &&
 #endif /* CONFIG_MESH */
 	    os_memcmp(mgmt->bssid, hapd->own_addr, ETH_ALEN) != 0) {
-		wpa_printf(MSG_INFO, "MGMT: BSSID=" MACSTR " not our address",
-			   MAC2STR(mgmt->bssid));
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_INFO,
+			       "MGMT: BSSID=" MACSTR " not our address",
+			       MAC2STR(mgmt->bssid));
 		return 0;
 	}
 
@@ -4502,22 +4544,26 @@ int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
 
 	switch (stype) {
 	case WLAN_FC_STYPE_AUTH:
-		wpa_printf(MSG_DEBUG, "mgmt::auth");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "mgmt::auth");
 		handle_auth(hapd, mgmt, len, ssi_signal, 0);
 		ret = 1;
 		break;
 	case WLAN_FC_STYPE_ASSOC_REQ:
-		wpa_printf(MSG_DEBUG, "mgmt::assoc_req");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "mgmt::assoc_req");
 		handle_assoc(hapd, mgmt, len, 0, ssi_signal);
 		ret = 1;
 		break;
 	case WLAN_FC_STYPE_REASSOC_REQ:
-		wpa_printf(MSG_DEBUG, "mgmt::reassoc_req");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "mgmt::reassoc_req");
 		handle_assoc(hapd, mgmt, len, 1, ssi_signal);
 		ret = 1;
 		break;
 	case WLAN_FC_STYPE_DISASSOC:
-		wpa_printf(MSG_DEBUG, "mgmt::disassoc");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "mgmt::disassoc");
 		handle_disassoc(hapd, mgmt, len);
 		ret = 1;
 		break;
@@ -4527,7 +4573,8 @@ int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
 		ret = 1;
 		break;
 	case WLAN_FC_STYPE_ACTION:
-		wpa_printf(MSG_DEBUG, "mgmt::action");
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_DEBUG,
+			       "mgmt::action");
 		ret = handle_action(hapd, mgmt, len, freq);
 		break;
 	default:
@@ -4541,6 +4588,100 @@ int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
 }
 
 
+/**
+ * ieee802_11_mgmt - process incoming IEEE 802.11 management frames
+ * @hapd: hostapd BSS data structure (the BSS to which the management frame was
+ * sent to)
+ * @buf: management frame data (starting from IEEE 802.11 header)
+ * @len: length of frame data in octets
+ * @fi: meta data about received frame (signal level, etc.)
+ *
+ * Process all incoming IEEE 802.11 management frames. This will be called for
+ * each frame received from the kernel driver through wlan#ap interface. In
+ * addition, it can be called to re-inserted pending frames (e.g., when using
+ * external RADIUS server as an MAC ACL). The number of frames and the time
+ * used to process them are recorded per frame subtype.
+ */
+int ieee802_11_mgmt(struct hostapd_data *hapd, const u8 *buf, size_t len,
+		    struct hostapd_frame_info *fi)
+{
+	const struct ieee80211_mgmt *mgmt = (const struct ieee80211_mgmt *) buf;
+	struct mgmt_rx_stats *stats;
+	struct os_reltime start, end, diff;
+	unsigned int usec, i;
+	int ret;
+
+	if (len < 24)
+		return 0;
+
+	os_get_reltime(&start);
+	ret = ieee802_11_mgmt_rx(hapd, buf, len, fi);
+	os_get_reltime(&end);
+
+	os_reltime_sub(&end, &start, &diff);
+	if (diff.sec >= 1000)
+		usec = 1000000000;
+	else
+		usec = diff.sec * 1000000 + diff.usec;
+	for (i = 0; i < MGMT_RX_HIST_BUCKETS - 1; i++) {
+		if (usec < (4U << (2 * i)))
+			break;
+	}
+
+	stats = &hapd->mgmt_rx_stats[
+		WLAN_FC_GET_STYPE(le_to_host16(mgmt->frame_control))];
+	stats->frames++;
+	if (!ret)
+		stats->ignored++;
+	stats->usec += usec;
+	stats->hist[i]++;
+
+	return ret;
+}
+
+
+int ieee802_11_mgmt_rx_stats(struct hostapd_data *hapd, char *buf,
+			     size_t buflen)
+{
+	static const char * const names[16] = {
+		"assoc_req", "assoc_resp", "reassoc_req", "reassoc_resp",
+		"probe_req", "probe_resp", "timing_adv", "7",
+		"beacon", "atim", "disassoc", "auth",
+		"deauth", "action", "action_noack", "15"
+	};
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+	unsigned int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(hapd->mgmt_rx_stats); i++) {
+		const struct mgmt_rx_stats *stats = &hapd->mgmt_rx_stats[i];
+
+		if (!stats->frames)
+			continue;
+		ret = os_snprintf(pos, end - pos,
+				  "mgmt_rx[%s]=frames:%u ignored:%u usec:%llu hist:",
+				  names[i], stats->frames, stats->ignored,
+				  (unsigned long long) stats->usec);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+		for (j = 0; j < MGMT_RX_HIST_BUCKETS; j++) {
+			ret = os_snprintf(pos, end - pos, "%s%u",
+					  j ? "/" : "", stats->hist[j]);
+			if (os_snprintf_error(end - pos, ret))
+				return pos - buf;
+			pos += ret;
+		}
+		ret = os_snprintf(pos, end - pos, "\n");
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
 static void handle_auth_cb(struct hostapd_data *hapd,
 			   const struct ieee80211_mgmt *mgmt,
 			   size_t len, int ok)
@@ -4578,6 +4719,7 @@ static void handle_auth_cb(struct hostapd_data *hapd,
 			       "did not acknowledge authentication response");
 		goto fail;
 	}
+	sta_conn_trace(sta, STA_CONN_TRACE_AUTH_ACK);
 
 	if (status_code == WLAN_STATUS_SUCCESS &&
 	    ((auth_alg == WLAN_AUTH_OPEN && auth_transaction == 2) ||
@@ -4662,6 +4804,7 @@ static void handle_assoc_cb(struct hostapd_data *hapd,
 
 		return;
 	}
+	sta_conn_trace(sta, STA_CONN_TRACE_ASSOC_RESP_ACK);
 
 	if (status != WLAN_STATUS_SUCCESS)
 		return;
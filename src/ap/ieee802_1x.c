@@ -753,6 +753,7 @@ void ieee802_1x_encapsulate_radius(struct hostapd_data *hapd,
 
 	if (radius_client_send(hapd->radius, msg, RADIUS_AUTH, sta->addr) < 0)
 		goto fail;
+	sta_conn_trace(sta, STA_CONN_TRACE_RADIUS_REQ_TX);
 
 	return;
 
@@ -787,6 +788,7 @@ static void handle_eap_response(struct hostapd_data *hapd,
 		       eap_server_get_name(0, type), type);
 
 	sm->dot1xAuthEapolRespFramesRx++;
+	sta_conn_trace(sta, STA_CONN_TRACE_EAP_RESP_RX);
 
 	wpabuf_free(sm->eap_if->eapRespData);
 	sm->eap_if->eapRespData = wpabuf_alloc_copy(eap, len);
@@ -996,6 +998,7 @@ void ieee802_1x_receive(struct hostapd_data *hapd, const u8 *sa, const u8 *buf,
 	    hdr->type == IEEE802_1X_TYPE_EAPOL_KEY &&
 	    (key->type == EAPOL_KEY_TYPE_WPA ||
 	     key->type == EAPOL_KEY_TYPE_RSN)) {
+		sta_conn_trace_eapol_key(sta, buf, sizeof(*hdr) + datalen, 0);
 		wpa_receive(hapd->wpa_auth, sta->wpa_sm, (u8 *) hdr,
 			    sizeof(*hdr) + datalen);
 		return;
@@ -1837,6 +1840,12 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 	sm->radius_identifier = -1;
 	wpa_printf(MSG_DEBUG, "RADIUS packet matching with station " MACSTR,
 		   MAC2STR(sta->addr));
+	if (hdr->code == RADIUS_CODE_ACCESS_ACCEPT)
+		sta_conn_trace(sta, STA_CONN_TRACE_RADIUS_ACCEPT_RX);
+	else if (hdr->code == RADIUS_CODE_ACCESS_REJECT)
+		sta_conn_trace(sta, STA_CONN_TRACE_RADIUS_REJECT_RX);
+	else
+		sta_conn_trace(sta, STA_CONN_TRACE_RADIUS_CHALLENGE_RX);
 
 	radius_msg_free(sm->last_recv_radius);
 	sm->last_recv_radius = msg;
@@ -2104,6 +2113,17 @@ static void ieee802_1x_eapol_send(void *ctx, void *sta_ctx, u8 type,
 	}
 #endif /* CONFIG_WPS */
 
+#ifdef CONFIG_STA_CONN_TRACE
+	if (type == IEEE802_1X_TYPE_EAP_PACKET && datalen >= 1) {
+		if (data[0] == EAP_CODE_REQUEST)
+			sta_conn_trace(sta_ctx, STA_CONN_TRACE_EAP_REQ_TX);
+		else if (data[0] == EAP_CODE_SUCCESS)
+			sta_conn_trace(sta_ctx, STA_CONN_TRACE_EAP_SUCCESS_TX);
+		else if (data[0] == EAP_CODE_FAILURE)
+			sta_conn_trace(sta_ctx, STA_CONN_TRACE_EAP_FAILURE_TX);
+	}
+#endif /* CONFIG_STA_CONN_TRACE */
+
 	ieee802_1x_send(ctx, sta_ctx, type, data, datalen);
 }
 
@@ -2586,6 +2606,22 @@ int ieee802_1x_get_mib(struct hostapd_data *hapd, char *buf, size_t buflen)
 }
 
 
+/* Memory used for the EAPOL state machine of a station, not including EAP
+ * method and RADIUS state */
+size_t ieee802_1x_sta_mem_usage(struct sta_info *sta)
+{
+	struct eapol_state_machine *sm = sta->eapol_sm;
+	size_t len;
+
+	if (!sm)
+		return 0;
+	len = sizeof(*sm) + sm->identity_len;
+	if (sm->radius_cui)
+		len += sizeof(struct wpabuf) + wpabuf_size(sm->radius_cui);
+	return len;
+}
+
+
 int ieee802_1x_get_mib_sta(struct hostapd_data *hapd, struct sta_info *sta,
 			   char *buf, size_t buflen)
 {
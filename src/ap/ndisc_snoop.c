@@ -22,6 +22,8 @@
 struct ip6addr {
 	struct in6_addr addr;
 	struct dl_list list;
+	struct ip6addr *hnext; /* next entry in hapd->ip6_hash list */
+	struct sta_info *sta;
 };
 
 struct icmpv6_ndmsg {
@@ -38,58 +40,87 @@ struct icmpv6_ndmsg {
 #define NEIGHBOR_ADVERTISEMENT	136
 #define SOURCE_LL_ADDR		1
 
-static int sta_ip6addr_add(struct sta_info *sta, struct in6_addr *addr)
+static unsigned int ip6_hash(const struct in6_addr *addr)
+{
+	/* The interface identifier is the part that differs between stations
+	 * on the same link */
+	return (addr->s6_addr[12] ^ addr->s6_addr[13] ^ addr->s6_addr[14] ^
+		addr->s6_addr[15]) % X_SNOOP_HASH_SIZE;
+}
+
+
+static struct ip6addr * ndisc_snoop_get_ip6addr(struct hostapd_data *hapd,
+						const struct in6_addr *addr)
+{
+	struct ip6addr *ip6addr;
+
+	if (!hapd->ip6_hash)
+		return NULL;
+
+	for (ip6addr = hapd->ip6_hash[ip6_hash(addr)]; ip6addr;
+	     ip6addr = ip6addr->hnext) {
+		if (ip6addr->addr.s6_addr32[0] == addr->s6_addr32[0] &&
+		    ip6addr->addr.s6_addr32[1] == addr->s6_addr32[1] &&
+		    ip6addr->addr.s6_addr32[2] == addr->s6_addr32[2] &&
+		    ip6addr->addr.s6_addr32[3] == addr->s6_addr32[3])
+			return ip6addr;
+	}
+
+	return NULL;
+}
+
+
+static int sta_ip6addr_add(struct hostapd_data *hapd, struct sta_info *sta,
+			   struct in6_addr *addr)
 {
 	struct ip6addr *ip6addr;
+	unsigned int h;
 
 	ip6addr = os_zalloc(sizeof(*ip6addr));
 	if (!ip6addr)
 		return -1;
 
 	os_memcpy(&ip6addr->addr, addr, sizeof(*addr));
+	ip6addr->sta = sta;
 
 	dl_list_add_tail(&sta->ip6addr, &ip6addr->list);
+	if (hapd->ip6_hash) {
+		h = ip6_hash(addr);
+		ip6addr->hnext = hapd->ip6_hash[h];
+		hapd->ip6_hash[h] = ip6addr;
+	}
 
 	return 0;
 }
 
 
-void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
-{
-	struct ip6addr *ip6addr, *prev;
-
-	dl_list_for_each_safe(ip6addr, prev, &sta->ip6addr, struct ip6addr,
-			      list) {
-		hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &ip6addr->addr);
-		os_free(ip6addr);
-	}
-}
-
-
-static int sta_has_ip6addr(struct sta_info *sta, struct in6_addr *addr)
+static void sta_ip6addr_remove(struct hostapd_data *hapd,
+			       struct ip6addr *ip6addr)
 {
-	struct ip6addr *ip6addr;
-
-	dl_list_for_each(ip6addr, &sta->ip6addr, struct ip6addr, list) {
-		if (ip6addr->addr.s6_addr32[0] == addr->s6_addr32[0] &&
-		    ip6addr->addr.s6_addr32[1] == addr->s6_addr32[1] &&
-		    ip6addr->addr.s6_addr32[2] == addr->s6_addr32[2] &&
-		    ip6addr->addr.s6_addr32[3] == addr->s6_addr32[3])
-			return 1;
+	struct ip6addr **p;
+
+	if (hapd->ip6_hash) {
+		for (p = &hapd->ip6_hash[ip6_hash(&ip6addr->addr)]; *p;
+		     p = &(*p)->hnext) {
+			if (*p == ip6addr) {
+				*p = ip6addr->hnext;
+				break;
+			}
+		}
 	}
-
-	return 0;
+	dl_list_del(&ip6addr->list);
+	os_free(ip6addr);
 }
 
 
-static void ucast_to_stas(struct hostapd_data *hapd, const u8 *buf, size_t len)
+void sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta)
 {
-	struct sta_info *sta;
+	struct ip6addr *ip6addr, *prev;
 
-	for (sta = hapd->sta_list; sta; sta = sta->next) {
-		if (!(sta->flags & WLAN_STA_AUTHORIZED))
-			continue;
-		x_snoop_mcast_to_ucast_convert_send(hapd, sta, (u8 *) buf, len);
+	dl_list_for_each_safe(ip6addr, prev, &sta->ip6addr, struct ip6addr,
+			      list) {
+		hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &ip6addr->addr);
+		sta_ip6addr_remove(hapd, ip6addr);
 	}
 }
 
@@ -99,8 +130,9 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 {
 	struct hostapd_data *hapd = ctx;
 	struct icmpv6_ndmsg *msg;
-	struct in6_addr saddr;
+	struct in6_addr saddr, taddr;
 	struct sta_info *sta;
+	struct ip6addr *ip6addr;
 	int res;
 	char addrtxt[INET6_ADDRSTRLEN + 1];
 
@@ -109,6 +141,14 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 	msg = (struct icmpv6_ndmsg *) &buf[ETH_HLEN];
 	switch (msg->icmp6h.icmp6_type) {
 	case NEIGHBOR_SOLICITATION:
+		if (len < ETH_HLEN + offsetof(struct icmpv6_ndmsg, opt_type))
+			return;
+		os_memcpy(&taddr, &msg->target_addr, sizeof(taddr));
+		if (ndisc_snoop_get_ip6addr(hapd, &taddr))
+			hapd->ndisc_ns_proxied++;
+		else
+			hapd->ndisc_ns_forwarded++;
+
 		if (len < ETH_HLEN + sizeof(*msg))
 			return;
 		if (msg->opt_type != SOURCE_LL_ADDR)
@@ -127,12 +167,21 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 			if (!sta)
 				return;
 
-			if (sta_has_ip6addr(sta, &saddr))
+			ip6addr = ndisc_snoop_get_ip6addr(hapd, &saddr);
+			if (ip6addr && ip6addr->sta == sta)
 				return;
 
 			if (inet_ntop(AF_INET6, &saddr, addrtxt,
 				      sizeof(addrtxt)) == NULL)
 				addrtxt[0] = '\0';
+			if (ip6addr) {
+				wpa_printf(MSG_DEBUG,
+					   "ndisc_snoop: IPv6 address %s moved from "
+					   MACSTR, addrtxt,
+					   MAC2STR(ip6addr->sta->addr));
+				sta_ip6addr_remove(hapd, ip6addr);
+				hapd->proxyarp_addr_moved++;
+			}
 			wpa_printf(MSG_DEBUG, "ndisc_snoop: Learned new IPv6 address %s for "
 				   MACSTR, addrtxt, MAC2STR(sta->addr));
 			hostapd_drv_br_delete_ip_neigh(hapd, 6, (u8 *) &saddr);
@@ -146,17 +195,19 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 				return;
 			}
 
-			if (sta_ip6addr_add(sta, &saddr))
+			if (sta_ip6addr_add(hapd, sta, &saddr))
 				return;
 		}
 		break;
 	case ROUTER_ADVERTISEMENT:
 		if (hapd->conf->disable_dgaf)
-			ucast_to_stas(hapd, buf, len);
+			x_snoop_mcast_to_ucast_convert_send_all(
+				hapd, (u8 *) buf, len);
 		break;
 	case NEIGHBOR_ADVERTISEMENT:
 		if (hapd->conf->na_mcast_to_ucast)
-			ucast_to_stas(hapd, buf, len);
+			x_snoop_mcast_to_ucast_convert_send_all(
+				hapd, (u8 *) buf, len);
 		break;
 	default:
 		break;
@@ -166,6 +217,11 @@ static void handle_ndisc(void *ctx, const u8 *src_addr, const u8 *buf,
 
 int ndisc_snoop_init(struct hostapd_data *hapd)
 {
+	hapd->ip6_hash = os_calloc(X_SNOOP_HASH_SIZE,
+				   sizeof(struct ip6addr *));
+	if (!hapd->ip6_hash)
+		return -1;
+
 	hapd->sock_ndisc = x_snoop_get_l2_packet(hapd, handle_ndisc,
 						 L2_PACKET_FILTER_NDISC);
 	if (hapd->sock_ndisc == NULL) {
@@ -183,4 +239,6 @@ void ndisc_snoop_deinit(struct hostapd_data *hapd)
 {
 	l2_packet_deinit(hapd->sock_ndisc);
 	hapd->sock_ndisc = NULL;
+	os_free(hapd->ip6_hash);
+	hapd->ip6_hash = NULL;
 }
@@ -21,8 +21,7 @@ hostapd_neighbor_get(struct hostapd_data *hapd, const u8 *bssid,
 {
 	struct hostapd_neighbor_entry *nr;
 
-	dl_list_for_each(nr, &hapd->nr_db, struct hostapd_neighbor_entry,
-			 list) {
+	for (nr = hapd->nr_hash[NR_HASH(bssid)]; nr; nr = nr->hnext) {
 		if (os_memcmp(bssid, nr->bssid, ETH_ALEN) == 0 &&
 		    (!ssid ||
 		     (ssid->ssid_len == nr->ssid.ssid_len &&
@@ -34,6 +33,34 @@ hostapd_neighbor_get(struct hostapd_data *hapd, const u8 *bssid,
 }
 
 
+/**
+ * hostapd_neighbor_flush_resp_cache - Invalidate cached Neighbor Report data
+ * @hapd: Pointer to BSS data
+ *
+ * This needs to be called whenever the neighbor database changes.
+ */
+void hostapd_neighbor_flush_resp_cache(struct hostapd_data *hapd)
+{
+	wpabuf_free(hapd->nr_resp_cache);
+	hapd->nr_resp_cache = NULL;
+}
+
+
+static void hostapd_neighbor_hash_del(struct hostapd_data *hapd,
+				      struct hostapd_neighbor_entry *nr)
+{
+	struct hostapd_neighbor_entry **p;
+
+	for (p = &hapd->nr_hash[NR_HASH(nr->bssid)]; *p; p = &(*p)->hnext) {
+		if (*p == nr) {
+			*p = nr->hnext;
+			break;
+		}
+	}
+	nr->hnext = NULL;
+}
+
+
 static void hostapd_neighbor_clear_entry(struct hostapd_neighbor_entry *nr)
 {
 	wpabuf_free(nr->nr);
@@ -70,9 +97,13 @@ int hostapd_neighbor_set(struct hostapd_data *hapd, const u8 *bssid,
 {
 	struct hostapd_neighbor_entry *entry;
 
+	hostapd_neighbor_flush_resp_cache(hapd);
+
 	entry = hostapd_neighbor_get(hapd, bssid, ssid);
 	if (!entry)
 		entry = hostapd_neighbor_add(hapd);
+	else
+		hostapd_neighbor_hash_del(hapd, entry);
 	if (!entry)
 		return -1;
 
@@ -80,6 +111,8 @@ int hostapd_neighbor_set(struct hostapd_data *hapd, const u8 *bssid,
 
 	os_memcpy(entry->bssid, bssid, ETH_ALEN);
 	os_memcpy(&entry->ssid, ssid, sizeof(entry->ssid));
+	entry->hnext = hapd->nr_hash[NR_HASH(bssid)];
+	hapd->nr_hash[NR_HASH(bssid)] = entry;
 
 	entry->nr = wpabuf_dup(nr);
 	if (!entry->nr)
@@ -116,6 +149,8 @@ int hostapd_neighbor_remove(struct hostapd_data *hapd, const u8 *bssid,
 	if (!nr)
 		return -1;
 
+	hostapd_neighbor_flush_resp_cache(hapd);
+	hostapd_neighbor_hash_del(hapd, nr);
 	hostapd_neighbor_clear_entry(nr);
 	dl_list_del(&nr->list);
 	os_free(nr);
@@ -134,6 +169,8 @@ void hostapd_free_neighbor_db(struct hostapd_data *hapd)
 		dl_list_del(&nr->list);
 		os_free(nr);
 	}
+	os_memset(hapd->nr_hash, 0, sizeof(hapd->nr_hash));
+	hostapd_neighbor_flush_resp_cache(hapd);
 }
 
 
@@ -21,5 +21,6 @@ void hostapd_neighbor_set_own_report(struct hostapd_data *hapd);
 int hostapd_neighbor_remove(struct hostapd_data *hapd, const u8 *bssid,
 			    const struct wpa_ssid_value *ssid);
 void hostapd_free_neighbor_db(struct hostapd_data *hapd);
+void hostapd_neighbor_flush_resp_cache(struct hostapd_data *hapd);
 
 #endif /* NEIGHBOR_DB_H */
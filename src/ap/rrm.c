@@ -196,28 +196,14 @@ static size_t hostapd_neighbor_report_len(struct wpabuf *buf,
 }
 
 
-static void hostapd_send_nei_report_resp(struct hostapd_data *hapd,
-					 const u8 *addr, u8 dialog_token,
-					 struct wpa_ssid_value *ssid, u8 lci,
-					 u8 civic, u16 lci_max_age)
+static void hostapd_add_nei_report_elems(struct hostapd_data *hapd,
+					 struct wpabuf *buf,
+					 const struct wpa_ssid_value *ssid,
+					 u8 lci, u8 civic, u16 lci_max_age)
 {
 	struct hostapd_neighbor_entry *nr;
-	struct wpabuf *buf;
 	u8 *msmt_token;
 
-	/*
-	 * The number and length of the Neighbor Report elements in a Neighbor
-	 * Report frame is limited by the maximum allowed MMPDU size; + 3 bytes
-	 * of RRM header.
-	 */
-	buf = wpabuf_alloc(3 + IEEE80211_MAX_MMPDU_SIZE);
-	if (!buf)
-		return;
-
-	wpabuf_put_u8(buf, WLAN_ACTION_RADIO_MEASUREMENT);
-	wpabuf_put_u8(buf, WLAN_RRM_NEIGHBOR_REPORT_RESPONSE);
-	wpabuf_put_u8(buf, dialog_token);
-
 	dl_list_for_each(nr, &hapd->nr_db, struct hostapd_neighbor_entry,
 			 list) {
 		int send_lci;
@@ -268,6 +254,57 @@ static void hostapd_send_nei_report_resp(struct hostapd_data *hapd,
 			*msmt_token = civic;
 		}
 	}
+}
+
+
+static void hostapd_send_nei_report_resp(struct hostapd_data *hapd,
+					 const u8 *addr, u8 dialog_token,
+					 struct wpa_ssid_value *ssid, u8 lci,
+					 u8 civic, u16 lci_max_age)
+{
+	struct wpabuf *buf, *cache = NULL;
+
+	/*
+	 * The number and length of the Neighbor Report elements in a Neighbor
+	 * Report frame is limited by the maximum allowed MMPDU size; + 3 bytes
+	 * of RRM header.
+	 */
+	buf = wpabuf_alloc(3 + IEEE80211_MAX_MMPDU_SIZE);
+	if (!buf)
+		return;
+
+	wpabuf_put_u8(buf, WLAN_ACTION_RADIO_MEASUREMENT);
+	wpabuf_put_u8(buf, WLAN_RRM_NEIGHBOR_REPORT_RESPONSE);
+	wpabuf_put_u8(buf, dialog_token);
+
+	/*
+	 * Requests without LCI and civic location are served from the
+	 * elements built for the previous request for the same SSID as long as
+	 * the neighbor database has not changed.
+	 */
+	if (!lci && !civic) {
+		if (!hapd->nr_resp_cache ||
+		    hapd->nr_resp_ssid.ssid_len != ssid->ssid_len ||
+		    os_memcmp(hapd->nr_resp_ssid.ssid, ssid->ssid,
+			      ssid->ssid_len) != 0) {
+			hostapd_neighbor_flush_resp_cache(hapd);
+			cache = wpabuf_alloc(IEEE80211_MAX_MMPDU_SIZE);
+			if (cache) {
+				hostapd_add_nei_report_elems(hapd, cache, ssid,
+							     0, 0, 0);
+				hapd->nr_resp_cache = cache;
+				os_memcpy(&hapd->nr_resp_ssid, ssid,
+					  sizeof(*ssid));
+			}
+		}
+		cache = hapd->nr_resp_cache;
+	}
+
+	if (cache)
+		wpabuf_put_buf(buf, cache);
+	else
+		hostapd_add_nei_report_elems(hapd, buf, ssid, lci, civic,
+					     lci_max_age);
 
 	hostapd_drv_send_action(hapd, hapd->iface->freq, 0, addr,
 				wpabuf_head(buf), wpabuf_len(buf));
@@ -35,6 +35,7 @@
 #include "gas_serv.h"
 #include "wnm_ap.h"
 #include "mbo_ap.h"
+#include "dhcp_snoop.h"
 #include "ndisc_snoop.h"
 #include "sta_info.h"
 #include "vlan.h"
@@ -52,6 +53,264 @@ static void ap_sa_query_timer(void *eloop_ctx, void *timeout_ctx);
 static int ap_sta_remove(struct hostapd_data *hapd, struct sta_info *sta);
 static void ap_sta_delayed_1x_auth_fail_cb(void *eloop_ctx, void *timeout_ctx);
 
+#ifndef WPA_TRACE
+
+/*
+ * Station entries are allocated from slabs of STA_SLAB_ENTRIES entries instead
+ * of a separate heap allocation for each station. Slabs with free entries are
+ * kept in the beginning of the list, so allocation uses the first slab. One
+ * empty slab is kept to avoid allocating and freeing a slab when a single
+ * station connects and disconnects repeatedly. WPA_TRACE builds allocate each
+ * entry separately to keep the os_malloc() allocation tracking usable.
+ */
+#define STA_SLAB_ENTRIES 32
+
+struct sta_slab;
+
+struct sta_slab_entry {
+	struct sta_slab *slab;
+	union {
+		struct sta_info sta;
+		struct sta_slab_entry *next_free;
+	} u;
+};
+
+struct sta_slab {
+	struct dl_list list;
+	struct sta_slab_entry *free;
+	unsigned int used;
+	struct sta_slab_entry entry[STA_SLAB_ENTRIES];
+};
+
+static struct dl_list sta_slabs = DL_LIST_HEAD_INIT(sta_slabs);
+static unsigned int sta_slab_count, sta_slab_empty, sta_slab_used;
+
+
+static struct sta_info * ap_sta_alloc(void)
+{
+	struct sta_slab *slab;
+	struct sta_slab_entry *entry;
+	unsigned int i;
+
+	slab = dl_list_first(&sta_slabs, struct sta_slab, list);
+	if (!slab || !slab->free) {
+		slab = os_zalloc(sizeof(*slab));
+		if (!slab)
+			return NULL;
+		for (i = STA_SLAB_ENTRIES; i > 0; i--) {
+			entry = &slab->entry[i - 1];
+			entry->slab = slab;
+			entry->u.next_free = slab->free;
+			slab->free = entry;
+		}
+		dl_list_add(&sta_slabs, &slab->list);
+		sta_slab_count++;
+		sta_slab_empty++;
+	}
+
+	entry = slab->free;
+	slab->free = entry->u.next_free;
+	if (slab->used++ == 0)
+		sta_slab_empty--;
+	sta_slab_used++;
+	if (!slab->free) {
+		/* Move the full slab to the end of the list */
+		dl_list_del(&slab->list);
+		dl_list_add_tail(&sta_slabs, &slab->list);
+	}
+
+	os_memset(&entry->u.sta, 0, sizeof(entry->u.sta));
+	return &entry->u.sta;
+}
+
+
+static void ap_sta_release(struct sta_info *sta)
+{
+	struct sta_slab_entry *entry;
+	struct sta_slab *slab;
+
+	entry = (struct sta_slab_entry *)
+		((u8 *) sta - offsetof(struct sta_slab_entry, u));
+	slab = entry->slab;
+	if (!slab->free) {
+		dl_list_del(&slab->list);
+		dl_list_add(&sta_slabs, &slab->list);
+	}
+	entry->u.next_free = slab->free;
+	slab->free = entry;
+	sta_slab_used--;
+	if (--slab->used > 0)
+		return;
+
+	if (sta_slab_empty) {
+		dl_list_del(&slab->list);
+		os_free(slab);
+		sta_slab_count--;
+	} else {
+		sta_slab_empty++;
+	}
+}
+
+
+static void ap_sta_slab_flush(void)
+{
+	struct sta_slab *slab, *prev;
+
+	dl_list_for_each_safe(slab, prev, &sta_slabs, struct sta_slab, list) {
+		if (slab->used)
+			continue;
+		dl_list_del(&slab->list);
+		os_free(slab);
+		sta_slab_count--;
+		sta_slab_empty--;
+	}
+}
+
+
+/**
+ * ap_sta_slab_status - Get status of the station entry allocator
+ * @buf: Buffer for the status text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written
+ *
+ * The allocator is shared by all interfaces and BSSs in the process, so this
+ * is reported in the global control interface STATUS output.
+ */
+int ap_sta_slab_status(char *buf, size_t buflen)
+{
+	int ret;
+
+	ret = os_snprintf(buf, buflen,
+			  "sta_entry_size=%u\n"
+			  "sta_slabs=%u\n"
+			  "sta_slab_entries_used=%u\n"
+			  "sta_slab_entries_free=%u\n",
+			  (unsigned int) sizeof(struct sta_slab_entry),
+			  sta_slab_count, sta_slab_used,
+			  sta_slab_count * STA_SLAB_ENTRIES - sta_slab_used);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+#else /* WPA_TRACE */
+
+static struct sta_info * ap_sta_alloc(void)
+{
+	return os_zalloc(sizeof(struct sta_info));
+}
+
+
+static void ap_sta_release(struct sta_info *sta)
+{
+	os_free(sta);
+}
+
+
+static void ap_sta_slab_flush(void)
+{
+}
+
+
+int ap_sta_slab_status(char *buf, size_t buflen)
+{
+	int ret;
+
+	ret = os_snprintf(buf, buflen, "sta_entry_size=%u\n",
+			  (unsigned int) sizeof(struct sta_info));
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+#endif /* WPA_TRACE */
+
+
+static size_t wpabuf_mem_usage(const struct wpabuf *buf)
+{
+	return buf ? sizeof(*buf) + wpabuf_size(buf) : 0;
+}
+
+
+static size_t str_mem_usage(const char *str)
+{
+	return str ? os_strlen(str) + 1 : 0;
+}
+
+
+/**
+ * ap_sta_mem_usage - Estimate the memory used for a station
+ * @sta: Station
+ * Returns: Number of octets allocated for the station entry and the state
+ * owned by it (not including allocator overhead)
+ */
+size_t ap_sta_mem_usage(struct sta_info *sta)
+{
+	size_t len = sizeof(*sta);
+
+	if (sta->ht_capabilities)
+		len += sizeof(*sta->ht_capabilities);
+	if (sta->vht_capabilities)
+		len += sizeof(*sta->vht_capabilities);
+	if (sta->vht_operation)
+		len += sizeof(*sta->vht_operation);
+	if (sta->drv_stats)
+		len += sizeof(*sta->drv_stats);
+	if (sta->challenge)
+		len += WLAN_AUTH_CHALLENGE_LEN;
+	if (sta->supp_op_classes)
+		len += 1 + sta->supp_op_classes[0];
+	if (sta->ext_capability)
+		len += 1 + sta->ext_capability[0];
+	if (sta->pending_eapol_rx)
+		len += sizeof(*sta->pending_eapol_rx) +
+			wpabuf_mem_usage(sta->pending_eapol_rx->buf);
+	len += str_mem_usage(sta->identity);
+	len += str_mem_usage(sta->radius_cui);
+	len += str_mem_usage(sta->remediation_url);
+	len += str_mem_usage(sta->t_c_url);
+	len += str_mem_usage(sta->hs20_session_info_url);
+	len += str_mem_usage(sta->ifname_wds);
+	len += wpabuf_mem_usage(sta->wps_ie);
+	len += wpabuf_mem_usage(sta->p2p_ie);
+	len += wpabuf_mem_usage(sta->hs20_ie);
+	len += wpabuf_mem_usage(sta->roaming_consortium);
+	len += wpabuf_mem_usage(sta->hs20_deauth_req);
+#ifdef CONFIG_IEEE80211W
+	len += sta->sa_query_count * WLAN_SA_QUERY_TR_ID_LEN;
+#endif /* CONFIG_IEEE80211W */
+#if defined(CONFIG_INTERWORKING) || defined(CONFIG_DPP)
+	if (sta->gas_dialog)
+		len += GAS_DIALOG_MAX * sizeof(struct gas_dialog_info);
+#endif /* CONFIG_INTERWORKING || CONFIG_DPP */
+#ifdef CONFIG_FST
+	len += wpabuf_mem_usage(sta->mb_ies);
+#endif /* CONFIG_FST */
+#ifdef CONFIG_SAE
+	if (sta->sae)
+		len += sizeof(*sta->sae);
+#endif /* CONFIG_SAE */
+#ifdef CONFIG_TAXONOMY
+	len += wpabuf_mem_usage(sta->probe_ie_taxonomy);
+	len += wpabuf_mem_usage(sta->assoc_ie_taxonomy);
+#endif /* CONFIG_TAXONOMY */
+#ifdef CONFIG_FILS
+	len += sta->fils_pending_assoc_req_len;
+	len += wpabuf_mem_usage(sta->fils_hlp_resp);
+	len += wpabuf_mem_usage(sta->hlp_dhcp_discover);
+	len += wpabuf_mem_usage(sta->fils_dh_ss);
+	len += wpabuf_mem_usage(sta->fils_g_sta);
+#endif /* CONFIG_FILS */
+#ifdef CONFIG_OWE
+	len += sta->owe_pmk_len;
+#endif /* CONFIG_OWE */
+	len += wpa_auth_sta_mem_usage(sta->wpa_sm);
+	len += ieee802_1x_sta_mem_usage(sta);
+
+	return len;
+}
+
+
 int ap_for_each_sta(struct hostapd_data *hapd,
 		    int (*cb)(struct hostapd_data *hapd, struct sta_info *sta,
 			      void *ctx),
@@ -172,6 +431,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 
 	if (sta->ipaddr)
 		hostapd_drv_br_delete_ip_neigh(hapd, 4, (u8 *) &sta->ipaddr);
+	dhcp_snoop_sta_free(hapd, sta);
 	ap_sta_ip6addr_del(hapd, sta);
 
 	if (!hapd->iface->driver_ap_teardown &&
@@ -183,9 +443,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 	ap_sta_hash_del(hapd, sta);
 	ap_sta_list_del(hapd, sta);
 
-	if (sta->aid > 0)
-		hapd->sta_aid[(sta->aid - 1) / 32] &=
-			~BIT((sta->aid - 1) % 32);
+	hostapd_free_aid(hapd, sta);
 
 	hapd->num_sta--;
 	if (sta->nonerp_set) {
@@ -369,6 +627,7 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 #endif /* CONFIG_DPP2 */
 
 	os_free(sta->ext_capability);
+	os_free(sta->drv_stats);
 
 #ifdef CONFIG_WNM_AP
 	eloop_cancel_timeout(ap_sta_reset_steer_flag_timer, hapd, sta);
@@ -376,7 +635,97 @@ void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 
 	os_free(sta->ifname_wds);
 
-	os_free(sta);
+	ap_sta_release(sta);
+}
+
+
+static void ap_sta_stats_dump_cb(void *ctx, const u8 *addr,
+				 struct hostap_sta_driver_data *data)
+{
+	struct hostapd_data *hapd = ctx;
+	struct sta_info *sta;
+
+	sta = ap_get_sta(hapd, addr);
+	if (!sta)
+		return;
+	if (!sta->drv_stats) {
+		sta->drv_stats = os_malloc(sizeof(*sta->drv_stats));
+		if (!sta->drv_stats)
+			return;
+	}
+	os_memcpy(sta->drv_stats, data, sizeof(*data));
+	os_get_reltime(&sta->drv_stats_time);
+}
+
+
+/*
+ * Fetch the driver statistics of all stations with a single request. This is
+ * repeated every sta_stats_interval milliseconds while there are associated
+ * stations so that the users of the statistics do not need to query the
+ * driver separately for each station.
+ */
+static void ap_sta_stats_refresh(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	unsigned int interval = hapd->conf->sta_stats_interval;
+
+	if (!interval || hapd->num_sta == 0)
+		return;
+
+	if (hostapd_drv_read_all_sta_data(hapd, ap_sta_stats_dump_cb,
+					  hapd) < 0)
+		wpa_printf(MSG_DEBUG, "Failed to fetch station statistics");
+
+	eloop_register_timeout(interval / 1000, (interval % 1000) * 1000,
+			       ap_sta_stats_refresh, hapd, NULL);
+}
+
+
+/* Returns the age of the statistics from the last station dump in msec if
+ * they are recent enough for user, -1 otherwise */
+static int ap_sta_stats_age(struct hostapd_data *hapd, struct sta_info *sta,
+			    enum sta_stats_user user)
+{
+	struct hostapd_bss_config *conf = hapd->conf;
+	int max_age = conf->sta_stats_max_age[user];
+	struct os_reltime now, age;
+
+	if (max_age < 0)
+		max_age = 2 * conf->sta_stats_interval;
+	if (!conf->sta_stats_interval || !sta->drv_stats || max_age <= 0)
+		return -1;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &sta->drv_stats_time, &age);
+	if (age.sec >= max_age / 1000 + 1 ||
+	    age.sec * 1000 + age.usec / 1000 > max_age)
+		return -1;
+	return age.sec * 1000 + age.usec / 1000;
+}
+
+
+/**
+ * ap_sta_read_stats - Get driver statistics for a station
+ * @hapd: BSS data
+ * @sta: Station
+ * @user: The user of the statistics
+ * @data: Buffer for returning the statistics
+ * Returns: 0 on success, -1 on failure
+ *
+ * The statistics from the last station dump are used if they are not older
+ * than the sta_stats_max_age value for @user; otherwise, the statistics are
+ * requested from the driver for this station.
+ */
+int ap_sta_read_stats(struct hostapd_data *hapd, struct sta_info *sta,
+		      enum sta_stats_user user,
+		      struct hostap_sta_driver_data *data)
+{
+	if (ap_sta_stats_age(hapd, sta, user) >= 0) {
+		os_memcpy(data, sta->drv_stats, sizeof(*data));
+		return 0;
+	}
+
+	return hostapd_drv_read_sta_data(hapd, data, sta->addr);
 }
 
 
@@ -384,6 +733,7 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 {
 	struct sta_info *sta, *prev;
 
+	eloop_cancel_timeout(ap_sta_stats_refresh, hapd, NULL);
 	sta = hapd->sta_list;
 
 	while (sta) {
@@ -397,6 +747,24 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 			   MAC2STR(prev->addr));
 		ap_free_sta(hapd, prev);
 	}
+
+	ap_sta_slab_flush();
+}
+
+
+static int ap_sta_get_inact_sec(struct hostapd_data *hapd,
+				struct sta_info *sta)
+{
+	int age;
+
+	/* Use the shared statistics only if the driver reported inactivity.
+	 * The station has been inactive at least for the age of the sample
+	 * longer than what was reported in it. */
+	age = ap_sta_stats_age(hapd, sta, STA_STATS_INACTIVITY);
+	if (age >= 0 && sta->drv_stats->inactive_msec != (unsigned long) -1)
+		return (sta->drv_stats->inactive_msec + age) / 1000;
+
+	return hostapd_drv_get_inact_sec(hapd, sta->addr);
 }
 
 
@@ -436,7 +804,7 @@ void ap_handle_timer(void *eloop_ctx, void *timeout_ctx)
 		 * stations that are idle (but keep re-associating).
 		 */
 		int fuzz = os_random() % 20;
-		inactive_sec = hostapd_drv_get_inact_sec(hapd, sta->addr);
+		inactive_sec = ap_sta_get_inact_sec(hapd, sta);
 		if (inactive_sec == -1) {
 			wpa_msg(hapd->msg_ctx, MSG_DEBUG,
 				"Check inactivity: Could not "
@@ -683,14 +1051,14 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 		return NULL;
 	}
 
-	sta = os_zalloc(sizeof(struct sta_info));
+	sta = ap_sta_alloc();
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
 		return NULL;
 	}
 	sta->acct_interim_interval = hapd->conf->acct_interim_interval;
 	if (accounting_sta_get_id(hapd, sta) < 0) {
-		os_free(sta);
+		ap_sta_release(sta);
 		return NULL;
 	}
 
@@ -708,6 +1076,11 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 	sta->next = hapd->sta_list;
 	hapd->sta_list = sta;
 	hapd->num_sta++;
+	if (hapd->conf->sta_stats_interval &&
+	    !eloop_is_timeout_registered(ap_sta_stats_refresh, hapd, NULL))
+		eloop_register_timeout(hapd->conf->sta_stats_interval / 1000,
+				       (hapd->conf->sta_stats_interval % 1000) *
+				       1000, ap_sta_stats_refresh, hapd, NULL);
 	ap_sta_hash_add(hapd, sta);
 	ap_sta_remove_in_other_bss(hapd, sta);
 	sta->last_seq_ctrl = WLAN_INVALID_MGMT_SEQ;
@@ -1215,10 +1588,12 @@ void ap_sta_set_authorized(struct hostapd_data *hapd, struct sta_info *sta,
 	if (!!authorized == !!(sta->flags & WLAN_STA_AUTHORIZED))
 		return;
 
-	if (authorized)
+	if (authorized) {
 		sta->flags |= WLAN_STA_AUTHORIZED;
-	else
+		sta_conn_trace(sta, STA_CONN_TRACE_AUTHORIZED);
+	} else {
 		sta->flags &= ~WLAN_STA_AUTHORIZED;
+	}
 
 #ifdef CONFIG_P2P
 	if (hapd->p2p_group == NULL) {
@@ -14,6 +14,8 @@
 #include "vlan.h"
 #include "common/wpa_common.h"
 #include "common/ieee802_11_defs.h"
+#include "ap_config.h"
+#include "conn_trace.h"
 
 /* STA flags */
 #define WLAN_STA_AUTH BIT(0)
@@ -46,6 +48,7 @@
 #define WLAN_SUPP_RATES_MAX 32
 
 struct hostapd_data;
+struct hostap_sta_driver_data;
 
 struct mbo_non_pref_chan_info {
 	struct mbo_non_pref_chan_info *next;
@@ -61,12 +64,16 @@ struct pending_eapol_rx {
 	struct os_reltime rx_time;
 };
 
+/*
+ * Fields that are used when going through the station list and in the common
+ * frame RX/TX and timeout processing are kept in the beginning of the
+ * structure while larger and rarely used parts (e.g., mesh peering state) are
+ * at the end to keep the frequently accessed part within a few cache lines.
+ */
 struct sta_info {
 	struct sta_info *next; /* next entry in sta list */
 	struct sta_info *hnext; /* next entry in hash table list */
 	u8 addr[6];
-	be32 ipaddr;
-	struct dl_list ip6addr; /* list head for struct ip6addr */
 	u16 aid; /* STA's unique AID (1 .. 2007) or 0 if not yet assigned */
 	u16 disconnect_reason_code; /* RADIUS server override */
 	u32 flags; /* Bitfield of WLAN_STA_* */
@@ -76,29 +83,6 @@ struct sta_info {
 	int supported_rates_len;
 	u8 qosinfo; /* Valid when WLAN_STA_WMM is set */
 
-#ifdef CONFIG_MESH
-	enum mesh_plink_state plink_state;
-	u16 peer_lid;
-	u16 my_lid;
-	u16 peer_aid;
-	u16 mpm_close_reason;
-	int mpm_retries;
-	u8 my_nonce[WPA_NONCE_LEN];
-	u8 peer_nonce[WPA_NONCE_LEN];
-	u8 aek[32];	/* SHA256 digest length */
-	u8 mtk[WPA_TK_MAX_LEN];
-	size_t mtk_len;
-	u8 mgtk_rsc[6];
-	u8 mgtk_key_id;
-	u8 mgtk[WPA_TK_MAX_LEN];
-	size_t mgtk_len;
-	u8 igtk_rsc[6];
-	u8 igtk[WPA_TK_MAX_LEN];
-	size_t igtk_len;
-	u16 igtk_key_id;
-	u8 sae_auth_retry;
-#endif /* CONFIG_MESH */
-
 	unsigned int nonerp_set:1;
 	unsigned int no_short_slot_time_set:1;
 	unsigned int no_short_preamble_set:1;
@@ -148,6 +132,10 @@ struct sta_info {
 	u32 last_tx_bytes_hi;
 	u32 last_tx_bytes_lo;
 
+	/* Driver statistics from the last station dump (sta_stats_interval) */
+	struct hostap_sta_driver_data *drv_stats;
+	struct os_reltime drv_stats_time;
+
 	u8 *challenge; /* IEEE 802.11 Shared Key Authentication Challenge */
 
 	struct wpa_state_machine *wpa_sm;
@@ -159,6 +147,10 @@ struct sta_info {
 	 /* PSKs from RADIUS authentication server */
 	struct hostapd_sta_wpa_psk_short *psk;
 
+	be32 ipaddr;
+	struct sta_info *ip4_hnext; /* next entry in IPv4 address hash list */
+	struct dl_list ip6addr; /* list head for struct ip6addr */
+
 	char *identity; /* User-Name from RADIUS */
 	char *radius_cui; /* Chargeable-User-Identity from RADIUS */
 
@@ -269,6 +261,33 @@ struct sta_info {
 	struct dpp_pfs *dpp_pfs;
 #endif /* CONFIG_DPP2 */
 
+#ifdef CONFIG_STA_CONN_TRACE
+	struct sta_conn_trace conn_trace;
+#endif /* CONFIG_STA_CONN_TRACE */
+
+#ifdef CONFIG_MESH
+	enum mesh_plink_state plink_state;
+	u16 peer_lid;
+	u16 my_lid;
+	u16 peer_aid;
+	u16 mpm_close_reason;
+	int mpm_retries;
+	u8 my_nonce[WPA_NONCE_LEN];
+	u8 peer_nonce[WPA_NONCE_LEN];
+	u8 aek[32];	/* SHA256 digest length */
+	u8 mtk[WPA_TK_MAX_LEN];
+	size_t mtk_len;
+	u8 mgtk_rsc[6];
+	u8 mgtk_key_id;
+	u8 mgtk[WPA_TK_MAX_LEN];
+	size_t mgtk_len;
+	u8 igtk_rsc[6];
+	u8 igtk[WPA_TK_MAX_LEN];
+	size_t igtk_len;
+	u16 igtk_key_id;
+	u8 sae_auth_retry;
+#endif /* CONFIG_MESH */
+
 #ifdef CONFIG_TESTING_OPTIONS
 	enum wpa_alg last_tk_alg;
 	int last_tk_key_idx;
@@ -304,6 +323,8 @@ void ap_sta_hash_add(struct hostapd_data *hapd, struct sta_info *sta);
 void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta);
 void ap_sta_ip6addr_del(struct hostapd_data *hapd, struct sta_info *sta);
 void hostapd_free_stas(struct hostapd_data *hapd);
+size_t ap_sta_mem_usage(struct sta_info *sta);
+int ap_sta_slab_status(char *buf, size_t buflen);
 void ap_handle_timer(void *eloop_ctx, void *timeout_ctx);
 void ap_sta_replenish_timeout(struct hostapd_data *hapd, struct sta_info *sta,
 			      u32 session_timeout);
@@ -314,6 +335,10 @@ void ap_sta_no_session_timeout(struct hostapd_data *hapd,
 void ap_sta_session_warning_timeout(struct hostapd_data *hapd,
 				    struct sta_info *sta, int warning_time);
 struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr);
+
+int ap_sta_read_stats(struct hostapd_data *hapd, struct sta_info *sta,
+		      enum sta_stats_user user,
+		      struct hostap_sta_driver_data *data);
 void ap_sta_disassociate(struct hostapd_data *hapd, struct sta_info *sta,
 			 u16 reason);
 void ap_sta_deauthenticate(struct hostapd_data *hapd, struct sta_info *sta,
@@ -4250,6 +4250,24 @@ int wpa_auth_sta_wpa_version(struct wpa_state_machine *sm)
 }
 
 
+size_t wpa_auth_sta_mem_usage(struct wpa_state_machine *sm)
+{
+	size_t len;
+
+	if (!sm)
+		return 0;
+	len = sizeof(*sm) + sm->wpa_ie_len + sm->last_rx_eapol_key_len;
+#ifdef CONFIG_IEEE80211R_AP
+	if (sm->assoc_resp_ftie)
+		len += 2 + sm->assoc_resp_ftie[1];
+	if (sm->ft_pending_req_ies)
+		len += sizeof(struct wpabuf) +
+			wpabuf_size(sm->ft_pending_req_ies);
+#endif /* CONFIG_IEEE80211R_AP */
+	return len;
+}
+
+
 int wpa_auth_sta_ft_tk_already_set(struct wpa_state_machine *sm)
 {
 	if (!sm || !wpa_key_mgmt_ft(sm->wpa_key_mgmt))
@@ -395,6 +395,14 @@ static int hostapd_wpa_auth_set_key(void *ctx, int vlan_id, enum wpa_alg alg,
 		hapd->last_gtk_len = key_len;
 	}
 #endif /* CONFIG_TESTING_OPTIONS */
+#ifdef CONFIG_STA_CONN_TRACE
+	if (alg != WPA_ALG_NONE && addr && !is_broadcast_ether_addr(addr)) {
+		struct sta_info *sta = ap_get_sta(hapd, addr);
+
+		if (sta)
+			sta_conn_trace(sta, STA_CONN_TRACE_PTK_SET);
+	}
+#endif /* CONFIG_STA_CONN_TRACE */
 	return hostapd_drv_set_key(ifname, hapd, alg, addr, idx, 1, NULL, 0,
 				   key, key_len);
 }
@@ -432,8 +440,10 @@ static int hostapd_wpa_auth_send_eapol(void *ctx, const u8 *addr,
 #endif /* CONFIG_TESTING_OPTIONS */
 
 	sta = ap_get_sta(hapd, addr);
-	if (sta)
+	if (sta) {
 		flags = hostapd_sta_flags_to_drv(sta->flags);
+		sta_conn_trace_eapol_key(sta, data, data_len, 1);
+	}
 
 	return hostapd_drv_hapd_send_eapol(hapd, addr, data, data_len,
 					   encrypt, flags);
@@ -123,6 +123,68 @@ void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
 }
 
 
+/**
+ * x_snoop_mcast_to_ucast_convert_send_all - Convert and send to all stations
+ * @hapd: Pointer to BSS data
+ * @buf: Multicast frame including the Ethernet header
+ * @len: Length of the frame
+ *
+ * A unicast copy of the frame is sent to each authorized station. The copies
+ * are sent as a batch with the destination address taken from a per-station
+ * buffer, so the frame itself is not modified. If the l2_packet implementation
+ * does not support batched transmission, the copies are sent one at a time
+ * with x_snoop_mcast_to_ucast_convert_send().
+ */
+void x_snoop_mcast_to_ucast_convert_send_all(struct hostapd_data *hapd,
+					     u8 *buf, size_t len)
+{
+	struct sta_info *sta;
+	u8 *addrs = NULL;
+	size_t num = 0;
+	int res = -1;
+
+	if (len < ETH_HLEN || !(buf[0] & 0x01) || hapd->num_sta == 0)
+		return;
+
+	addrs = os_malloc(hapd->num_sta * ETH_ALEN);
+	if (addrs) {
+		for (sta = hapd->sta_list; sta && num < (size_t) hapd->num_sta;
+		     sta = sta->next) {
+			if (!(sta->flags & WLAN_STA_AUTHORIZED))
+				continue;
+			os_memcpy(&addrs[num * ETH_ALEN], sta->addr, ETH_ALEN);
+			num++;
+		}
+		if (num == 0) {
+			os_free(addrs);
+			return;
+		}
+		res = l2_packet_send_multi(hapd->sock_dhcp, addrs, num, buf,
+					   len);
+		os_free(addrs);
+	}
+
+	if (res >= 0) {
+		wpa_printf(MSG_EXCESSIVE,
+			   "x_snoop: Multicast-to-unicast conversion " MACSTR
+			   " -> %u/%u stations (len %u)",
+			   MAC2STR(buf), res, (unsigned int) num,
+			   (unsigned int) len);
+		if ((size_t) res < num)
+			wpa_printf(MSG_DEBUG,
+				   "x_snoop: Failed to send mcast to ucast converted packet to %u stations",
+				   (unsigned int) (num - res));
+		return;
+	}
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (!(sta->flags & WLAN_STA_AUTHORIZED))
+			continue;
+		x_snoop_mcast_to_ucast_convert_send(hapd, sta, buf, len);
+	}
+}
+
+
 void x_snoop_deinit(struct hostapd_data *hapd)
 {
 	hostapd_drv_br_set_net_param(hapd, DRV_BR_NET_PARAM_GARP_ACCEPT, 0);
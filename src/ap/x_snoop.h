@@ -11,6 +11,9 @@
 
 #include "l2_packet/l2_packet.h"
 
+/* Number of hash buckets for the snooped station IP addresses */
+#define X_SNOOP_HASH_SIZE 256
+
 #ifdef CONFIG_PROXYARP
 
 int x_snoop_init(struct hostapd_data *hapd);
@@ -22,6 +25,8 @@ x_snoop_get_l2_packet(struct hostapd_data *hapd,
 void x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
 					 struct sta_info *sta, u8 *buf,
 					 size_t len);
+void x_snoop_mcast_to_ucast_convert_send_all(struct hostapd_data *hapd,
+					     u8 *buf, size_t len);
 void x_snoop_deinit(struct hostapd_data *hapd);
 
 #else /* CONFIG_PROXYARP */
@@ -47,6 +52,12 @@ x_snoop_mcast_to_ucast_convert_send(struct hostapd_data *hapd,
 {
 }
 
+static inline void
+x_snoop_mcast_to_ucast_convert_send_all(struct hostapd_data *hapd, void *buf,
+					size_t len)
+{
+}
+
 static inline void x_snoop_deinit(struct hostapd_data *hapd)
 {
 }
@@ -316,6 +316,7 @@ extern "C" {
 #define ACS_EVENT_STARTED "ACS-STARTED "
 #define ACS_EVENT_COMPLETED "ACS-COMPLETED "
 #define ACS_EVENT_FAILED "ACS-FAILED "
+#define ACS_EVENT_CHANNEL_RECOMMENDED "ACS-CHANNEL-RECOMMENDED "
 
 #define DFS_EVENT_RADAR_DETECTED "DFS-RADAR-DETECTED "
 #define DFS_EVENT_NEW_CHANNEL "DFS-NEW-CHANNEL "
@@ -101,6 +101,47 @@ enum reg_type {
 	REGDOM_TYPE_INTERSECTION,
 };
 
+#ifdef CONFIG_ACS
+/**
+ * struct acs_chan_stats - Running ACS survey statistics for a channel
+ *
+ * These are maintained in src/ap/acs.c as survey data is received so that the
+ * interference factor can be determined without going through all the
+ * collected surveys.
+ */
+struct acs_chan_stats {
+	/**
+	 * num_surveys - Number of surveys received for the channel
+	 */
+	unsigned int num_surveys;
+
+	/**
+	 * weight - Total weight of the sufficient surveys
+	 */
+	long double weight;
+
+	/**
+	 * nf_sum - Weighted sum of 10^(nf/5)
+	 */
+	long double nf_sum;
+
+	/**
+	 * busy_sum - Weighted sum of the busy time ratio
+	 */
+	long double busy_sum;
+
+	/**
+	 * busy_nf_sum - Weighted sum of busy time ratio * 2^(10^(nf/10))
+	 */
+	long double busy_nf_sum;
+
+	/**
+	 * channel_time - Channel time of the last included survey
+	 */
+	u64 channel_time;
+};
+#endif /* CONFIG_ACS */
+
 /**
  * struct hostapd_channel_data - Channel information
  */
@@ -150,6 +191,12 @@ struct hostapd_channel_data {
 	 * need to set this)
 	 */
 	long double interference_factor;
+
+	/**
+	 * acs_stats - Running survey statistics (used internally in
+	 * src/ap/acs.c; driver wrappers do not need to set this)
+	 */
+	struct acs_chan_stats acs_stats;
 #endif /* CONFIG_ACS */
 
 	/**
@@ -331,11 +378,22 @@ struct wpa_scan_res {
  * @res: Array of pointers to allocated variable length scan result entries
  * @num: Number of entries in the scan result array
  * @fetch_time: Time when the results were fetched from the driver
+ * @size: Number of allocated entries in the res array (only maintained by
+ *	wpa_scan_results_add())
+ * @arena: Memory blocks for the entries allocated with wpa_scan_results_add();
+ *	these entries are freed together with the results and must not be freed
+ *	individually
+ * @generation: Generation counter of the driver BSS table the results were
+ *	read from or 0 if not available; the counter changes whenever any entry
+ *	in the driver table is added, updated, or removed
  */
 struct wpa_scan_results {
 	struct wpa_scan_res **res;
 	size_t num;
 	struct os_reltime fetch_time;
+	size_t size;
+	struct wpa_scan_res_arena *arena;
+	unsigned int generation;
 };
 
 /**
@@ -2778,6 +2836,22 @@ struct wpa_driver_ops {
 	int (*read_sta_data)(void *priv, struct hostap_sta_driver_data *data,
 			     const u8 *addr);
 
+	/**
+	 * read_all_sta_data - Fetch station data for all stations
+	 * @priv: Private driver interface data
+	 * @cb: Callback function to call for each station
+	 * @ctx: Context data for the callback function
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * This is an optional, more efficient alternative for calling
+	 * read_sta_data() separately for each station. inactive_msec is set to
+	 * (unsigned long) -1 for stations that do not report inactivity.
+	 */
+	int (*read_all_sta_data)(void *priv,
+				 void (*cb)(void *ctx, const u8 *addr,
+					    struct hostap_sta_driver_data *data),
+				 void *ctx);
+
 	/**
 	 * hapd_send_eapol - Send an EAPOL packet (AP only)
 	 * @priv: private driver interface data
@@ -5602,6 +5676,8 @@ static inline void drv_event_eapol_rx(void *ctx, const u8 *src, const u8 *data,
 
 /* driver_common.c */
 void wpa_scan_results_free(struct wpa_scan_results *res);
+struct wpa_scan_res * wpa_scan_results_add(struct wpa_scan_results *res,
+					   size_t ie_len);
 
 /* Convert wpa_event_type to a string for logging */
 const char * event_to_string(enum wpa_event_type event);
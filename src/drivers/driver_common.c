@@ -10,20 +10,94 @@
 #include "utils/common.h"
 #include "driver.h"
 
+/* Scan result entries are allocated from blocks of this size to avoid a
+ * separate allocation for each BSS in a large scan result dump. */
+#define WPA_SCAN_RES_ARENA_BLOCK 16384
+
+struct wpa_scan_res_arena {
+	struct wpa_scan_res_arena *next;
+	size_t used;
+	size_t size;
+	/* followed by size octets of entry data */
+};
+
+
 void wpa_scan_results_free(struct wpa_scan_results *res)
 {
 	size_t i;
+	struct wpa_scan_res_arena *arena, *prev;
 
 	if (res == NULL)
 		return;
 
-	for (i = 0; i < res->num; i++)
-		os_free(res->res[i]);
+	if (!res->arena) {
+		for (i = 0; i < res->num; i++)
+			os_free(res->res[i]);
+	}
+	arena = res->arena;
+	while (arena) {
+		prev = arena;
+		arena = arena->next;
+		os_free(prev);
+	}
 	os_free(res->res);
 	os_free(res);
 }
 
 
+/**
+ * wpa_scan_results_add - Allocate and add a new scan result entry
+ * @res: Scan results
+ * @ie_len: Number of octets to allocate for IEs after the entry
+ * Returns: Pointer to the zeroed entry or %NULL on allocation failure
+ *
+ * The entry is allocated from a memory arena that is owned by @res and the
+ * array of entries is grown geometrically, so adding N entries does not
+ * require N reallocations and N separate allocations. All entries of @res have
+ * to be added with this function if it is used at all.
+ */
+struct wpa_scan_res * wpa_scan_results_add(struct wpa_scan_results *res,
+					   size_t ie_len)
+{
+	struct wpa_scan_res_arena *arena = res->arena;
+	struct wpa_scan_res *r;
+	size_t len, hdr_len;
+
+	if (res->num == res->size) {
+		struct wpa_scan_res **tmp;
+		size_t size = res->size ? res->size * 2 : 32;
+
+		tmp = os_realloc_array(res->res, size, sizeof(*tmp));
+		if (!tmp)
+			return NULL;
+		res->res = tmp;
+		res->size = size;
+	}
+
+	/* Keep all entries aligned for the u64 members */
+	hdr_len = (sizeof(*arena) + 7) & ~(size_t) 7;
+	len = (sizeof(*r) + ie_len + 7) & ~(size_t) 7;
+	if (!arena || arena->size - arena->used < len) {
+		size_t size = len > WPA_SCAN_RES_ARENA_BLOCK ?
+			len : WPA_SCAN_RES_ARENA_BLOCK;
+
+		arena = os_malloc(hdr_len + size);
+		if (!arena)
+			return NULL;
+		arena->next = res->arena;
+		arena->used = 0;
+		arena->size = size;
+		res->arena = arena;
+	}
+
+	r = (struct wpa_scan_res *) ((u8 *) arena + hdr_len + arena->used);
+	arena->used += len;
+	os_memset(r, 0, sizeof(*r) + ie_len);
+	res->res[res->num++] = r;
+	return r;
+}
+
+
 const char * event_to_string(enum wpa_event_type event)
 {
 #define E2S(n) case EVENT_ ## n: return #n
@@ -308,6 +308,7 @@ void nl80211_mark_disconnected(struct wpa_driver_nl80211_data *drv)
 	drv->associated = 0;
 	os_memset(drv->bssid, 0, ETH_ALEN);
 	drv->first_bss->freq = 0;
+	drv->assoc_bss.valid = 0;
 }
 
 
@@ -456,6 +457,311 @@ int send_and_recv_msgs(struct wpa_driver_nl80211_data *drv,
 }
 
 
+/*
+ * Asynchronous requests
+ *
+ * nl80211 commands are processed by the kernel in the context of the
+ * sendmsg() call, so the only thing send_and_recv_msgs() waits for is the
+ * response. Commands whose result is not needed immediately can be sent on a
+ * separate socket without waiting; the responses are matched to the pending
+ * requests by netlink sequence number when the socket becomes readable in the
+ * event loop and the completion callback is then called with the result.
+ * Since the command itself has already been executed when the send call
+ * returns, the ordering with respect to commands sent later with
+ * send_and_recv_msgs() is maintained.
+ *
+ * This does not hold for dumps: the kernel generates the dump parts only when
+ * they are read with recvmsg() and a netlink socket can have only a single dump
+ * in progress at a time. Dumps are therefore not accepted here.
+ */
+
+#define NL80211_ASYNC_MAX_REQS 64
+
+struct nl80211_async_req {
+	struct dl_list list;
+	u32 seq;
+	struct wpa_driver_nl80211_data *drv;
+	int (*valid_handler)(struct nl_msg *msg, void *arg);
+	void *valid_data;
+	void (*done)(struct wpa_driver_nl80211_data *drv, int err, void *ctx);
+	void *ctx;
+};
+
+
+static struct nl80211_async_req *
+nl80211_async_get(struct nl80211_global *global, u32 seq)
+{
+	struct nl80211_async_req *req;
+
+	dl_list_for_each(req, &global->async_reqs, struct nl80211_async_req,
+			 list) {
+		if (req->seq == seq)
+			return req;
+	}
+
+	return NULL;
+}
+
+
+static void nl80211_async_done(struct nl80211_global *global,
+			       struct nl80211_async_req *req, int err)
+{
+	dl_list_del(&req->list);
+	global->num_async_reqs--;
+	if (err)
+		wpa_printf(MSG_DEBUG,
+			   "nl80211: Asynchronous request (seq=%u) failed: %d (%s)",
+			   req->seq, err, strerror(-err));
+	if (req->done)
+		req->done(req->drv, err, req->ctx);
+	os_free(req);
+}
+
+
+static void nl80211_async_fail_all(struct nl80211_global *global, int err)
+{
+	struct nl80211_async_req *req;
+
+	while ((req = dl_list_first(&global->async_reqs,
+				    struct nl80211_async_req, list)))
+		nl80211_async_done(global, req, err);
+}
+
+
+static int nl80211_async_valid(struct nl_msg *msg, void *arg)
+{
+	struct nl80211_global *global = arg;
+	struct nl80211_async_req *req;
+
+	req = nl80211_async_get(global, nlmsg_hdr(msg)->nlmsg_seq);
+	if (!req || !req->valid_handler)
+		return NL_SKIP;
+	return req->valid_handler(msg, req->valid_data);
+}
+
+
+static int nl80211_async_ack(struct nl_msg *msg, void *arg)
+{
+	struct nl80211_global *global = arg;
+	struct nl80211_async_req *req;
+
+	req = nl80211_async_get(global, nlmsg_hdr(msg)->nlmsg_seq);
+	if (req)
+		nl80211_async_done(global, req, 0);
+
+	/* There may be responses to other requests in the same buffer */
+	return NL_SKIP;
+}
+
+
+static int nl80211_async_error(struct sockaddr_nl *nla, struct nlmsgerr *err,
+			       void *arg)
+{
+	struct nl80211_global *global = arg;
+	struct nl80211_async_req *req;
+	int ret;
+
+	error_handler(nla, err, &ret);
+	req = nl80211_async_get(global, err->msg.nlmsg_seq);
+	if (req)
+		nl80211_async_done(global, req, ret);
+
+	return NL_SKIP;
+}
+
+
+static void nl80211_async_receive(int sock, void *eloop_ctx, void *handle)
+{
+	struct nl80211_global *global = eloop_ctx;
+	int res;
+
+	res = nl_recvmsgs(handle, global->nl_async_cb);
+	if (res == -NLE_AGAIN)
+		return; /* nothing pending on the nonblocking socket */
+	if (res < 0) {
+		wpa_printf(MSG_INFO, "nl80211: %s->nl_recvmsgs failed: %d",
+			   __func__, res);
+		if (res == -NLE_NOMEM) {
+			/* Responses may have been lost due to the socket
+			 * receive buffer overflowing, so do not leave the
+			 * requests pending forever. */
+			nl80211_async_fail_all(global, -ENOBUFS);
+		}
+	}
+}
+
+
+static int nl80211_async_init(struct nl80211_global *global)
+{
+	int opt;
+
+	if (global->nl_async)
+		return 0;
+
+	global->nl_async_cb = nl_cb_alloc(NL_CB_DEFAULT);
+	if (!global->nl_async_cb)
+		return -1;
+	nl_cb_set(global->nl_async_cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM,
+		  no_seq_check, NULL);
+	nl_cb_set(global->nl_async_cb, NL_CB_VALID, NL_CB_CUSTOM,
+		  nl80211_async_valid, global);
+	nl_cb_set(global->nl_async_cb, NL_CB_ACK, NL_CB_CUSTOM,
+		  nl80211_async_ack, global);
+	nl_cb_err(global->nl_async_cb, NL_CB_CUSTOM, nl80211_async_error,
+		  global);
+
+	global->nl_async = nl_create_handle(global->nl_async_cb, "async");
+	if (!global->nl_async) {
+		nl_cb_put(global->nl_async_cb);
+		global->nl_async_cb = NULL;
+		return -1;
+	}
+
+	/* try to set NETLINK_EXT_ACK and NETLINK_CAP_ACK, ignoring errors */
+	opt = 1;
+	setsockopt(nl_socket_get_fd(global->nl_async), SOL_NETLINK,
+		   NETLINK_EXT_ACK, &opt, sizeof(opt));
+	opt = 1;
+	setsockopt(nl_socket_get_fd(global->nl_async), SOL_NETLINK,
+		   NETLINK_CAP_ACK, &opt, sizeof(opt));
+
+	nl80211_register_eloop_read(&global->nl_async, nl80211_async_receive,
+				    global, 1);
+
+	return 0;
+}
+
+
+static void nl80211_async_deinit(struct nl80211_global *global)
+{
+	if (!global->nl_async)
+		return;
+	nl80211_async_fail_all(global, -ECANCELED);
+	nl80211_destroy_eloop_handle(&global->nl_async, 1);
+	nl_cb_put(global->nl_async_cb);
+	global->nl_async_cb = NULL;
+}
+
+
+/* Process the responses that have already been received without blocking and
+ * check whether the maximum number of pending requests is still reached */
+static int nl80211_async_full(struct nl80211_global *global)
+{
+	unsigned int pending;
+
+	while (global->num_async_reqs >= NL80211_ASYNC_MAX_REQS) {
+		pending = global->num_async_reqs;
+		nl80211_async_receive(nl_socket_get_fd(global->nl_async),
+				      global, global->nl_async);
+		if (global->num_async_reqs == pending)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/**
+ * send_and_recv_msgs_async - Send a command without waiting for the response
+ * @drv: Driver interface data
+ * @msg: Message to send; freed by this function
+ * @valid_handler: Handler for response messages or %NULL
+ * @valid_data: Context data for valid_handler
+ * @done: Completion callback or %NULL
+ * @ctx: Context data for done; also used with nl80211_async_cancel()
+ * Returns: 0 if the command was sent, negative errno on failure
+ *
+ * The done callback is called from the event loop with 0 or negative errno
+ * once the kernel has acknowledged the command. Data referenced by valid_data
+ * and ctx needs to remain valid until then or until the request is cancelled
+ * with nl80211_async_cancel(). If the asynchronous socket is not available or
+ * too many requests are already waiting for a response, the command is sent
+ * with send_and_recv_msgs() and done is called before this function returns.
+ * Dump requests (NLM_F_DUMP) are rejected with -EINVAL; use
+ * send_and_recv_msgs() for them.
+ */
+int send_and_recv_msgs_async(struct wpa_driver_nl80211_data *drv,
+			     struct nl_msg *msg,
+			     int (*valid_handler)(struct nl_msg *, void *),
+			     void *valid_data,
+			     void (*done)(struct wpa_driver_nl80211_data *drv,
+					  int err, void *ctx),
+			     void *ctx)
+{
+	struct nl80211_global *global = drv->global;
+	struct nl80211_async_req *req;
+	int ret;
+
+	if (!msg)
+		return -ENOMEM;
+
+	if (nlmsg_hdr(msg)->nlmsg_flags & NLM_F_DUMP) {
+		wpa_printf(MSG_ERROR,
+			   "nl80211: Dump requests cannot be sent asynchronously");
+		nlmsg_free(msg);
+		return -EINVAL;
+	}
+
+	req = os_zalloc(sizeof(*req));
+	if (!req || nl80211_async_init(global) < 0 ||
+	    nl80211_async_full(global)) {
+		os_free(req);
+		ret = send_and_recv_msgs(drv, msg, valid_handler, valid_data);
+		if (done)
+			done(drv, ret, ctx);
+		return 0;
+	}
+
+	ret = nl_send_auto_complete(global->nl_async, msg);
+	if (!valid_handler && valid_data == (void *) -1)
+		nl80211_nlmsg_clear(msg);
+	if (ret < 0) {
+		wpa_printf(MSG_INFO,
+			   "nl80211: Failed to send asynchronous request: %d",
+			   ret);
+		nlmsg_free(msg);
+		os_free(req);
+		return -ENOBUFS;
+	}
+
+	req->seq = nlmsg_hdr(msg)->nlmsg_seq;
+	req->drv = drv;
+	req->valid_handler = valid_handler;
+	req->valid_data = valid_data;
+	req->done = done;
+	req->ctx = ctx;
+	dl_list_add_tail(&global->async_reqs, &req->list);
+	global->num_async_reqs++;
+	nlmsg_free(msg);
+
+	return 0;
+}
+
+
+/**
+ * nl80211_async_cancel - Drop pending asynchronous requests
+ * @drv: Driver interface data
+ * @ctx: Context data of the requests to drop or %NULL for all requests of drv
+ *
+ * The completion callbacks of the dropped requests are not called and late
+ * responses to them are ignored.
+ */
+void nl80211_async_cancel(struct wpa_driver_nl80211_data *drv, void *ctx)
+{
+	struct nl80211_global *global = drv->global;
+	struct nl80211_async_req *req, *tmp;
+
+	dl_list_for_each_safe(req, tmp, &global->async_reqs,
+			      struct nl80211_async_req, list) {
+		if (req->drv != drv || (ctx && req->ctx != ctx))
+			continue;
+		dl_list_del(&req->list);
+		global->num_async_reqs--;
+		os_free(req);
+	}
+}
+
+
 struct family_data {
 	const char *group;
 	int id;
@@ -1364,49 +1670,103 @@ static int nl80211_get_assoc_freq_handler(struct nl_msg *msg, void *arg)
 }
 
 
-int nl80211_get_assoc_ssid(struct wpa_driver_nl80211_data *drv, u8 *ssid)
+static int nl80211_get_assoc_iface_handler(struct nl_msg *msg, void *arg)
+{
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct nl80211_get_assoc_freq_arg *ctx = arg;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+
+	if (tb[NL80211_ATTR_WIPHY_FREQ]) {
+		ctx->assoc_freq = nla_get_u32(tb[NL80211_ATTR_WIPHY_FREQ]);
+		ctx->ibss_freq = ctx->assoc_freq;
+	}
+	if (tb[NL80211_ATTR_SSID] && nla_len(tb[NL80211_ATTR_SSID]) > 0 &&
+	    nla_len(tb[NL80211_ATTR_SSID]) <= SSID_MAX_LEN) {
+		ctx->assoc_ssid_len = nla_len(tb[NL80211_ATTR_SSID]);
+		os_memcpy(ctx->assoc_ssid, nla_data(tb[NL80211_ATTR_SSID]),
+			  ctx->assoc_ssid_len);
+	}
+
+	return NL_SKIP;
+}
+
+
+/*
+ * Fetch the operating frequency and SSID of the current association. The
+ * interface information is used when it includes the needed values to avoid
+ * dumping and parsing the full scan table; otherwise, the associated BSS is
+ * searched from the scan results. The values are cached for station mode
+ * associations until the next association change.
+ */
+static int nl80211_get_assoc_bss(struct wpa_driver_nl80211_data *drv,
+				 int need_ssid)
 {
 	struct nl_msg *msg;
 	int ret;
 	struct nl80211_get_assoc_freq_arg arg;
+	int sta = is_sta_interface(drv->nlmode) && drv->associated;
+
+	if (sta && drv->assoc_bss.valid)
+		return 0;
 
-	msg = nl80211_drv_msg(drv, NLM_F_DUMP, NL80211_CMD_GET_SCAN);
 	os_memset(&arg, 0, sizeof(arg));
 	arg.drv = drv;
-	ret = send_and_recv_msgs(drv, msg, nl80211_get_assoc_freq_handler,
-				 &arg);
-	if (ret == 0) {
-		os_memcpy(ssid, arg.assoc_ssid, arg.assoc_ssid_len);
-		return arg.assoc_ssid_len;
+	msg = nl80211_drv_msg(drv, 0, NL80211_CMD_GET_INTERFACE);
+	if (send_and_recv_msgs(drv, msg, nl80211_get_assoc_iface_handler,
+			       &arg) == 0 &&
+	    arg.assoc_freq && (arg.assoc_ssid_len || !need_ssid)) {
+		wpa_printf(MSG_DEBUG,
+			   "nl80211: Operating on %u MHz (interface info)",
+			   arg.assoc_freq);
+	} else {
+		os_memset(&arg, 0, sizeof(arg));
+		arg.drv = drv;
+		msg = nl80211_drv_msg(drv, NLM_F_DUMP, NL80211_CMD_GET_SCAN);
+		ret = send_and_recv_msgs(drv, msg,
+					 nl80211_get_assoc_freq_handler, &arg);
+		if (ret) {
+			wpa_printf(MSG_DEBUG,
+				   "nl80211: Scan result fetch failed: ret=%d (%s)",
+				   ret, strerror(-ret));
+			return ret;
+		}
 	}
-	wpa_printf(MSG_DEBUG, "nl80211: Scan result fetch failed: ret=%d (%s)",
-		   ret, strerror(-ret));
-	return ret;
+
+	drv->assoc_bss.freq = drv->nlmode == NL80211_IFTYPE_ADHOC ?
+		arg.ibss_freq : arg.assoc_freq;
+	os_memcpy(drv->assoc_bss.ssid, arg.assoc_ssid, arg.assoc_ssid_len);
+	drv->assoc_bss.ssid_len = arg.assoc_ssid_len;
+	drv->assoc_bss.valid = sta && drv->assoc_bss.freq &&
+		drv->assoc_bss.ssid_len;
+	return 0;
 }
 
 
-unsigned int nl80211_get_assoc_freq(struct wpa_driver_nl80211_data *drv)
+int nl80211_get_assoc_ssid(struct wpa_driver_nl80211_data *drv, u8 *ssid)
 {
-	struct nl_msg *msg;
 	int ret;
-	struct nl80211_get_assoc_freq_arg arg;
 
-	msg = nl80211_drv_msg(drv, NLM_F_DUMP, NL80211_CMD_GET_SCAN);
-	os_memset(&arg, 0, sizeof(arg));
-	arg.drv = drv;
-	ret = send_and_recv_msgs(drv, msg, nl80211_get_assoc_freq_handler,
-				 &arg);
-	if (ret == 0) {
-		unsigned int freq = drv->nlmode == NL80211_IFTYPE_ADHOC ?
-			arg.ibss_freq : arg.assoc_freq;
+	ret = nl80211_get_assoc_bss(drv, 1);
+	if (ret)
+		return ret;
+	os_memcpy(ssid, drv->assoc_bss.ssid, drv->assoc_bss.ssid_len);
+	return drv->assoc_bss.ssid_len;
+}
+
+
+unsigned int nl80211_get_assoc_freq(struct wpa_driver_nl80211_data *drv)
+{
+	if (nl80211_get_assoc_bss(drv, 0) == 0) {
+		unsigned int freq = drv->assoc_bss.freq;
+
 		wpa_printf(MSG_DEBUG, "nl80211: Operating frequency for the "
-			   "associated BSS from scan results: %u MHz", freq);
+			   "associated BSS: %u MHz", freq);
 		if (freq)
 			drv->assoc_freq = freq;
-		return drv->assoc_freq;
 	}
-	wpa_printf(MSG_DEBUG, "nl80211: Scan result fetch failed: ret=%d "
-		   "(%s)", ret, strerror(-ret));
 	return drv->assoc_freq;
 }
 
@@ -1927,6 +2287,7 @@ static int nl80211_init_bss(struct i802_bss *bss)
 
 static void nl80211_destroy_bss(struct i802_bss *bss)
 {
+	nl80211_async_cancel(bss->drv, bss);
 	nl_cb_put(bss->nl_cb);
 	bss->nl_cb = NULL;
 }
@@ -2761,6 +3122,8 @@ static void wpa_driver_nl80211_deinit(struct i802_bss *bss)
 				   bss->ifname, bss->brname, strerror(errno));
 	}
 
+	nl80211_async_cancel(drv, NULL);
+
 	if (drv->rtnl_sk)
 		nl80211_handle_destroy(drv->rtnl_sk);
 
@@ -3777,6 +4140,18 @@ static int nl80211_put_basic_rates(struct nl_msg *msg, const int *basic_rates)
 }
 
 
+static void nl80211_set_bss_done(struct wpa_driver_nl80211_data *drv,
+				 int err, void *ctx)
+{
+	struct i802_bss *bss = ctx;
+
+	if (err)
+		wpa_printf(MSG_INFO,
+			   "nl80211: Failed to set BSS parameters on interface %s: %d (%s)",
+			   bss->ifname, err, strerror(-err));
+}
+
+
 static int nl80211_set_bss(struct i802_bss *bss, int cts, int preamble,
 			   int slot, int ht_opmode, int ap_isolate,
 			   const int *basic_rates)
@@ -3800,7 +4175,9 @@ static int nl80211_set_bss(struct i802_bss *bss, int cts, int preamble,
 		return -ENOBUFS;
 	}
 
-	return send_and_recv_msgs(drv, msg, NULL, NULL);
+	/* The result is not needed before returning from set_ap() */
+	return send_and_recv_msgs_async(drv, msg, NULL, NULL,
+					nl80211_set_bss_done, bss);
 }
 
 
@@ -4003,25 +4380,11 @@ static int nl80211_put_beacon_rate(struct nl_msg *msg, const u64 flags,
 }
 
 
-static int nl80211_set_multicast_to_unicast(struct i802_bss *bss,
-					    int multicast_to_unicast)
+static void nl80211_multicast_to_unicast_done(
+	struct wpa_driver_nl80211_data *drv, int ret, void *ctx)
 {
-	struct wpa_driver_nl80211_data *drv = bss->drv;
-	struct nl_msg *msg;
-	int ret;
-
-	msg = nl80211_bss_msg(bss, 0, NL80211_CMD_SET_MULTICAST_TO_UNICAST);
-	if (!msg ||
-	    (multicast_to_unicast &&
-	     nla_put_flag(msg, NL80211_ATTR_MULTICAST_TO_UNICAST_ENABLED))) {
-		wpa_printf(MSG_ERROR,
-			   "nl80211: Failed to build NL80211_CMD_SET_MULTICAST_TO_UNICAST msg for %s",
-			   bss->ifname);
-		nlmsg_free(msg);
-		return -ENOBUFS;
-	}
-
-	ret = send_and_recv_msgs(drv, msg, NULL, NULL);
+	struct i802_bss *bss = ctx;
+	int multicast_to_unicast = bss->multicast_to_unicast;
 
 	switch (ret) {
 	case 0:
@@ -4044,8 +4407,29 @@ static int nl80211_set_multicast_to_unicast(struct i802_bss *bss,
 			   ret, strerror(-ret), bss->ifname);
 		break;
 	}
+}
 
-	return ret;
+
+static int nl80211_set_multicast_to_unicast(struct i802_bss *bss,
+					    int multicast_to_unicast)
+{
+	struct wpa_driver_nl80211_data *drv = bss->drv;
+	struct nl_msg *msg;
+
+	msg = nl80211_bss_msg(bss, 0, NL80211_CMD_SET_MULTICAST_TO_UNICAST);
+	if (!msg ||
+	    (multicast_to_unicast &&
+	     nla_put_flag(msg, NL80211_ATTR_MULTICAST_TO_UNICAST_ENABLED))) {
+		wpa_printf(MSG_ERROR,
+			   "nl80211: Failed to build NL80211_CMD_SET_MULTICAST_TO_UNICAST msg for %s",
+			   bss->ifname);
+		nlmsg_free(msg);
+		return -ENOBUFS;
+	}
+
+	bss->multicast_to_unicast = !!multicast_to_unicast;
+	return send_and_recv_msgs_async(drv, msg, NULL, NULL,
+					nl80211_multicast_to_unicast_done, bss);
 }
 
 
@@ -6427,6 +6811,58 @@ static int i802_read_sta_data(struct i802_bss *bss,
 }
 
 
+struct nl80211_sta_dump_arg {
+	void (*cb)(void *ctx, const u8 *addr,
+		   struct hostap_sta_driver_data *data);
+	void *ctx;
+};
+
+static int get_sta_dump_handler(struct nl_msg *msg, void *arg)
+{
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
+	struct nl80211_sta_dump_arg *ctx = arg;
+	struct hostap_sta_driver_data data;
+
+	nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0),
+		  genlmsg_attrlen(gnlh, 0), NULL);
+	if (!tb[NL80211_ATTR_MAC] || !tb[NL80211_ATTR_STA_INFO])
+		return NL_SKIP;
+
+	os_memset(&data, 0, sizeof(data));
+	data.inactive_msec = (unsigned long) -1;
+	get_sta_handler(msg, &data);
+	ctx->cb(ctx->ctx, nla_data(tb[NL80211_ATTR_MAC]), &data);
+
+	return NL_SKIP;
+}
+
+
+static int i802_read_all_sta_data(void *priv,
+				  void (*cb)(void *ctx, const u8 *addr,
+					     struct hostap_sta_driver_data *data),
+				  void *ctx)
+{
+	struct i802_bss *bss = priv;
+	struct nl80211_sta_dump_arg arg;
+	struct nl_msg *msg;
+
+	arg.cb = cb;
+	arg.ctx = ctx;
+	msg = nl80211_bss_msg(bss, NLM_F_DUMP, NL80211_CMD_GET_STATION);
+	return send_and_recv_msgs(bss->drv, msg, get_sta_dump_handler, &arg);
+}
+
+
+static void i802_set_tx_queue_params_done(struct wpa_driver_nl80211_data *drv,
+					  int err, void *ctx)
+{
+	wpa_printf(err ? MSG_INFO : MSG_DEBUG,
+		   "nl80211: TX queue param set --> res=%d (%s)",
+		   err, err ? strerror(-err) : "Success");
+}
+
+
 static int i802_set_tx_queue_params(void *priv, int queue, int aifs,
 				    int cw_min, int cw_max, int burst_time)
 {
@@ -6480,10 +6916,14 @@ static int i802_set_tx_queue_params(void *priv, int queue, int aifs,
 
 	nla_nest_end(msg, txq);
 
-	res = send_and_recv_msgs(drv, msg, NULL, NULL);
+	/* The parameters for all queues are set during interface setup
+	 * without the results being needed, so do not wait for each response
+	 * separately; the result is logged when the response is received. */
 	wpa_printf(MSG_DEBUG,
-		   "nl80211: TX queue param set: queue=%d aifs=%d cw_min=%d cw_max=%d burst_time=%d --> res=%d",
-		   queue, aifs, cw_min, cw_max, burst_time, res);
+		   "nl80211: TX queue param set: queue=%d aifs=%d cw_min=%d cw_max=%d burst_time=%d",
+		   queue, aifs, cw_min, cw_max, burst_time);
+	res = send_and_recv_msgs_async(drv, msg, NULL, NULL,
+				       i802_set_tx_queue_params_done, bss);
 	if (res == 0)
 		return 0;
 	msg = NULL;
@@ -7870,6 +8310,7 @@ static void * nl80211_global_init(void *ctx)
 	global->ctx = ctx;
 	global->ioctl_sock = -1;
 	dl_list_init(&global->interfaces);
+	dl_list_init(&global->async_reqs);
 	global->if_add_ifindex = -1;
 
 	cfg = os_zalloc(sizeof(*cfg));
@@ -7922,6 +8363,8 @@ static void nl80211_global_deinit(void *priv)
 	if (global->nl_event)
 		nl80211_destroy_eloop_handle(&global->nl_event, 0);
 
+	nl80211_async_deinit(global);
+
 	nl_cb_put(global->nl_cb);
 
 	if (global->ioctl_sock >= 0)
@@ -10938,6 +11381,7 @@ const struct wpa_driver_ops wpa_driver_nl80211_ops = {
 	.sta_deauth = i802_sta_deauth,
 	.sta_disassoc = i802_sta_disassoc,
 	.read_sta_data = driver_nl80211_read_sta_data,
+	.read_all_sta_data = i802_read_all_sta_data,
 	.set_freq = i802_set_freq,
 	.send_action = driver_nl80211_send_action,
 	.send_action_cancel_wait = wpa_driver_nl80211_send_action_cancel_wait,
@@ -37,6 +37,12 @@ struct nl80211_global {
 	int ioctl_sock; /* socket for ioctl() use */
 
 	struct nl_handle *nl_event;
+
+	/* Requests sent with send_and_recv_msgs_async() */
+	struct nl_handle *nl_async;
+	struct nl_cb *nl_async_cb;
+	struct dl_list async_reqs; /* struct nl80211_async_req */
+	unsigned int num_async_reqs;
 };
 
 struct nl80211_wiphy_data {
@@ -67,6 +73,7 @@ struct i802_bss {
 	unsigned int added_if:1;
 	unsigned int static_ap:1;
 	unsigned int use_nl_connect:1;
+	unsigned int multicast_to_unicast:1;
 
 	u8 addr[ETH_ALEN];
 
@@ -127,6 +134,14 @@ struct wpa_driver_nl80211_data {
 	enum nl80211_iftype nlmode;
 	enum nl80211_iftype ap_scan_as_station;
 	unsigned int assoc_freq;
+	/* Operating frequency and SSID of the current association; fetched
+	 * once per association event and cleared on association changes */
+	struct {
+		unsigned int freq;
+		u8 ssid[SSID_MAX_LEN];
+		u8 ssid_len;
+		unsigned int valid:1;
+	} assoc_bss;
 
 	int monitor_sock;
 	int monitor_ifidx;
@@ -230,6 +245,14 @@ struct nl_msg * nl80211_bss_msg(struct i802_bss *bss, int flags, uint8_t cmd);
 int send_and_recv_msgs(struct wpa_driver_nl80211_data *drv, struct nl_msg *msg,
 		       int (*valid_handler)(struct nl_msg *, void *),
 		       void *valid_data);
+int send_and_recv_msgs_async(struct wpa_driver_nl80211_data *drv,
+			     struct nl_msg *msg,
+			     int (*valid_handler)(struct nl_msg *, void *),
+			     void *valid_data,
+			     void (*done)(struct wpa_driver_nl80211_data *drv,
+					  int err, void *ctx),
+			     void *ctx);
+void nl80211_async_cancel(struct wpa_driver_nl80211_data *drv, void *ctx);
 int nl80211_create_iface(struct wpa_driver_nl80211_data *drv,
 			 const char *ifname, enum nl80211_iftype iftype,
 			 const u8 *addr, int wds,
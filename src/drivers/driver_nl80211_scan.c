@@ -691,9 +691,14 @@ static int nl80211_scan_filtered(struct wpa_driver_nl80211_data *drv,
 }
 
 
+/*
+ * Parse a BSS from a scan result dump message. If res is not NULL, the entry
+ * is added to it; otherwise, the returned entry needs to be freed with
+ * os_free().
+ */
 static struct wpa_scan_res *
 nl80211_parse_bss_info(struct wpa_driver_nl80211_data *drv,
-		       struct nl_msg *msg)
+		       struct nl_msg *msg, struct wpa_scan_results *res)
 {
 	struct nlattr *tb[NL80211_ATTR_MAX + 1];
 	struct genlmsghdr *gnlh = nlmsg_data(nlmsg_hdr(msg));
@@ -723,6 +728,8 @@ nl80211_parse_bss_info(struct wpa_driver_nl80211_data *drv,
 		  genlmsg_attrlen(gnlh, 0), NULL);
 	if (!tb[NL80211_ATTR_BSS])
 		return NULL;
+	if (res && tb[NL80211_ATTR_GENERATION])
+		res->generation = nla_get_u32(tb[NL80211_ATTR_GENERATION]);
 	if (nla_parse_nested(bss, NL80211_BSS_MAX, tb[NL80211_ATTR_BSS],
 			     bss_policy))
 		return NULL;
@@ -745,7 +752,10 @@ nl80211_parse_bss_info(struct wpa_driver_nl80211_data *drv,
 				  ie ? ie_len : beacon_ie_len))
 		return NULL;
 
-	r = os_zalloc(sizeof(*r) + ie_len + beacon_ie_len);
+	if (res)
+		r = wpa_scan_results_add(res, ie_len + beacon_ie_len);
+	else
+		r = os_zalloc(sizeof(*r) + ie_len + beacon_ie_len);
 	if (r == NULL)
 		return NULL;
 	if (bss[NL80211_BSS_BSSID])
@@ -828,31 +838,21 @@ nl80211_parse_bss_info(struct wpa_driver_nl80211_data *drv,
 struct nl80211_bss_info_arg {
 	struct wpa_driver_nl80211_data *drv;
 	struct wpa_scan_results *res;
+	int dump_intr;
 };
 
 static int bss_info_handler(struct nl_msg *msg, void *arg)
 {
 	struct nl80211_bss_info_arg *_arg = arg;
-	struct wpa_scan_results *res = _arg->res;
-	struct wpa_scan_res **tmp;
-	struct wpa_scan_res *r;
 
-	r = nl80211_parse_bss_info(_arg->drv, msg);
-	if (!r)
-		return NL_SKIP;
+#ifdef NLM_F_DUMP_INTR
+	/* The BSS table changed during the dump */
+	if (nlmsg_hdr(msg)->nlmsg_flags & NLM_F_DUMP_INTR)
+		_arg->dump_intr = 1;
+#endif /* NLM_F_DUMP_INTR */
 
-	if (!res) {
-		os_free(r);
-		return NL_SKIP;
-	}
-	tmp = os_realloc_array(res->res, res->num + 1,
-			       sizeof(struct wpa_scan_res *));
-	if (tmp == NULL) {
-		os_free(r);
-		return NL_SKIP;
-	}
-	tmp[res->num++] = r;
-	res->res = tmp;
+	if (_arg->res)
+		nl80211_parse_bss_info(_arg->drv, msg, _arg->res);
 
 	return NL_SKIP;
 }
@@ -940,12 +940,17 @@ nl80211_get_scan_results(struct wpa_driver_nl80211_data *drv)
 
 	arg.drv = drv;
 	arg.res = res;
+	arg.dump_intr = 0;
 	ret = send_and_recv_msgs(drv, msg, bss_info_handler, &arg);
 	if (ret == 0) {
 		struct nl80211_noise_info info;
 
 		wpa_printf(MSG_DEBUG, "nl80211: Received scan results (%lu "
-			   "BSSes)", (unsigned long) res->num);
+			   "BSSes, generation %u%s)", (unsigned long) res->num,
+			   res->generation,
+			   arg.dump_intr ? ", inconsistent" : "");
+		if (arg.dump_intr)
+			res->generation = 0;
 		if (nl80211_get_noise_for_scan_results(drv, &info) == 0) {
 			size_t i;
 
@@ -990,7 +995,7 @@ static int nl80211_dump_scan_handler(struct nl_msg *msg, void *arg)
 	struct nl80211_dump_scan_ctx *ctx = arg;
 	struct wpa_scan_res *r;
 
-	r = nl80211_parse_bss_info(ctx->drv, msg);
+	r = nl80211_parse_bss_info(ctx->drv, msg, NULL);
 	if (!r)
 		return NL_SKIP;
 	wpa_printf(MSG_DEBUG, "nl80211: %d " MACSTR " %d%s",
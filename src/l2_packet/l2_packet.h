@@ -110,6 +110,27 @@ int l2_packet_get_own_addr(struct l2_packet_data *l2, u8 *addr);
 int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 		   const u8 *buf, size_t len);
 
+/**
+ * l2_packet_send_multi - Send a copy of a packet to multiple destinations
+ * @l2: Pointer to internal l2_packet data from l2_packet_init()
+ * @dst_addrs: Destination addresses (ETH_ALEN octets each)
+ * @num_dst: Number of destination addresses
+ * @buf: Packet contents including the layer 2 header (l2_hdr must have been
+ * set to 1 in l2_packet_init() call)
+ * @len: Length of the buffer
+ * Returns: Number of packets sent or <0 if batched transmission is not
+ * supported
+ *
+ * This function sends a copy of the packet to each of the destination
+ * addresses. The destination address in the layer 2 header of the buffer is
+ * replaced with the address of each destination in the sent packets, but the
+ * buffer itself is not modified. This is an optional function; l2_packet
+ * implementation will need to define it, but it can return -1 in which case
+ * the caller can fall back to calling l2_packet_send() for each destination.
+ */
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len);
+
 /**
  * l2_packet_get_ip_addr - Get the current IP address from the interface
  * @l2: Pointer to internal l2_packet data from l2_packet_init()
@@ -6,6 +6,9 @@
  * See README for more details.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* for sendmmsg() */
+#endif /* _GNU_SOURCE */
 #include "includes.h"
 #include <sys/ioctl.h>
 #include <netpacket/packet.h>
@@ -145,6 +148,65 @@ int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
 }
 
 
+/* Maximum number of packets passed to the kernel in a single sendmmsg() call */
+#define L2_PACKET_SEND_BATCH 32
+
+int l2_packet_send_multi(struct l2_packet_data *l2, const u8 *dst_addrs,
+			 size_t num_dst, const u8 *buf, size_t len)
+{
+	struct mmsghdr msg[L2_PACKET_SEND_BATCH];
+	struct iovec iov[L2_PACKET_SEND_BATCH][2];
+	size_t pos = 0, sent = 0;
+	unsigned int i, batch;
+	int ret;
+
+	if (TEST_FAIL())
+		return -1;
+	if (!l2 || !l2->l2_hdr || len < ETH_ALEN)
+		return -1;
+
+	/* Each packet is the destination address of that packet followed by
+	 * the shared remainder of the buffer */
+	os_memset(msg, 0, sizeof(msg));
+	for (i = 0; i < L2_PACKET_SEND_BATCH; i++) {
+		iov[i][0].iov_len = ETH_ALEN;
+		iov[i][1].iov_base = (void *) (buf + ETH_ALEN);
+		iov[i][1].iov_len = len - ETH_ALEN;
+		msg[i].msg_hdr.msg_iov = iov[i];
+		msg[i].msg_hdr.msg_iovlen = 2;
+	}
+
+	while (pos < num_dst) {
+		batch = num_dst - pos;
+		if (batch > L2_PACKET_SEND_BATCH)
+			batch = L2_PACKET_SEND_BATCH;
+		for (i = 0; i < batch; i++)
+			iov[i][0].iov_base =
+				(void *) &dst_addrs[(pos + i) * ETH_ALEN];
+
+		ret = sendmmsg(l2->fd, msg, batch, 0);
+		if (ret <= 0) {
+			if (pos == 0 && errno == ENOSYS)
+				return -1;
+			/* sendmmsg() stops at the first packet that cannot be
+			 * sent; skip that destination and continue with the
+			 * remaining ones */
+			wpa_printf(MSG_ERROR,
+				   "l2_packet_send_multi - sendmmsg(" MACSTR
+				   "): %s",
+				   MAC2STR(&dst_addrs[pos * ETH_ALEN]),
+				   strerror(errno));
+			pos++;
+			continue;
+		}
+		pos += ret;
+		sent += ret;
+	}
+
+	return sent;
+}
+
+
 static void l2_packet_receive(int sock, void *eloop_ctx, void *sock_ctx)
 {
 	struct l2_packet_data *l2 = eloop_ctx;
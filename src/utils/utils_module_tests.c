@@ -1208,6 +1208,69 @@ static int const_time_tests(void)
 }
 
 
+static int debug_level_test_eval(int *count)
+{
+	(*count)++;
+	return *count;
+}
+
+
+static int debug_level_tests(void)
+{
+	int ret = 0;
+	int count = 0;
+	int level = wpa_debug_level;
+	int mgmt_level = wpa_debug_module_level[WPA_DEBUG_MODULE_MGMT];
+
+	wpa_printf(MSG_INFO, "debug level tests");
+
+	if (wpa_debug_set_module_level("mgmt") == 0 ||
+	    wpa_debug_set_module_level("foo=DEBUG") == 0 ||
+	    wpa_debug_set_module_level("mgmt=foo") == 0 ||
+	    wpa_debug_set_module_level("mgm=DEBUG") == 0 ||
+	    wpa_debug_set_module_level("mgmt=debug") < 0 ||
+	    wpa_debug_module_level[WPA_DEBUG_MODULE_MGMT] != MSG_DEBUG + 1 ||
+	    wpa_debug_set_module_level("mgmt=DEFAULT") < 0 ||
+	    wpa_debug_module_level[WPA_DEBUG_MODULE_MGMT] != 0) {
+		wpa_printf(MSG_ERROR, "debug level test: module level parsing");
+		ret = -1;
+	}
+
+#ifndef CONFIG_NO_STDOUT_DEBUG
+	if (!wpa_debug_all_levels) {
+		/* Arguments of filtered messages are not evaluated */
+		wpa_debug_level = MSG_INFO;
+		wpa_printf(MSG_EXCESSIVE, "debug level test %d",
+			   debug_level_test_eval(&count));
+		wpa_printf_mod(WPA_DEBUG_MODULE_MGMT, MSG_EXCESSIVE,
+			       "debug level test %d",
+			       debug_level_test_eval(&count));
+		wpa_hexdump(MSG_EXCESSIVE, "debug level test", &count,
+			    debug_level_test_eval(&count));
+		if (count != 0) {
+			wpa_printf(MSG_ERROR,
+				   "debug level test: filtered arguments evaluated");
+			ret = -1;
+		}
+
+		wpa_debug_set_module_level("mgmt=EXCESSIVE");
+		if (!wpa_debug_module_enabled(WPA_DEBUG_MODULE_MGMT,
+					      MSG_EXCESSIVE) ||
+		    wpa_debug_level_enabled(MSG_EXCESSIVE)) {
+			wpa_printf(MSG_ERROR,
+				   "debug level test: module level not applied");
+			ret = -1;
+		}
+	}
+#endif /* CONFIG_NO_STDOUT_DEBUG */
+
+	wpa_debug_level = level;
+	wpa_debug_module_level[WPA_DEBUG_MODULE_MGMT] = mgmt_level;
+
+	return ret;
+}
+
+
 int utils_module_tests(void)
 {
 	int ret = 0;
@@ -1226,6 +1289,7 @@ int utils_module_tests(void)
 	    eloop_tests() < 0 ||
 	    json_tests() < 0 ||
 	    const_time_tests() < 0 ||
+	    debug_level_tests() < 0 ||
 	    int_array_tests() < 0)
 		ret = -1;
 
@@ -10,6 +10,17 @@
 
 #include "common.h"
 
+#ifndef CONFIG_NO_STDOUT_DEBUG
+/* The functions are defined here; do not use the level check wrappers */
+#undef wpa_printf
+#undef wpa_hexdump
+#undef wpa_hexdump_key
+#undef wpa_hexdump_buf
+#undef wpa_hexdump_buf_key
+#undef wpa_hexdump_ascii
+#undef wpa_hexdump_ascii_key
+#endif /* CONFIG_NO_STDOUT_DEBUG */
+
 #ifdef CONFIG_DEBUG_SYSLOG
 #include <syslog.h>
 
@@ -32,6 +43,7 @@ static FILE *wpa_debug_tracing_file = NULL;
 int wpa_debug_level = MSG_INFO;
 int wpa_debug_show_keys = 0;
 int wpa_debug_timestamp = 0;
+int wpa_debug_module_level[NUM_WPA_DEBUG_MODULES];
 
 
 #ifdef CONFIG_ANDROID_LOG
@@ -65,6 +77,8 @@ static int wpa_to_android_level(int level)
 static FILE *out_file = NULL;
 #endif /* CONFIG_DEBUG_FILE */
 
+int wpa_debug_all_levels = 0;
+
 
 void wpa_debug_print_timestamp(void)
 {
@@ -178,6 +192,7 @@ int wpa_debug_open_linux_tracing(void)
 		printf("failed to fdopen()\n");
 		return -1;
 	}
+	wpa_debug_all_levels++;
 
 	return 0;
 }
@@ -189,28 +204,467 @@ void wpa_debug_close_linux_tracing(void)
 		return;
 	fclose(wpa_debug_tracing_file);
 	wpa_debug_tracing_file = NULL;
+	wpa_debug_all_levels--;
 }
 
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
 
-/**
- * wpa_printf - conditional printf
- * @level: priority level (MSG_*) of the message
- * @fmt: printf format string, followed by optional arguments
+#ifdef CONFIG_DEBUG_RING
+
+/*
+ * Debug ring
  *
- * This function is used to print conditional debugging and error messages. The
- * output may be directed to stdout, stderr, and/or syslog based on
- * configuration.
+ * Instead of writing each debug message synchronously to stdout or the debug
+ * file, messages are stored as records in a memory ring buffer. Hexdumps are
+ * stored in binary form and formatted only when the ring is written out.
  *
- * Note: New line '\n' is added to the end of the text when printing to stdout.
+ * In WPA_DEBUG_RING_BUFFERED mode, all messages that pass the debug level
+ * filter go through the ring, which is written out in larger batches when it
+ * fills up, when a warning/error is logged, or when a second has passed since
+ * the previous flush.
+ *
+ * In WPA_DEBUG_RING_CAPTURE mode, messages that pass the debug level filter
+ * are printed as before while the more verbose messages (down to the capture
+ * level) are only kept in the ring, overwriting the oldest records when it is
+ * full. The captured records are dumped when an error is logged or when
+ * wpa_debug_ring_flush() is called explicitly.
  */
-void wpa_printf(int level, const char *fmt, ...)
+
+enum wpa_debug_rec_type {
+	WPA_DEBUG_REC_TEXT,
+	WPA_DEBUG_REC_HEXDUMP,
+	WPA_DEBUG_REC_HEXDUMP_ASCII,
+	WPA_DEBUG_REC_WRAP,
+};
+
+#define WPA_DEBUG_REC_NULL BIT(0)
+#define WPA_DEBUG_REC_REMOVED BIT(1)
+
+struct wpa_debug_rec {
+	size_t len; /* full record length including this header */
+	size_t data_len; /* hexdump length */
+	struct os_time ts;
+	u8 type; /* enum wpa_debug_rec_type */
+	u8 level;
+	u8 flags; /* WPA_DEBUG_REC_* */
+	/* followed by NUL terminated text or title and hexdump data */
+};
+
+#define WPA_DEBUG_REC_ALIGN(len) (((len) + 7) & ~((size_t) 7))
+#define WPA_DEBUG_RING_FLUSH_INTERVAL 1
+
+struct wpa_debug_ring {
+	u8 *buf;
+	size_t size;
+	size_t head; /* oldest record */
+	size_t tail; /* first free octet */
+	int wrapped; /* tail is behind head */
+	unsigned int records;
+	unsigned int dropped;
+	unsigned int flushes;
+	enum wpa_debug_ring_mode mode;
+	int capture_level;
+	struct os_reltime last_flush;
+};
+
+static struct wpa_debug_ring *dbg_ring = NULL;
+
+
+static FILE * wpa_debug_out(void)
 {
-	va_list ap;
+#ifdef CONFIG_DEBUG_FILE
+	if (out_file)
+		return out_file;
+#endif /* CONFIG_DEBUG_FILE */
+	return stdout;
+}
 
-	va_start(ap, fmt);
-	if (level >= wpa_debug_level) {
+
+static struct wpa_debug_rec * wpa_debug_ring_rec(size_t *pos)
+{
+	struct wpa_debug_rec *rec;
+
+	if (dbg_ring->size - *pos < sizeof(*rec))
+		*pos = 0;
+	rec = (struct wpa_debug_rec *) (dbg_ring->buf + *pos);
+	if (rec->type == WPA_DEBUG_REC_WRAP) {
+		*pos = 0;
+		rec = (struct wpa_debug_rec *) dbg_ring->buf;
+	}
+	return rec;
+}
+
+
+static void wpa_debug_ring_drop_oldest(void)
+{
+	size_t pos = dbg_ring->head;
+	struct wpa_debug_rec *rec;
+
+	rec = wpa_debug_ring_rec(&pos);
+	if (pos < dbg_ring->head)
+		dbg_ring->wrapped = 0;
+	dbg_ring->head = pos + rec->len;
+	dbg_ring->records--;
+	if (dbg_ring->records == 0) {
+		dbg_ring->head = dbg_ring->tail = 0;
+		dbg_ring->wrapped = 0;
+	}
+}
+
+
+static struct wpa_debug_rec * wpa_debug_ring_reserve(size_t len)
+{
+	struct wpa_debug_ring *r = dbg_ring;
+	struct wpa_debug_rec *rec;
+
+	if (r->records == 0) {
+		r->head = r->tail = 0;
+		r->wrapped = 0;
+	}
+
+	if (!r->wrapped && r->size - r->tail >= len) {
+		rec = (struct wpa_debug_rec *) (r->buf + r->tail);
+	} else if (!r->wrapped && r->head >= len) {
+		/* Wrap around; mark the unused end of the buffer */
+		if (r->size - r->tail >= sizeof(*rec)) {
+			rec = (struct wpa_debug_rec *) (r->buf + r->tail);
+			rec->type = WPA_DEBUG_REC_WRAP;
+		}
+		r->tail = 0;
+		r->wrapped = 1;
+		rec = (struct wpa_debug_rec *) r->buf;
+	} else if (r->wrapped && r->head - r->tail >= len) {
+		rec = (struct wpa_debug_rec *) (r->buf + r->tail);
+	} else {
+		return NULL;
+	}
+
+	r->tail += len;
+	return rec;
+}
+
+
+static void wpa_debug_ring_print_rec(FILE *f, const struct wpa_debug_rec *rec)
+{
+	const char *text = (const char *) (rec + 1);
+	const u8 *pos;
+	size_t i, llen, len;
+	const size_t line_len = 16;
+
+	if (wpa_debug_timestamp)
+		fprintf(f, "%ld.%06u: ", (long) rec->ts.sec,
+			(unsigned int) rec->ts.usec);
+
+	if (rec->type == WPA_DEBUG_REC_TEXT) {
+		fprintf(f, "%s\n", text);
+		return;
+	}
+
+	pos = (const u8 *) text + os_strlen(text) + 1;
+	len = rec->data_len;
+
+	if (rec->type == WPA_DEBUG_REC_HEXDUMP) {
+		fprintf(f, "%s - hexdump(len=%lu):", text, (unsigned long) len);
+		if (rec->flags & WPA_DEBUG_REC_NULL) {
+			fprintf(f, " [NULL]");
+		} else if (rec->flags & WPA_DEBUG_REC_REMOVED) {
+			fprintf(f, " [REMOVED]");
+		} else {
+			for (i = 0; i < len; i++)
+				fprintf(f, " %02x", pos[i]);
+		}
+		fprintf(f, "\n");
+		return;
+	}
+
+	if (rec->flags & WPA_DEBUG_REC_REMOVED) {
+		fprintf(f, "%s - hexdump_ascii(len=%lu): [REMOVED]\n",
+			text, (unsigned long) len);
+		return;
+	}
+	if (rec->flags & WPA_DEBUG_REC_NULL) {
+		fprintf(f, "%s - hexdump_ascii(len=%lu): [NULL]\n",
+			text, (unsigned long) len);
+		return;
+	}
+	fprintf(f, "%s - hexdump_ascii(len=%lu):\n", text, (unsigned long) len);
+	while (len) {
+		llen = len > line_len ? line_len : len;
+		fprintf(f, "    ");
+		for (i = 0; i < llen; i++)
+			fprintf(f, " %02x", pos[i]);
+		for (i = llen; i < line_len; i++)
+			fprintf(f, "   ");
+		fprintf(f, "   ");
+		for (i = 0; i < llen; i++) {
+			if (isprint(pos[i]))
+				fprintf(f, "%c", pos[i]);
+			else
+				fprintf(f, "_");
+		}
+		for (i = llen; i < line_len; i++)
+			fprintf(f, " ");
+		fprintf(f, "\n");
+		pos += llen;
+		len -= llen;
+	}
+}
+
+
+static void wpa_debug_ring_write_out(void)
+{
+	struct wpa_debug_ring *r = dbg_ring;
+	FILE *f = wpa_debug_out();
+	int capture = r->mode == WPA_DEBUG_RING_CAPTURE &&
+		(r->records || r->dropped);
+
+	if (capture)
+		fprintf(f, "---- captured debug log: %u records (%u dropped) ----\n",
+			r->records, r->dropped);
+
+	while (r->records) {
+		size_t pos = r->head;
+
+		wpa_debug_ring_print_rec(f, wpa_debug_ring_rec(&pos));
+		wpa_debug_ring_drop_oldest();
+	}
+
+	if (capture)
+		fprintf(f, "---- end of captured debug log ----\n");
+	fflush(f);
+	r->dropped = 0;
+	r->flushes++;
+	os_get_reltime(&r->last_flush);
+}
+
+
+static int wpa_debug_ring_accept(int level, int min_level)
+{
+	if (!dbg_ring)
+		return 0;
+#ifdef CONFIG_DEBUG_SYSLOG
+	if (wpa_debug_syslog)
+		return 0;
+#endif /* CONFIG_DEBUG_SYSLOG */
+
+	if (dbg_ring->mode == WPA_DEBUG_RING_BUFFERED)
+		return level >= min_level;
+
+	if (level >= min_level) {
+		/* Printed directly; dump the captured context on errors */
+		if (level >= MSG_ERROR && dbg_ring->records)
+			wpa_debug_ring_write_out();
+		return 0;
+	}
+
+	return level >= dbg_ring->capture_level;
+}
+
+
+/* Returns the new record or %NULL if the message needs to be printed directly
+ * (buffered mode) or was dropped (capture mode) */
+static struct wpa_debug_rec * wpa_debug_ring_alloc(int level, u8 type,
+						   size_t payload_len)
+{
+	struct wpa_debug_ring *r = dbg_ring;
+	struct wpa_debug_rec *rec;
+	size_t len = WPA_DEBUG_REC_ALIGN(sizeof(*rec) + payload_len);
+
+	if (len > r->size) {
+		if (r->mode == WPA_DEBUG_RING_BUFFERED)
+			wpa_debug_ring_write_out();
+		else
+			r->dropped++;
+		return NULL;
+	}
+
+	while (!(rec = wpa_debug_ring_reserve(len))) {
+		if (r->mode == WPA_DEBUG_RING_BUFFERED) {
+			wpa_debug_ring_write_out();
+		} else {
+			wpa_debug_ring_drop_oldest();
+			r->dropped++;
+		}
+	}
+
+	os_memset(rec, 0, sizeof(*rec));
+	rec->len = len;
+	rec->type = type;
+	rec->level = level;
+	os_get_time(&rec->ts);
+	r->records++;
+	return rec;
+}
+
+
+static void wpa_debug_ring_committed(int level)
+{
+	struct os_reltime now;
+
+	if (dbg_ring->mode != WPA_DEBUG_RING_BUFFERED)
+		return;
+	os_get_reltime(&now);
+	if (level >= MSG_WARNING ||
+	    os_reltime_expired(&now, &dbg_ring->last_flush,
+			       WPA_DEBUG_RING_FLUSH_INTERVAL))
+		wpa_debug_ring_write_out();
+}
+
+
+static int wpa_debug_ring_vprintf(int level, const char *fmt, va_list ap)
+{
+	struct wpa_debug_rec *rec;
+	char tmp[256];
+	va_list ap2;
+	int len;
+
+	va_copy(ap2, ap);
+	len = vsnprintf(tmp, sizeof(tmp), fmt, ap2);
+	va_end(ap2);
+	if (len < 0)
+		return -1;
+
+	rec = wpa_debug_ring_alloc(level, WPA_DEBUG_REC_TEXT, len + 1);
+	if (!rec)
+		return dbg_ring->mode == WPA_DEBUG_RING_CAPTURE ? 0 : -1;
+	if ((size_t) len < sizeof(tmp))
+		os_memcpy(rec + 1, tmp, len + 1);
+	else
+		vsnprintf((char *) (rec + 1), len + 1, fmt, ap);
+	wpa_debug_ring_committed(level);
+	return 0;
+}
+
+
+static int wpa_debug_ring_hexdump(int level, u8 type, const char *title,
+				  const u8 *buf, size_t len, int show)
+{
+	struct wpa_debug_rec *rec;
+	size_t title_len = os_strlen(title);
+	size_t data_len = buf && show ? len : 0;
+	u8 *pos;
+
+	rec = wpa_debug_ring_alloc(level, type, title_len + 1 + data_len);
+	if (!rec)
+		return dbg_ring->mode == WPA_DEBUG_RING_CAPTURE ? 0 : -1;
+	rec->data_len = len;
+	if (!buf)
+		rec->flags |= WPA_DEBUG_REC_NULL;
+	else if (!show)
+		rec->flags |= WPA_DEBUG_REC_REMOVED;
+	pos = (u8 *) (rec + 1);
+	os_memcpy(pos, title, title_len + 1);
+	if (data_len)
+		os_memcpy(pos + title_len + 1, buf, data_len);
+	wpa_debug_ring_committed(level);
+	return 0;
+}
+
+
+/**
+ * wpa_debug_ring_init - Start using a debug ring buffer
+ * @mode: WPA_DEBUG_RING_BUFFERED or WPA_DEBUG_RING_CAPTURE
+ * @size: Size of the ring buffer in octets
+ * @capture_level: Lowest message level to capture (WPA_DEBUG_RING_CAPTURE)
+ * Returns: 0 on success, -1 on failure
+ */
+int wpa_debug_ring_init(enum wpa_debug_ring_mode mode, size_t size,
+			int capture_level)
+{
+#ifdef CONFIG_ANDROID_LOG
+	return -1;
+#else /* CONFIG_ANDROID_LOG */
+	struct wpa_debug_ring *r;
+
+	wpa_debug_ring_deinit();
+
+	r = os_zalloc(sizeof(*r));
+	if (!r)
+		return -1;
+	r->size = size & ~((size_t) 7);
+	r->buf = os_malloc(r->size);
+	if (!r->buf) {
+		os_free(r);
+		return -1;
+	}
+	r->mode = mode;
+	r->capture_level = capture_level;
+	os_get_reltime(&r->last_flush);
+	dbg_ring = r;
+	if (mode == WPA_DEBUG_RING_CAPTURE)
+		wpa_debug_all_levels++;
+	return 0;
+#endif /* CONFIG_ANDROID_LOG */
+}
+
+
+/**
+ * wpa_debug_ring_flush - Write out all records from the debug ring buffer
+ */
+void wpa_debug_ring_flush(void)
+{
+	if (dbg_ring)
+		wpa_debug_ring_write_out();
+}
+
+
+/**
+ * wpa_debug_ring_deinit - Flush and free the debug ring buffer
+ */
+void wpa_debug_ring_deinit(void)
+{
+	struct wpa_debug_ring *r = dbg_ring;
+
+	if (!r)
+		return;
+	if (r->mode == WPA_DEBUG_RING_BUFFERED)
+		wpa_debug_ring_write_out();
+	else
+		wpa_debug_all_levels--;
+	dbg_ring = NULL;
+	bin_clear_free(r->buf, r->size);
+	os_free(r);
+}
+
+
+/**
+ * wpa_debug_ring_get_stats - Get debug ring buffer statistics
+ * @records: Buffer for the number of records currently in the ring
+ * @dropped: Buffer for the number of records dropped since the last flush
+ * @flushes: Buffer for the number of times the ring has been written out
+ * Returns: 0 on success, -1 if the debug ring is not in use
+ */
+int wpa_debug_ring_get_stats(unsigned int *records, unsigned int *dropped,
+			     unsigned int *flushes)
+{
+	if (!dbg_ring)
+		return -1;
+	*records = dbg_ring->records;
+	*dropped = dbg_ring->dropped;
+	*flushes = dbg_ring->flushes;
+	return 0;
+}
+
+#endif /* CONFIG_DEBUG_RING */
+
+
+static void wpa_vprintf_level(int level, int min_level, const char *fmt,
+			      va_list ap)
+{
+#ifdef CONFIG_DEBUG_LINUX_TRACING
+	va_list ap2;
+
+	va_copy(ap2, ap);
+#endif /* CONFIG_DEBUG_LINUX_TRACING */
+
+#ifdef CONFIG_DEBUG_RING
+	if (wpa_debug_ring_accept(level, min_level) &&
+	    wpa_debug_ring_vprintf(level, fmt, ap) == 0) {
+		/* Stored in the debug ring */
+	} else
+#endif /* CONFIG_DEBUG_RING */
+	if (level >= min_level) {
 #ifdef CONFIG_ANDROID_LOG
 		__android_log_vprint(wpa_to_android_level(level),
 				     ANDROID_LOG_NAME, fmt, ap);
@@ -237,23 +691,53 @@ void wpa_printf(int level, const char *fmt, ...)
 #endif /* CONFIG_DEBUG_SYSLOG */
 #endif /* CONFIG_ANDROID_LOG */
 	}
-	va_end(ap);
 
 #ifdef CONFIG_DEBUG_LINUX_TRACING
 	if (wpa_debug_tracing_file != NULL) {
-		va_start(ap, fmt);
 		fprintf(wpa_debug_tracing_file, WPAS_TRACE_PFX, level);
-		vfprintf(wpa_debug_tracing_file, fmt, ap);
+		vfprintf(wpa_debug_tracing_file, fmt, ap2);
 		fprintf(wpa_debug_tracing_file, "\n");
 		fflush(wpa_debug_tracing_file);
-		va_end(ap);
 	}
+	va_end(ap2);
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 }
 
 
-static void _wpa_hexdump(int level, const char *title, const u8 *buf,
-			 size_t len, int show)
+/**
+ * wpa_printf - conditional printf
+ * @level: priority level (MSG_*) of the message
+ * @fmt: printf format string, followed by optional arguments
+ *
+ * This function is used to print conditional debugging and error messages. The
+ * output may be directed to stdout, stderr, and/or syslog based on
+ * configuration.
+ *
+ * Note: New line '\n' is added to the end of the text when printing to stdout.
+ */
+void wpa_printf(int level, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	wpa_vprintf_level(level, wpa_debug_level, fmt, ap);
+	va_end(ap);
+}
+
+
+void wpa_printf_module(enum wpa_debug_module module, int level,
+		       const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	wpa_vprintf_level(level, wpa_debug_module_min_level(module), fmt, ap);
+	va_end(ap);
+}
+
+
+static void _wpa_hexdump(int level, int min_level, const char *title,
+			 const u8 *buf, size_t len, int show)
 {
 	size_t i;
 
@@ -275,7 +759,13 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 	}
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
-	if (level < wpa_debug_level)
+#ifdef CONFIG_DEBUG_RING
+	if (wpa_debug_ring_accept(level, min_level) &&
+	    wpa_debug_ring_hexdump(level, WPA_DEBUG_REC_HEXDUMP, title, buf,
+				   len, show) == 0)
+		return;
+#endif /* CONFIG_DEBUG_RING */
+	if (level < min_level)
 		return;
 #ifdef CONFIG_ANDROID_LOG
 	{
@@ -381,18 +871,27 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 
 void wpa_hexdump(int level, const char *title, const void *buf, size_t len)
 {
-	_wpa_hexdump(level, title, buf, len, 1);
+	_wpa_hexdump(level, wpa_debug_level, title, buf, len, 1);
 }
 
 
 void wpa_hexdump_key(int level, const char *title, const void *buf, size_t len)
 {
-	_wpa_hexdump(level, title, buf, len, wpa_debug_show_keys);
+	_wpa_hexdump(level, wpa_debug_level, title, buf, len,
+		     wpa_debug_show_keys);
+}
+
+
+void wpa_hexdump_module(enum wpa_debug_module module, int level,
+			const char *title, const void *buf, size_t len)
+{
+	_wpa_hexdump(level, wpa_debug_module_min_level(module), title, buf, len,
+		     1);
 }
 
 
-static void _wpa_hexdump_ascii(int level, const char *title, const void *buf,
-			       size_t len, int show)
+static void _wpa_hexdump_ascii(int level, int min_level, const char *title,
+			       const void *buf, size_t len, int show)
 {
 	size_t i, llen;
 	const u8 *pos = buf;
@@ -417,14 +916,20 @@ static void _wpa_hexdump_ascii(int level, const char *title, const void *buf,
 	}
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
-	if (level < wpa_debug_level)
+#ifdef CONFIG_DEBUG_RING
+	if (wpa_debug_ring_accept(level, min_level) &&
+	    wpa_debug_ring_hexdump(level, WPA_DEBUG_REC_HEXDUMP_ASCII, title,
+				   buf, len, show) == 0)
+		return;
+#endif /* CONFIG_DEBUG_RING */
+	if (level < min_level)
 		return;
 #ifdef CONFIG_ANDROID_LOG
-	_wpa_hexdump(level, title, buf, len, show);
+	_wpa_hexdump(level, min_level, title, buf, len, show);
 #else /* CONFIG_ANDROID_LOG */
 #ifdef CONFIG_DEBUG_SYSLOG
 	if (wpa_debug_syslog) {
-		_wpa_hexdump(level, title, buf, len, show);
+		_wpa_hexdump(level, min_level, title, buf, len, show);
 		return;
 	}
 #endif /* CONFIG_DEBUG_SYSLOG */
@@ -508,14 +1013,15 @@ static void _wpa_hexdump_ascii(int level, const char *title, const void *buf,
 void wpa_hexdump_ascii(int level, const char *title, const void *buf,
 		       size_t len)
 {
-	_wpa_hexdump_ascii(level, title, buf, len, 1);
+	_wpa_hexdump_ascii(level, wpa_debug_level, title, buf, len, 1);
 }
 
 
 void wpa_hexdump_ascii_key(int level, const char *title, const void *buf,
 			   size_t len)
 {
-	_wpa_hexdump_ascii(level, title, buf, len, wpa_debug_show_keys);
+	_wpa_hexdump_ascii(level, wpa_debug_level, title, buf, len,
+			   wpa_debug_show_keys);
 }
 
 
@@ -599,6 +1105,10 @@ void wpa_debug_close_file(void)
 #ifdef CONFIG_DEBUG_FILE
 	if (!out_file)
 		return;
+#ifdef CONFIG_DEBUG_RING
+	if (dbg_ring && dbg_ring->mode == WPA_DEBUG_RING_BUFFERED)
+		wpa_debug_ring_write_out();
+#endif /* CONFIG_DEBUG_RING */
 	fclose(out_file);
 	out_file = NULL;
 	os_free(last_path);
@@ -890,3 +1400,75 @@ int str_to_debug_level(const char *s)
 		return MSG_ERROR;
 	return -1;
 }
+
+
+static const char *wpa_debug_module_names[NUM_WPA_DEBUG_MODULES] = {
+	[WPA_DEBUG_MODULE_MGMT] = "mgmt",
+};
+
+
+/**
+ * wpa_debug_set_module_level - Set debug level for a module
+ * @spec: "<module>=<level>" or "<module>=DEFAULT" to follow the global level
+ * Returns: 0 on success, -1 on failure
+ */
+int wpa_debug_set_module_level(const char *spec)
+{
+	const char *pos;
+	int i, level;
+
+	pos = os_strchr(spec, '=');
+	if (!pos)
+		return -1;
+	if (os_strcasecmp(pos + 1, "DEFAULT") == 0) {
+		level = -1;
+	} else {
+		level = str_to_debug_level(pos + 1);
+		if (level < 0)
+			return -1;
+	}
+
+	for (i = 0; i < NUM_WPA_DEBUG_MODULES; i++) {
+		const char *name = wpa_debug_module_names[i];
+
+		if (os_strlen(name) == (size_t) (pos - spec) &&
+		    os_strncasecmp(spec, name, pos - spec) == 0) {
+			wpa_debug_module_level[i] = level + 1;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * wpa_debug_module_levels_str - Write module debug levels into a buffer
+ * @buf: Buffer for the "Module <name>: <level>" lines
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written
+ *
+ * Only the modules that have an explicitly set level are listed (even if it
+ * is currently the same as the global debug level), so nothing is written
+ * unless a module level has been set.
+ */
+int wpa_debug_module_levels_str(char *buf, size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	int i, ret;
+
+	for (i = 0; i < NUM_WPA_DEBUG_MODULES; i++) {
+		int level = wpa_debug_module_level[i] - 1;
+
+		if (level < 0)
+			continue; /* follows the global level */
+		ret = os_snprintf(pos, end - pos, "Module %s: %s\n",
+				  wpa_debug_module_names[i],
+				  debug_level_str(level));
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
@@ -25,6 +25,18 @@ enum {
 	MSG_EXCESSIVE, MSG_MSGDUMP, MSG_DEBUG, MSG_INFO, MSG_WARNING, MSG_ERROR
 };
 
+/* Modules with a separately configurable debug level; see wpa_printf_mod() */
+enum wpa_debug_module {
+	WPA_DEBUG_MODULE_MGMT,
+	NUM_WPA_DEBUG_MODULES
+};
+
+/* Debug level per module: MSG_* + 1 or 0 to follow wpa_debug_level */
+extern int wpa_debug_module_level[NUM_WPA_DEBUG_MODULES];
+
+int wpa_debug_set_module_level(const char *spec);
+int wpa_debug_module_levels_str(char *buf, size_t buflen);
+
 #ifdef CONFIG_NO_STDOUT_DEBUG
 
 #define wpa_debug_print_timestamp() do { } while (0)
@@ -39,14 +51,61 @@ enum {
 #define wpa_debug_close_file() do { } while (0)
 #define wpa_debug_setup_stdout() do { } while (0)
 #define wpa_dbg(args...) do { } while (0)
+#define wpa_printf_mod(args...) do { } while (0)
+#define wpa_hexdump_mod(m,l,t,b,le) do { } while (0)
 
 static inline int wpa_debug_reopen_file(void)
 {
 	return 0;
 }
 
+static inline int wpa_debug_level_enabled(int level)
+{
+	return 0;
+}
+
+static inline int wpa_debug_module_enabled(enum wpa_debug_module module,
+					   int level)
+{
+	return 0;
+}
+
 #else /* CONFIG_NO_STDOUT_DEBUG */
 
+/* Number of active debug outputs that want messages of all levels regardless
+ * of wpa_debug_level (Linux tracing, debug ring in capture mode) */
+extern int wpa_debug_all_levels;
+
+/**
+ * wpa_debug_level_enabled - Check whether a debug message would be output
+ * @level: priority level (MSG_*) of the message
+ * Returns: 1 if a message at this level may be output, 0 if it is filtered
+ */
+static inline int wpa_debug_level_enabled(int level)
+{
+	return level >= wpa_debug_level || wpa_debug_all_levels;
+}
+
+static inline int wpa_debug_module_min_level(enum wpa_debug_module module)
+{
+	int level = wpa_debug_module_level[module];
+
+	return level ? level - 1 : wpa_debug_level;
+}
+
+/**
+ * wpa_debug_module_enabled - Check whether a module debug message is output
+ * @module: Debug module (WPA_DEBUG_MODULE_*)
+ * @level: priority level (MSG_*) of the message
+ * Returns: 1 if a message at this level may be output, 0 if it is filtered
+ */
+static inline int wpa_debug_module_enabled(enum wpa_debug_module module,
+					   int level)
+{
+	return level >= wpa_debug_module_min_level(module) ||
+		wpa_debug_all_levels;
+}
+
 int wpa_debug_open_file(const char *path);
 int wpa_debug_reopen_file(void);
 void wpa_debug_close_file(void);
@@ -150,6 +209,84 @@ void wpa_hexdump_ascii(int level, const char *title, const void *buf,
 void wpa_hexdump_ascii_key(int level, const char *title, const void *buf,
 			   size_t len);
 
+/**
+ * wpa_printf_module - conditional printf with a module specific debug level
+ * @module: Debug module (WPA_DEBUG_MODULE_*)
+ * @level: priority level (MSG_*) of the message
+ * @fmt: printf format string, followed by optional arguments
+ *
+ * This works like wpa_printf(), but the message is filtered based on the debug
+ * level of the module (LOG_LEVEL <module>=<level>) instead of the global debug
+ * level. Use the wpa_printf_mod() wrapper instead of calling this directly.
+ */
+void wpa_printf_module(enum wpa_debug_module module, int level,
+		       const char *fmt, ...)
+PRINTF_FORMAT(3, 4);
+
+void wpa_hexdump_module(enum wpa_debug_module module, int level,
+			const char *title, const void *buf, size_t len);
+
+/*
+ * The debug print functions are wrapped in macros that check the debug level
+ * before the call so that the arguments (MAC2STR(), wpa_ssid_txt(), etc.) are
+ * not evaluated and passed for messages that would be filtered out anyway.
+ */
+#define wpa_printf(level, ...)						\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_printf((level), __VA_ARGS__);		\
+	} while (0)
+
+#define wpa_hexdump(level, title, buf, len)				\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump((level), (title), (buf), (len));	\
+	} while (0)
+
+#define wpa_hexdump_key(level, title, buf, len)				\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump_key((level), (title), (buf), (len)); \
+	} while (0)
+
+#define wpa_hexdump_buf(level, title, buf)				\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump_buf((level), (title), (buf));	\
+	} while (0)
+
+#define wpa_hexdump_buf_key(level, title, buf)				\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump_buf_key((level), (title), (buf));	\
+	} while (0)
+
+#define wpa_hexdump_ascii(level, title, buf, len)			\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump_ascii((level), (title), (buf), (len)); \
+	} while (0)
+
+#define wpa_hexdump_ascii_key(level, title, buf, len)			\
+	do {								\
+		if (wpa_debug_level_enabled(level))			\
+			wpa_hexdump_ascii_key((level), (title), (buf),	\
+					      (len));			\
+	} while (0)
+
+#define wpa_printf_mod(module, level, ...)				\
+	do {								\
+		if (wpa_debug_module_enabled((module), (level)))	\
+			wpa_printf_module((module), (level), __VA_ARGS__); \
+	} while (0)
+
+#define wpa_hexdump_mod(module, level, title, buf, len)			\
+	do {								\
+		if (wpa_debug_module_enabled((module), (level)))	\
+			wpa_hexdump_module((module), (level), (title),	\
+					   (buf), (len));		\
+	} while (0)
+
 /*
  * wpa_dbg() behaves like wpa_msg(), but it can be removed from build to reduce
  * binary size. As such, it should be used with debugging messages that are not
@@ -352,6 +489,47 @@ static inline void wpa_debug_close_linux_tracing(void)
 
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
+enum wpa_debug_ring_mode {
+	WPA_DEBUG_RING_BUFFERED,
+	WPA_DEBUG_RING_CAPTURE,
+};
+
+#define WPA_DEBUG_RING_DEFAULT_SIZE 65536
+
+#if defined(CONFIG_DEBUG_RING) && !defined(CONFIG_NO_STDOUT_DEBUG)
+
+int wpa_debug_ring_init(enum wpa_debug_ring_mode mode, size_t size,
+			int capture_level);
+void wpa_debug_ring_flush(void);
+void wpa_debug_ring_deinit(void);
+int wpa_debug_ring_get_stats(unsigned int *records, unsigned int *dropped,
+			     unsigned int *flushes);
+
+#else /* CONFIG_DEBUG_RING && !CONFIG_NO_STDOUT_DEBUG */
+
+static inline int wpa_debug_ring_init(enum wpa_debug_ring_mode mode,
+				      size_t size, int capture_level)
+{
+	return -1;
+}
+
+static inline void wpa_debug_ring_flush(void)
+{
+}
+
+static inline void wpa_debug_ring_deinit(void)
+{
+}
+
+static inline int wpa_debug_ring_get_stats(unsigned int *records,
+					   unsigned int *dropped,
+					   unsigned int *flushes)
+{
+	return -1;
+}
+
+#endif /* CONFIG_DEBUG_RING && !CONFIG_NO_STDOUT_DEBUG */
+
 
 #ifdef EAPOL_TEST
 #define WPA_ASSERT(a)						       \
@@ -219,6 +219,11 @@ ifdef CONFIG_NO_CONFIG_WRITE
 L_CFLAGS += -DCONFIG_NO_CONFIG_WRITE
 endif
 
+ifdef CONFIG_PSK_CACHE
+L_CFLAGS += -DCONFIG_PSK_CACHE
+NEED_SHA256=y
+endif
+
 ifdef CONFIG_NO_CONFIG_BLOBS
 L_CFLAGS += -DCONFIG_NO_CONFIG_BLOBS
 endif
@@ -1549,6 +1554,10 @@ ifdef CONFIG_DEBUG_LINUX_TRACING
 L_CFLAGS += -DCONFIG_DEBUG_LINUX_TRACING
 endif
 
+ifdef CONFIG_DEBUG_RING
+L_CFLAGS += -DCONFIG_DEBUG_RING
+endif
+
 ifdef CONFIG_DEBUG_FILE
 L_CFLAGS += -DCONFIG_DEBUG_FILE
 endif
@@ -1600,6 +1609,11 @@ L_CFLAGS += -DCONFIG_AUTOSCAN
 OBJS += autoscan.c
 endif
 
+ifdef CONFIG_SCAN_LEARN
+L_CFLAGS += -DCONFIG_SCAN_LEARN
+OBJS += scan_learn.c
+endif
+
 ifdef CONFIG_EXT_PASSWORD_TEST
 OBJS += src/utils/ext_password_test.c
 L_CFLAGS += -DCONFIG_EXT_PASSWORD_TEST
@@ -11,6 +11,7 @@
 #include "utils/common.h"
 #include "utils/eloop.h"
 #include "common/ieee802_11_defs.h"
+#include "common/ieee802_11_common.h"
 #include "drivers/driver.h"
 #include "eap_peer/eap.h"
 #include "wpa_supplicant_i.h"
@@ -31,6 +32,167 @@
 #define WPA_BSS_IES_CHANGED_FLAG	BIT(8)
 
 
+/*
+ * Index of the elements in the IEs of a BSS entry. The first occurrence of each
+ * element ID is recorded so that wpa_bss_get_ie() does not need to walk through
+ * the IEs. The offsets are stored densely in element ID order and a bitmap of
+ * the IDs that are present is used together with per-word counts to find the
+ * offset of a specific ID. Vendor specific elements are recorded in a separate
+ * (small) list of the first occurrence of each vendor type.
+ */
+struct wpa_bss_ie_map {
+	u32 present[8];
+	u8 rank[8]; /* number of IDs present in the preceding words */
+	const u16 *offset;
+};
+
+struct wpa_bss_ie_vendor {
+	u32 type;
+	u16 offset;
+};
+
+struct wpa_bss_ie_index {
+	struct wpa_bss_ie_map eid;
+	unsigned int num_vendor;
+	const struct wpa_bss_ie_vendor *vendor;
+	/* followed by the offset arrays and the vendor list */
+};
+
+
+static void wpa_bss_ie_index_flush(struct wpa_bss *bss)
+{
+	os_free(bss->ie_index);
+	bss->ie_index = NULL;
+}
+
+
+static unsigned int wpa_bss_ie_bits(u32 val)
+{
+	val = val - ((val >> 1) & 0x55555555);
+	val = (val & 0x33333333) + ((val >> 2) & 0x33333333);
+	return (((val + (val >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+
+static int wpa_bss_ie_map_add(struct wpa_bss_ie_map *map, u8 id)
+{
+	u32 bit = BIT(id % 32);
+
+	if (map->present[id / 32] & bit)
+		return 0;
+	map->present[id / 32] |= bit;
+	return 1;
+}
+
+
+static unsigned int wpa_bss_ie_map_rank(const struct wpa_bss_ie_map *map,
+					u8 id)
+{
+	return map->rank[id / 32] +
+		wpa_bss_ie_bits(map->present[id / 32] & (BIT(id % 32) - 1));
+}
+
+
+static unsigned int wpa_bss_ie_map_finish(struct wpa_bss_ie_map *map)
+{
+	unsigned int i, count = 0;
+
+	for (i = 0; i < ARRAY_SIZE(map->present); i++) {
+		map->rank[i] = count;
+		count += wpa_bss_ie_bits(map->present[i]);
+	}
+
+	return count;
+}
+
+
+static int wpa_bss_ie_vendor_seen(const struct wpa_bss_ie_vendor *vendor,
+				  unsigned int num, u32 type)
+{
+	unsigned int i;
+
+	for (i = 0; i < num; i++) {
+		if (vendor[i].type == type)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+static struct wpa_bss_ie_index *
+wpa_bss_build_ie_index(const struct wpa_bss *bss)
+{
+	struct wpa_bss_ie_index *idx, tmp;
+	const struct element *elem;
+	const u8 *ies = (const u8 *) (bss + 1);
+	unsigned int num_eid, max_vendor = 0, num_vendor = 0;
+	struct wpa_bss_ie_vendor *vendor;
+	u16 *eid_offset;
+	size_t len;
+
+	/* Offsets are stored as u16; fall back to the linear search for IEs
+	 * that do not fit in a single netlink attribute anyway */
+	if (bss->ie_len > 0xffff)
+		return NULL;
+
+	os_memset(&tmp, 0, sizeof(tmp));
+	for_each_element(elem, ies, bss->ie_len) {
+		wpa_bss_ie_map_add(&tmp.eid, elem->id);
+		if (elem->id == WLAN_EID_VENDOR_SPECIFIC && elem->datalen >= 4)
+			max_vendor++;
+	}
+	num_eid = wpa_bss_ie_map_finish(&tmp.eid);
+
+	len = sizeof(*idx) + max_vendor * sizeof(struct wpa_bss_ie_vendor) +
+		num_eid * sizeof(u16);
+	idx = os_malloc(len);
+	if (!idx)
+		return NULL;
+	*idx = tmp;
+	vendor = (struct wpa_bss_ie_vendor *) (idx + 1);
+	eid_offset = (u16 *) (vendor + max_vendor);
+
+	/* Fill in the offsets of the first occurrence of each ID; the maps are
+	 * rebuilt on the way to know which IDs have already been recorded. */
+	os_memset(&tmp, 0, sizeof(tmp));
+	for_each_element(elem, ies, bss->ie_len) {
+		u16 offset = (const u8 *) elem - ies;
+
+		if (wpa_bss_ie_map_add(&tmp.eid, elem->id))
+			eid_offset[wpa_bss_ie_map_rank(&idx->eid, elem->id)] =
+				offset;
+		if (elem->id == WLAN_EID_VENDOR_SPECIFIC && elem->datalen >= 4) {
+			u32 type = WPA_GET_BE32(elem->data);
+
+			if (!wpa_bss_ie_vendor_seen(vendor, num_vendor, type)) {
+				vendor[num_vendor].type = type;
+				vendor[num_vendor].offset = offset;
+				num_vendor++;
+			}
+		}
+	}
+
+	idx->eid.offset = eid_offset;
+	idx->vendor = vendor;
+	idx->num_vendor = num_vendor;
+
+	return idx;
+}
+
+
+static const struct wpa_bss_ie_index *
+wpa_bss_get_ie_index(const struct wpa_bss *bss)
+{
+	/* The index is only a cache of the IEs, so it is built on demand even
+	 * when the entry is accessed through a const pointer */
+	if (!bss->ie_index)
+		((struct wpa_bss *) bss)->ie_index =
+			wpa_bss_build_ie_index(bss);
+	return bss->ie_index;
+}
+
+
 static void wpa_bss_set_hessid(struct wpa_bss *bss)
 {
 #ifdef CONFIG_INTERWORKING
@@ -245,6 +407,7 @@ void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		wpa_ssid_txt(bss->ssid, bss->ssid_len), reason);
 	wpas_notify_bss_removed(wpa_s, bss->bssid, bss->id);
 	wpa_bss_anqp_free(bss->anqp);
+	os_free(bss->ie_index);
 	os_free(bss);
 }
 
@@ -437,6 +600,8 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 		return NULL;
 	bss->id = wpa_s->bss_next_id++;
 	bss->last_update_idx = wpa_s->bss_update_idx;
+	bss->drv_generation = wpa_s->bss_update_generation;
+	wpa_s->bss_update_added++;
 	wpa_bss_copy_res(bss, res, fetch_time);
 	os_memcpy(bss->ssid, ssid, ssid_len);
 	bss->ssid_len = ssid_len;
@@ -595,12 +760,57 @@ static void notify_bss_changes(struct wpa_supplicant *wpa_s, u32 changes,
 }
 
 
+/*
+ * Check whether a scan result is known to be the same information that the
+ * BSS entry was last updated with, i.e., whether the driver has not received
+ * a new Beacon or Probe Response frame from the BSS since then.
+ */
+static int wpa_bss_res_unchanged(struct wpa_supplicant *wpa_s,
+				 const struct wpa_bss *bss,
+				 const struct wpa_scan_res *res)
+{
+	if (bss->last_update_idx == wpa_s->bss_update_idx ||
+	    bss->freq != res->freq ||
+	    bss->ie_len != res->ie_len ||
+	    bss->beacon_ie_len != res->beacon_ie_len)
+		return 0;
+
+	/* No changes in the driver BSS table since the previous update */
+	if (wpa_s->bss_update_generation &&
+	    bss->drv_generation == wpa_s->bss_update_generation)
+		return 1;
+
+	/* The timestamp changes with each received frame */
+	return res->tsf && bss->tsf == res->tsf &&
+		bss->level == res->level && bss->caps == res->caps;
+}
+
+
 static struct wpa_bss *
 wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	       struct wpa_scan_res *res, struct os_reltime *fetch_time)
 {
 	u32 changes;
 
+	if (wpa_bss_res_unchanged(wpa_s, bss, res)) {
+		/*
+		 * Skip comparison of the IEs, the change notifications, and
+		 * moving the entry in the list since nothing was received from
+		 * the BSS. Noise based values and the flags (e.g., the
+		 * associated state) may still have changed.
+		 */
+		bss->scan_miss_count = 0;
+		bss->last_update_idx = wpa_s->bss_update_idx;
+		bss->drv_generation = wpa_s->bss_update_generation;
+		bss->flags = res->flags;
+		bss->qual = res->qual;
+		bss->noise = res->noise;
+		bss->snr = res->snr;
+		bss->est_throughput = res->est_throughput;
+		wpa_s->bss_update_unchanged++;
+		return bss;
+	}
+
 	if (bss->last_update_idx == wpa_s->bss_update_idx) {
 		struct os_reltime update_time;
 
@@ -643,6 +853,8 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 			   MAC2STR(bss->bssid), bss->freq, res->freq);
 	bss->scan_miss_count = 0;
 	bss->last_update_idx = wpa_s->bss_update_idx;
+	bss->drv_generation = wpa_s->bss_update_generation;
+	wpa_s->bss_update_changed++;
 	wpa_bss_copy_res(bss, res, fetch_time);
 	/* Move the entry to the end of the list */
 	dl_list_del(&bss->list);
@@ -662,11 +874,18 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 			MAC2STR(bss->bssid));
 	} else
 #endif /* CONFIG_P2P */
-	if (bss->ie_len + bss->beacon_ie_len >=
-	    res->ie_len + res->beacon_ie_len) {
+	if (!(changes & WPA_BSS_IES_CHANGED_FLAG) &&
+	    bss->beacon_ie_len == res->beacon_ie_len &&
+	    os_memcmp((const u8 *) (bss + 1) + bss->ie_len,
+		      (const u8 *) (res + 1) + res->ie_len,
+		      res->beacon_ie_len) == 0) {
+		/* IEs are unchanged; keep the current buffer as-is */
+	} else if (bss->ie_len + bss->beacon_ie_len >=
+		   res->ie_len + res->beacon_ie_len) {
 		os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
 		bss->ie_len = res->ie_len;
 		bss->beacon_ie_len = res->beacon_ie_len;
+		wpa_bss_ie_index_flush(bss);
 	} else {
 		struct wpa_bss *nbss;
 		struct dl_list *prev = bss->list_id.prev;
@@ -689,6 +908,7 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 				  res->ie_len + res->beacon_ie_len);
 			bss->ie_len = res->ie_len;
 			bss->beacon_ie_len = res->beacon_ie_len;
+			wpa_bss_ie_index_flush(bss);
 		}
 		dl_list_add(prev, &bss->list_id);
 	}
@@ -717,6 +937,10 @@ void wpa_bss_update_start(struct wpa_supplicant *wpa_s)
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Start scan result update %u",
 		wpa_s->bss_update_idx);
 	wpa_s->last_scan_res_used = 0;
+	wpa_s->bss_update_generation = 0;
+	wpa_s->bss_update_added = 0;
+	wpa_s->bss_update_changed = 0;
+	wpa_s->bss_update_unchanged = 0;
 }
 
 
@@ -882,8 +1106,15 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 			int new_scan)
 {
 	struct wpa_bss *bss, *n;
+	unsigned int expired = 0;
 
 	os_get_reltime(&wpa_s->last_scan);
+	/* Entries updated outside update rounds have no known generation */
+	wpa_s->bss_update_generation = 0;
+	wpa_dbg(wpa_s, MSG_DEBUG,
+		"BSS: Scan result update %u: %u added, %u changed, %u unchanged",
+		wpa_s->bss_update_idx, wpa_s->bss_update_added,
+		wpa_s->bss_update_changed, wpa_s->bss_update_unchanged);
 	if ((info && info->aborted) || !new_scan)
 		return; /* do not expire entries without new scan */
 
@@ -897,11 +1128,13 @@ void wpa_bss_update_end(struct wpa_supplicant *wpa_s, struct scan_info *info,
 		if (bss->scan_miss_count >=
 		    wpa_s->conf->bss_expiration_scan_count) {
 			wpa_bss_remove(wpa_s, bss, "no match in scan");
+			expired++;
 		}
 	}
 
-	wpa_printf(MSG_DEBUG, "BSS: last_scan_res_used=%u/%u",
-		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size);
+	wpa_printf(MSG_DEBUG, "BSS: last_scan_res_used=%u/%u expired=%u",
+		   wpa_s->last_scan_res_used, wpa_s->last_scan_res_size,
+		   expired);
 }
 
 
@@ -1104,7 +1337,14 @@ struct wpa_bss * wpa_bss_get_id_range(struct wpa_supplicant *wpa_s,
  */
 const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie)
 {
-	return get_ie((const u8 *) (bss + 1), bss->ie_len, ie);
+	const struct wpa_bss_ie_index *idx = wpa_bss_get_ie_index(bss);
+
+	if (!idx)
+		return get_ie((const u8 *) (bss + 1), bss->ie_len, ie);
+	if (!(idx->eid.present[ie / 32] & BIT(ie % 32)))
+		return NULL;
+	return (const u8 *) (bss + 1) +
+		idx->eid.offset[wpa_bss_ie_map_rank(&idx->eid, ie)];
 }
 
 
@@ -1119,8 +1359,20 @@ const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie)
  */
 const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type)
 {
+	const struct wpa_bss_ie_index *idx = wpa_bss_get_ie_index(bss);
 	const u8 *end, *pos;
 
+	if (idx) {
+		unsigned int i;
+
+		for (i = 0; i < idx->num_vendor; i++) {
+			if (idx->vendor[i].type == vendor_type)
+				return (const u8 *) (bss + 1) +
+					idx->vendor[i].offset;
+		}
+		return NULL;
+	}
+
 	pos = (const u8 *) (bss + 1);
 	end = pos + bss->ie_len;
 
@@ -72,6 +72,8 @@ struct wpa_bss {
 	unsigned int scan_miss_count;
 	/** Index of the last scan update */
 	unsigned int last_update_idx;
+	/** Driver BSS table generation at the last update (0 = unknown) */
+	unsigned int drv_generation;
 	/** Information flags about the BSS/IBSS (WPA_BSS_*) */
 	unsigned int flags;
 	/** BSSID */
@@ -104,6 +106,8 @@ struct wpa_bss {
 	int snr;
 	/** ANQP data */
 	struct wpa_bss_anqp *anqp;
+	/** Index of the elements in the IEs; built on first lookup */
+	struct wpa_bss_ie_index *ie_index;
 	/** Length of the following IE field in octets (from Probe Response) */
 	size_t ie_len;
 	/** Length of the following Beacon IE field in octets */
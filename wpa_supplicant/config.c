@@ -60,6 +60,79 @@ struct parse_data {
 };
 
 
+/*
+ * Hash index for configuration field names. The field tables below are
+ * constant for a given build, so the index is built once on first use and
+ * each lookup is then a single hash computation followed by (almost always)
+ * one string comparison instead of a linear scan through the whole table.
+ * Open addressing with linear probing is used; the table is sized to stay
+ * well below half full with the current field tables.
+ */
+#define CONFIG_FIELD_INDEX_SIZE 1024
+
+struct config_field_index {
+	int built;
+	/* ssid_fields[]/global_fields[] index + 1; 0 = empty slot */
+	u16 slot[CONFIG_FIELD_INDEX_SIZE];
+};
+
+
+static unsigned int config_field_hash(const char *name, size_t len)
+{
+	unsigned int hash = 2166136261U;
+
+	/* FNV-1a */
+	while (len--) {
+		hash ^= (u8) *name++;
+		hash *= 16777619U;
+	}
+	return hash & (CONFIG_FIELD_INDEX_SIZE - 1);
+}
+
+
+static void config_field_index_build(struct config_field_index *idx,
+				     size_t num,
+				     const char * (*field_name)(size_t i))
+{
+	size_t i;
+
+	os_memset(idx->slot, 0, sizeof(idx->slot));
+	for (i = 0; i < num && i < CONFIG_FIELD_INDEX_SIZE - 1; i++) {
+		const char *name = field_name(i);
+		unsigned int pos = config_field_hash(name, os_strlen(name));
+
+		while (idx->slot[pos])
+			pos = (pos + 1) & (CONFIG_FIELD_INDEX_SIZE - 1);
+		idx->slot[pos] = i + 1;
+	}
+	idx->built = 1;
+}
+
+
+/* Returns the table index of the field called var[0..len-1] or -1 */
+static int config_field_index_find(struct config_field_index *idx,
+				   size_t num,
+				   const char * (*field_name)(size_t i),
+				   const char *var, size_t len)
+{
+	unsigned int pos;
+
+	if (!idx->built)
+		config_field_index_build(idx, num, field_name);
+
+	pos = config_field_hash(var, len);
+	while (idx->slot[pos]) {
+		const char *name = field_name(idx->slot[pos] - 1);
+
+		if (os_strncmp(name, var, len) == 0 && name[len] == '\0')
+			return idx->slot[pos] - 1;
+		pos = (pos + 1) & (CONFIG_FIELD_INDEX_SIZE - 1);
+	}
+
+	return -1;
+}
+
+
 static int wpa_config_parse_str(const struct parse_data *data,
 				struct wpa_ssid *ssid,
 				int line, const char *value)
@@ -2427,6 +2500,26 @@ static const struct parse_data ssid_fields[] = {
 #undef FUNC_KEY
 #define NUM_SSID_FIELDS ARRAY_SIZE(ssid_fields)
 
+static struct config_field_index ssid_field_index;
+
+
+static const char * ssid_field_name(size_t i)
+{
+	return ssid_fields[i].name;
+}
+
+
+static const struct parse_data * ssid_field_find(const char *var)
+{
+	int i;
+
+	i = config_field_index_find(&ssid_field_index, NUM_SSID_FIELDS,
+				    ssid_field_name, var, os_strlen(var));
+	if (i < 0)
+		return NULL;
+	return &ssid_fields[i];
+}
+
 
 /**
  * wpa_config_add_prio_network - Add a network to priority lists
@@ -2600,6 +2693,9 @@ void wpa_config_free_ssid(struct wpa_ssid *ssid)
 #ifdef CONFIG_HS20
 	os_free(ssid->roaming_consortium_selection);
 #endif /* CONFIG_HS20 */
+#ifdef CONFIG_SCAN_LEARN
+	os_free(ssid->learned_freqs);
+#endif /* CONFIG_SCAN_LEARN */
 	os_free(ssid->dpp_connector);
 	bin_clear_free(ssid->dpp_netaccesskey, ssid->dpp_netaccesskey_len);
 	os_free(ssid->dpp_csign);
@@ -2928,32 +3024,27 @@ void wpa_config_set_network_defaults(struct wpa_ssid *ssid)
 int wpa_config_set(struct wpa_ssid *ssid, const char *var, const char *value,
 		   int line)
 {
-	size_t i;
-	int ret = 0;
+	const struct parse_data *field;
+	int ret;
 
 	if (ssid == NULL || var == NULL || value == NULL)
 		return -1;
 
-	for (i = 0; i < NUM_SSID_FIELDS; i++) {
-		const struct parse_data *field = &ssid_fields[i];
-		if (os_strcmp(var, field->name) != 0)
-			continue;
-
-		ret = field->parser(field, ssid, line, value);
-		if (ret < 0) {
-			if (line) {
-				wpa_printf(MSG_ERROR, "Line %d: failed to "
-					   "parse %s '%s'.", line, var, value);
-			}
-			ret = -1;
-		}
-		break;
-	}
-	if (i == NUM_SSID_FIELDS) {
+	field = ssid_field_find(var);
+	if (field == NULL) {
 		if (line) {
 			wpa_printf(MSG_ERROR, "Line %d: unknown network field "
 				   "'%s'.", line, var);
 		}
+		return -1;
+	}
+
+	ret = field->parser(field, ssid, line, value);
+	if (ret < 0) {
+		if (line) {
+			wpa_printf(MSG_ERROR, "Line %d: failed to "
+				   "parse %s '%s'.", line, var, value);
+		}
 		ret = -1;
 	}
 
@@ -3062,29 +3153,26 @@ err:
  */
 char * wpa_config_get(struct wpa_ssid *ssid, const char *var)
 {
-	size_t i;
+	const struct parse_data *field;
+	char *ret;
 
 	if (ssid == NULL || var == NULL)
 		return NULL;
 
-	for (i = 0; i < NUM_SSID_FIELDS; i++) {
-		const struct parse_data *field = &ssid_fields[i];
-		if (os_strcmp(var, field->name) == 0) {
-			char *ret = field->writer(field, ssid);
-
-			if (ret && has_newline(ret)) {
-				wpa_printf(MSG_ERROR,
-					   "Found newline in value for %s; not returning it",
-					   var);
-				os_free(ret);
-				ret = NULL;
-			}
+	field = ssid_field_find(var);
+	if (field == NULL)
+		return NULL;
 
-			return ret;
-		}
+	ret = field->writer(field, ssid);
+	if (ret && has_newline(ret)) {
+		wpa_printf(MSG_ERROR,
+			   "Found newline in value for %s; not returning it",
+			   var);
+		os_free(ret);
+		ret = NULL;
 	}
 
-	return NULL;
+	return ret;
 }
 
 
@@ -3106,32 +3194,30 @@ char * wpa_config_get(struct wpa_ssid *ssid, const char *var)
  */
 char * wpa_config_get_no_key(struct wpa_ssid *ssid, const char *var)
 {
-	size_t i;
+	const struct parse_data *field;
+	char *res;
 
 	if (ssid == NULL || var == NULL)
 		return NULL;
 
-	for (i = 0; i < NUM_SSID_FIELDS; i++) {
-		const struct parse_data *field = &ssid_fields[i];
-		if (os_strcmp(var, field->name) == 0) {
-			char *res = field->writer(field, ssid);
-			if (field->key_data) {
-				if (res && res[0]) {
-					wpa_printf(MSG_DEBUG, "Do not allow "
-						   "key_data field to be "
-						   "exposed");
-					str_clear_free(res);
-					return os_strdup("*");
-				}
+	field = ssid_field_find(var);
+	if (field == NULL)
+		return NULL;
 
-				os_free(res);
-				return NULL;
-			}
-			return res;
+	res = field->writer(field, ssid);
+	if (field->key_data) {
+		if (res && res[0]) {
+			wpa_printf(MSG_DEBUG, "Do not allow "
+				   "key_data field to be "
+				   "exposed");
+			str_clear_free(res);
+			return os_strdup("*");
 		}
-	}
 
-	return NULL;
+		os_free(res);
+		return NULL;
+	}
+	return res;
 }
 #endif /* NO_CONFIG_WRITE */
 
@@ -4834,6 +4920,7 @@ static const struct global_parse_data global_fields[] = {
 	{ INT(scan_cur_freq), 0 },
 	{ INT(sched_scan_interval), 0 },
 	{ INT(sched_scan_start_delay), 0 },
+	{ INT(sched_scan_learn), 0 },
 	{ INT(tdls_external_control), 0},
 	{ STR(osu_dir), 0 },
 	{ STR(wowlan_triggers), CFG_CHANGED_WOWLAN_TRIGGERS },
@@ -4881,6 +4968,27 @@ static const struct global_parse_data global_fields[] = {
 #undef IPV4
 #define NUM_GLOBAL_FIELDS ARRAY_SIZE(global_fields)
 
+static struct config_field_index global_field_index;
+
+
+static const char * global_field_name(size_t i)
+{
+	return global_fields[i].name;
+}
+
+
+static const struct global_parse_data *
+global_field_find(const char *name, size_t len)
+{
+	int i;
+
+	i = config_field_index_find(&global_field_index, NUM_GLOBAL_FIELDS,
+				    global_field_name, name, len);
+	if (i < 0)
+		return NULL;
+	return &global_fields[i];
+}
+
 
 int wpa_config_dump_values(struct wpa_config *config, char *buf, size_t buflen)
 {
@@ -4909,20 +5017,13 @@ int wpa_config_dump_values(struct wpa_config *config, char *buf, size_t buflen)
 int wpa_config_get_value(const char *name, struct wpa_config *config,
 			 char *buf, size_t buflen)
 {
-	size_t i;
-
-	for (i = 0; i < NUM_GLOBAL_FIELDS; i++) {
-		const struct global_parse_data *field = &global_fields[i];
+	const struct global_parse_data *field;
 
-		if (os_strcmp(name, field->name) != 0)
-			continue;
-		if (!field->get)
-			break;
-		return field->get(name, config, (long) field->param1,
-				  buf, buflen, 0);
-	}
+	field = global_field_find(name, os_strlen(name));
+	if (!field || !field->get)
+		return -1;
 
-	return -1;
+	return field->get(name, config, (long) field->param1, buf, buflen, 0);
 }
 
 
@@ -4945,17 +5046,15 @@ const char * wpa_config_get_global_field_name(unsigned int i, int *no_var)
 
 int wpa_config_process_global(struct wpa_config *config, char *pos, int line)
 {
-	size_t i;
+	const struct global_parse_data *field = NULL;
+	const char *eq;
 	int ret = 0;
 
-	for (i = 0; i < NUM_GLOBAL_FIELDS; i++) {
-		const struct global_parse_data *field = &global_fields[i];
-		size_t flen = os_strlen(field->name);
-		if (os_strncmp(pos, field->name, flen) != 0 ||
-		    pos[flen] != '=')
-			continue;
-
-		if (field->parser(field, config, line, pos + flen + 1)) {
+	eq = os_strchr(pos, '=');
+	if (eq)
+		field = global_field_find(pos, eq - pos);
+	if (field) {
+		if (field->parser(field, config, line, eq + 1)) {
 			wpa_printf(MSG_ERROR, "Line %d: failed to "
 				   "parse '%s'.", line, pos);
 			ret = -1;
@@ -4963,9 +5062,7 @@ int wpa_config_process_global(struct wpa_config *config, char *pos, int line)
 		if (field->changed_flag == CFG_CHANGED_NFC_PASSWORD_TOKEN)
 			config->wps_nfc_pw_from_config = 1;
 		config->changed_parameters |= field->changed_flag;
-		break;
-	}
-	if (i == NUM_GLOBAL_FIELDS) {
+	} else {
 #ifdef CONFIG_AP
 		if (os_strncmp(pos, "wmm_ac_", 7) == 0) {
 			char *tmp = os_strchr(pos, '=');
@@ -1213,6 +1213,17 @@ struct wpa_config {
 	 */
 	unsigned int sched_scan_start_delay;
 
+	/**
+	 * sched_scan_learn - Limit scheduled scans to learned channels
+	 *
+	 * Number of scheduled scan intervals to scan only the channels on which
+	 * the enabled networks have been seen before (if known for all of
+	 * them) before running a full channel scheduled scan again. 0 (default)
+	 * disables this. This requires wpa_supplicant to be built with
+	 * CONFIG_SCAN_LEARN=y.
+	 */
+	unsigned int sched_scan_learn;
+
 	/**
 	 * tdls_external_control - External control for TDLS setup requests
 	 *
@@ -11,15 +11,18 @@
  */
 
 #include "includes.h"
-#ifdef ANDROID
+#if defined(ANDROID) || defined(CONFIG_PSK_CACHE)
 #include <sys/stat.h>
-#endif /* ANDROID */
+#endif /* ANDROID || CONFIG_PSK_CACHE */
 
 #include "common.h"
 #include "config.h"
 #include "base64.h"
 #include "uuid.h"
+#include "crypto/crypto.h"
+#include "crypto/sha256.h"
 #include "common/ieee802_1x_defs.h"
+#include "common/wpa_common.h"
 #include "p2p/p2p.h"
 #include "eap_peer/eap_methods.h"
 #include "eap_peer/eap.h"
@@ -124,7 +127,283 @@ static char * wpa_config_get_line(char *s, int size, FILE *stream, int *line,
 }
 
 
-static int wpa_config_validate_network(struct wpa_ssid *ssid, int line)
+#ifdef CONFIG_PSK_CACHE
+
+/*
+ * PSK cache
+ *
+ * Deriving the PSK from a passphrase takes 4096 iterations of PBKDF2-SHA1,
+ * which dominates the time needed to read a configuration file with a large
+ * number of passphrase networks. The derived PSKs are stored in a binary
+ * sidecar file (<config file>.psk) that is bound to the exact contents of the
+ * text configuration file. The cache is ignored (and rebuilt) whenever the
+ * text file has been modified or the cache file itself is corrupted, so the
+ * text file remains the only authoritative source of configuration.
+ *
+ * File format (all integers in little endian byte order):
+ * magic (8) | SHA256(text file) | u32 number of records | records |
+ * SHA256(all preceding octets)
+ * Record: u8 ssid_len | ssid | SHA256(passphrase) | PSK (PMK_LEN)
+ */
+
+#define PSK_CACHE_MAGIC "WPAPSKC1"
+#define PSK_CACHE_MAGIC_LEN 8
+
+struct psk_cache {
+	u8 *buf;
+	size_t len;
+	const u8 *records;
+	const u8 *end;
+	const u8 *next; /* search start; cache is usually read in order */
+	unsigned int hits;
+	unsigned int misses;
+};
+
+
+static char * psk_cache_name(const char *name)
+{
+	size_t len = os_strlen(name) + 5;
+	char *cache_name;
+
+	cache_name = os_malloc(len);
+	if (cache_name)
+		os_snprintf(cache_name, len, "%s.psk", name);
+	return cache_name;
+}
+
+
+static int psk_cache_file_hash(const char *name, u8 *hash)
+{
+	char *buf;
+	size_t len;
+	const u8 *addr[1];
+	int res;
+
+	buf = os_readfile(name, &len);
+	if (!buf)
+		return -1;
+	addr[0] = (const u8 *) buf;
+	res = sha256_vector(1, addr, &len, hash);
+	bin_clear_free(buf, len);
+	return res;
+}
+
+
+static void psk_cache_load(struct psk_cache *cache, const char *name)
+{
+	char *cache_name;
+	u8 hash[SHA256_MAC_LEN];
+	const u8 *pos, *end, *addr[1];
+	size_t len;
+	u32 num;
+
+	os_memset(cache, 0, sizeof(*cache));
+	cache_name = psk_cache_name(name);
+	if (!cache_name)
+		return;
+	cache->buf = (u8 *) os_readfile(cache_name, &cache->len);
+	os_free(cache_name);
+	if (!cache->buf)
+		return;
+
+	if (cache->len < PSK_CACHE_MAGIC_LEN + 2 * SHA256_MAC_LEN + 4 ||
+	    os_memcmp(cache->buf, PSK_CACHE_MAGIC, PSK_CACHE_MAGIC_LEN) != 0)
+		goto invalid;
+
+	len = cache->len - SHA256_MAC_LEN;
+	addr[0] = cache->buf;
+	if (sha256_vector(1, addr, &len, hash) < 0 ||
+	    os_memcmp_const(hash, cache->buf + len, SHA256_MAC_LEN) != 0)
+		goto invalid;
+
+	if (psk_cache_file_hash(name, hash) < 0 ||
+	    os_memcmp(hash, cache->buf + PSK_CACHE_MAGIC_LEN,
+		      SHA256_MAC_LEN) != 0) {
+		wpa_printf(MSG_DEBUG,
+			   "PSK cache for '%s' is stale - ignore it", name);
+		goto fail;
+	}
+
+	pos = cache->buf + PSK_CACHE_MAGIC_LEN + SHA256_MAC_LEN;
+	end = cache->buf + len;
+	num = WPA_GET_LE32(pos);
+	pos += 4;
+	cache->records = pos;
+	while (num--) {
+		if (end - pos < 1 || end - pos < 1 + pos[0] + SHA256_MAC_LEN +
+		    PMK_LEN || pos[0] > SSID_MAX_LEN)
+			goto invalid;
+		pos += 1 + pos[0] + SHA256_MAC_LEN + PMK_LEN;
+	}
+	if (pos != end)
+		goto invalid;
+	cache->end = end;
+	cache->next = cache->records;
+	return;
+
+invalid:
+	wpa_printf(MSG_DEBUG, "PSK cache for '%s' is invalid - ignore it",
+		   name);
+fail:
+	bin_clear_free(cache->buf, cache->len);
+	cache->buf = NULL;
+	cache->len = 0;
+}
+
+
+static void psk_cache_deinit(struct psk_cache *cache)
+{
+	bin_clear_free(cache->buf, cache->len);
+	cache->buf = NULL;
+}
+
+
+static int psk_cache_match(const u8 *pos, const struct wpa_ssid *ssid,
+			   const u8 *pw_hash)
+{
+	return pos[0] == ssid->ssid_len &&
+		os_memcmp(pos + 1, ssid->ssid, ssid->ssid_len) == 0 &&
+		os_memcmp_const(pos + 1 + pos[0], pw_hash,
+				SHA256_MAC_LEN) == 0;
+}
+
+
+static int psk_cache_get(struct psk_cache *cache, struct wpa_ssid *ssid)
+{
+	u8 pw_hash[SHA256_MAC_LEN];
+	const u8 *addr[1], *pos, *found = NULL;
+	size_t len;
+
+	if (!cache || !cache->end)
+		goto miss;
+
+	addr[0] = (const u8 *) ssid->passphrase;
+	len = os_strlen(ssid->passphrase);
+	if (sha256_vector(1, addr, &len, pw_hash) < 0)
+		goto miss;
+
+	for (pos = cache->next; !found && pos < cache->end;
+	     pos += 1 + pos[0] + SHA256_MAC_LEN + PMK_LEN) {
+		if (psk_cache_match(pos, ssid, pw_hash))
+			found = pos;
+	}
+	for (pos = cache->records; !found && pos < cache->next;
+	     pos += 1 + pos[0] + SHA256_MAC_LEN + PMK_LEN) {
+		if (psk_cache_match(pos, ssid, pw_hash))
+			found = pos;
+	}
+	os_memset(pw_hash, 0, sizeof(pw_hash));
+	if (!found)
+		goto miss;
+
+	os_memcpy(ssid->psk, found + 1 + found[0] + SHA256_MAC_LEN, PMK_LEN);
+	ssid->psk_set = 1;
+	cache->next = found + 1 + found[0] + SHA256_MAC_LEN + PMK_LEN;
+	cache->hits++;
+	return 0;
+
+miss:
+	if (cache)
+		cache->misses++;
+	return -1;
+}
+
+
+static int psk_cache_network(const struct wpa_ssid *ssid)
+{
+	return ssid->passphrase && ssid->psk_set && !ssid->mem_only_psk &&
+		!ssid->temporary && ssid->key_mgmt != WPA_KEY_MGMT_WPS &&
+		ssid->ssid_len <= SSID_MAX_LEN;
+}
+
+
+static void psk_cache_save(const char *name, struct wpa_config *config)
+{
+	struct wpabuf *buf;
+	struct wpa_ssid *ssid;
+	u8 hash[SHA256_MAC_LEN];
+	const u8 *addr[1];
+	size_t len;
+	char *cache_name = NULL, *tmp_name = NULL;
+	FILE *f = NULL;
+	u32 num = 0;
+	int ok = 0;
+
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
+		if (psk_cache_network(ssid))
+			num++;
+	}
+
+	buf = wpabuf_alloc(PSK_CACHE_MAGIC_LEN + 2 * SHA256_MAC_LEN + 4 +
+			   num * (1 + SSID_MAX_LEN + SHA256_MAC_LEN + PMK_LEN));
+	cache_name = psk_cache_name(name);
+	tmp_name = cache_name ? psk_cache_name(cache_name) : NULL;
+	if (!buf || !tmp_name || psk_cache_file_hash(name, hash) < 0)
+		goto out;
+
+	wpabuf_put_data(buf, PSK_CACHE_MAGIC, PSK_CACHE_MAGIC_LEN);
+	wpabuf_put_data(buf, hash, SHA256_MAC_LEN);
+	wpabuf_put_le32(buf, num);
+	for (ssid = config->ssid; ssid; ssid = ssid->next) {
+		if (!psk_cache_network(ssid))
+			continue;
+		wpabuf_put_u8(buf, ssid->ssid_len);
+		wpabuf_put_data(buf, ssid->ssid, ssid->ssid_len);
+		addr[0] = (const u8 *) ssid->passphrase;
+		len = os_strlen(ssid->passphrase);
+		if (sha256_vector(1, addr, &len,
+				  wpabuf_put(buf, SHA256_MAC_LEN)) < 0)
+			goto out;
+		wpabuf_put_data(buf, ssid->psk, PMK_LEN);
+	}
+	addr[0] = wpabuf_head(buf);
+	len = wpabuf_len(buf);
+	if (sha256_vector(1, addr, &len, hash) < 0)
+		goto out;
+	wpabuf_put_data(buf, hash, SHA256_MAC_LEN);
+
+	f = fopen(tmp_name, "wb");
+	if (!f)
+		goto out;
+#ifndef CONFIG_NATIVE_WINDOWS
+	if (chmod(tmp_name, S_IRUSR | S_IWUSR) != 0)
+		goto out;
+#endif /* CONFIG_NATIVE_WINDOWS */
+	if (fwrite(wpabuf_head(buf), wpabuf_len(buf), 1, f) != 1)
+		goto out;
+	os_fdatasync(f);
+	fclose(f);
+	f = NULL;
+	if (rename(tmp_name, cache_name) == 0)
+		ok = 1;
+
+out:
+	if (f)
+		fclose(f);
+	if (!ok && tmp_name)
+		unlink(tmp_name);
+	wpa_printf(MSG_DEBUG, "PSK cache '%s' (%u entries) %s",
+		   cache_name ? cache_name : name, num,
+		   ok ? "written" : "could not be written");
+	wpabuf_clear_free(buf);
+	os_free(tmp_name);
+	os_free(cache_name);
+}
+
+#else /* CONFIG_PSK_CACHE */
+
+struct psk_cache;
+
+static int psk_cache_get(struct psk_cache *cache, struct wpa_ssid *ssid)
+{
+	return -1;
+}
+
+#endif /* CONFIG_PSK_CACHE */
+
+
+static int wpa_config_validate_network(struct wpa_ssid *ssid, int line,
+				       struct psk_cache *cache)
 {
 	int errors = 0;
 
@@ -134,7 +413,8 @@ static int wpa_config_validate_network(struct wpa_ssid *ssid, int line)
 				   "passphrase configured.", line);
 			errors++;
 		}
-		wpa_config_update_psk(ssid);
+		if (psk_cache_get(cache, ssid) < 0)
+			wpa_config_update_psk(ssid);
 	}
 
 	if (ssid->disabled == 2)
@@ -173,7 +453,8 @@ static int wpa_config_validate_network(struct wpa_ssid *ssid, int line)
 }
 
 
-static struct wpa_ssid * wpa_config_read_network(FILE *f, int *line, int id)
+static struct wpa_ssid * wpa_config_read_network(FILE *f, int *line, int id,
+						 struct psk_cache *cache)
 {
 	struct wpa_ssid *ssid;
 	int errors = 0, end = 0;
@@ -223,7 +504,7 @@ static struct wpa_ssid * wpa_config_read_network(FILE *f, int *line, int id)
 		errors++;
 	}
 
-	errors += wpa_config_validate_network(ssid, *line);
+	errors += wpa_config_validate_network(ssid, *line, cache);
 
 	if (errors) {
 		wpa_config_free_ssid(ssid);
@@ -383,6 +664,12 @@ struct wpa_config * wpa_config_read(const char *name, struct wpa_config *cfgp)
 	struct wpa_config *config;
 	int id = 0;
 	int cred_id = 0;
+#ifdef CONFIG_PSK_CACHE
+	struct psk_cache psk_cache;
+	struct psk_cache *cache = &psk_cache;
+#else /* CONFIG_PSK_CACHE */
+	struct psk_cache *cache = NULL;
+#endif /* CONFIG_PSK_CACHE */
 
 	if (name == NULL)
 		return NULL;
@@ -412,9 +699,13 @@ struct wpa_config * wpa_config_read(const char *name, struct wpa_config *cfgp)
 		return NULL;
 	}
 
+#ifdef CONFIG_PSK_CACHE
+	psk_cache_load(cache, name);
+#endif /* CONFIG_PSK_CACHE */
+
 	while (wpa_config_get_line(buf, sizeof(buf), f, &line, &pos)) {
 		if (os_strcmp(pos, "network={") == 0) {
-			ssid = wpa_config_read_network(f, &line, id++);
+			ssid = wpa_config_read_network(f, &line, id++, cache);
 			if (ssid == NULL) {
 				wpa_printf(MSG_ERROR, "Line %d: failed to "
 					   "parse network block.", line);
@@ -472,6 +763,14 @@ struct wpa_config * wpa_config_read(const char *name, struct wpa_config *cfgp)
 	wpa_config_debug_dump_networks(config);
 	config->cred = cred_head;
 
+#ifdef CONFIG_PSK_CACHE
+	wpa_printf(MSG_DEBUG, "PSK cache: %u hits, %u misses",
+		   cache->hits, cache->misses);
+	if (cache->misses && !errors)
+		psk_cache_save(name, config);
+	psk_cache_deinit(cache);
+#endif /* CONFIG_PSK_CACHE */
+
 #ifndef WPA_IGNORE_CONFIG_ERRORS
 	if (errors) {
 		if (config != cfgp)
@@ -1424,6 +1723,9 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 		fprintf(f, "sched_scan_start_delay=%u\n",
 			config->sched_scan_start_delay);
 
+	if (config->sched_scan_learn)
+		fprintf(f, "sched_scan_learn=%u\n", config->sched_scan_learn);
+
 	if (config->external_sim)
 		fprintf(f, "external_sim=%d\n", config->external_sim);
 
@@ -1553,33 +1855,16 @@ static void wpa_config_write_global(FILE *f, struct wpa_config *config)
 #endif /* CONFIG_NO_CONFIG_WRITE */
 
 
-int wpa_config_write(const char *name, struct wpa_config *config)
-{
 #ifndef CONFIG_NO_CONFIG_WRITE
-	FILE *f;
+
+static int wpa_config_write_contents(FILE *f, struct wpa_config *config)
+{
 	struct wpa_ssid *ssid;
 	struct wpa_cred *cred;
 #ifndef CONFIG_NO_CONFIG_BLOBS
 	struct wpa_config_blob *blob;
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 	int ret = 0;
-	const char *orig_name = name;
-	int tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
-	char *tmp_name = os_malloc(tmp_len);
-
-	if (tmp_name) {
-		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
-		name = tmp_name;
-	}
-
-	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
-
-	f = fopen(name, "w");
-	if (f == NULL) {
-		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
-		os_free(tmp_name);
-		return -1;
-	}
 
 	wpa_config_write_global(f, config);
 
@@ -1610,11 +1895,124 @@ int wpa_config_write(const char *name, struct wpa_config *config)
 	}
 #endif /* CONFIG_NO_CONFIG_BLOBS */
 
-	os_fdatasync(f);
+	return ret;
+}
 
-	fclose(f);
 
+/* The buffer is allocated by open_memstream() and not with os_malloc() */
+static void wpa_config_buf_free(char *buf, size_t len)
+{
+	if (buf) {
+		os_memset(buf, 0, len);
+		free(buf);
+	}
+}
+
+
+#ifndef _WIN32
+/*
+ * Build the configuration file contents in memory. Returns 1 if they are
+ * identical to the current configuration file, so that SAVE_CONFIG and other
+ * implicit updates do not write anything to storage when none of the network
+ * blocks or global parameters changed, 0 if the returned buffer needs to be
+ * written, or -1 on failure.
+ */
+static int wpa_config_build(const char *name, struct wpa_config *config,
+			    char **buf, size_t *len)
+{
+	FILE *f;
+	char *old;
+	size_t old_len;
+	int ret;
+
+	*buf = NULL;
+	*len = 0;
+	f = open_memstream(buf, len);
+	if (!f)
+		return -1;
+	ret = wpa_config_write_contents(f, config);
+	if (fclose(f) != 0 || !*buf)
+		ret = -1;
+	if (ret < 0)
+		return -1;
+
+	old = os_readfile(name, &old_len);
+	if (old && old_len == *len && os_memcmp(old, *buf, *len) == 0)
+		ret = 1;
+	bin_clear_free(old, old_len);
+	return ret;
+}
+#endif /* _WIN32 */
+
+#endif /* CONFIG_NO_CONFIG_WRITE */
+
+
+int wpa_config_write(const char *name, struct wpa_config *config)
+{
+#ifndef CONFIG_NO_CONFIG_WRITE
+	FILE *f;
+	int ret = 0;
+	const char *orig_name = name;
+	int tmp_len = os_strlen(name) + 5; /* allow space for .tmp suffix */
+	char *tmp_name;
+	char *buf = NULL;
+	size_t len = 0;
+
+#ifndef _WIN32
+	ret = wpa_config_build(name, config, &buf, &len);
+	if (ret == 1) {
+		wpa_printf(MSG_DEBUG,
+			   "Configuration file '%s' unchanged - not rewritten",
+			   name);
+		wpa_config_buf_free(buf, len);
+		return 0;
+	}
+	if (ret < 0) {
+		wpa_printf(MSG_DEBUG,
+			   "Failed to build configuration for '%s'", name);
+		wpa_config_buf_free(buf, len);
+		return -1;
+	}
+#endif /* _WIN32 */
+
+	tmp_name = os_malloc(tmp_len);
 	if (tmp_name) {
+		os_snprintf(tmp_name, tmp_len, "%s.tmp", name);
+		name = tmp_name;
+	}
+
+	wpa_printf(MSG_DEBUG, "Writing configuration file '%s'", name);
+
+	f = fopen(name, "w");
+	if (f == NULL) {
+		wpa_printf(MSG_DEBUG, "Failed to open '%s' for writing", name);
+		os_free(tmp_name);
+		wpa_config_buf_free(buf, len);
+		return -1;
+	}
+
+	if (buf) {
+		if (fwrite(buf, 1, len, f) != len)
+			ret = -1;
+		wpa_config_buf_free(buf, len);
+	} else {
+		ret = wpa_config_write_contents(f, config);
+	}
+
+	if (fflush(f) != 0 || ferror(f))
+		ret = -1;
+	os_fdatasync(f);
+
+	if (fclose(f) != 0)
+		ret = -1;
+
+	if (tmp_name && ret < 0) {
+		/* Do not replace the configuration file with a partial copy */
+		wpa_printf(MSG_DEBUG, "Failed to write '%s': %s", name,
+			   strerror(errno));
+		unlink(tmp_name);
+		os_free(tmp_name);
+	} else if (tmp_name) {
 		int chmod_ret = 0;
 
 #ifdef ANDROID
@@ -1627,6 +2025,11 @@ int wpa_config_write(const char *name, struct wpa_config *config)
 		os_free(tmp_name);
 	}
 
+#ifdef CONFIG_PSK_CACHE
+	if (ret == 0)
+		psk_cache_save(orig_name, config);
+#endif /* CONFIG_PSK_CACHE */
+
 	wpa_printf(MSG_DEBUG, "Configuration file '%s' written %ssuccessfully",
 		   orig_name, ret ? "un" : "");
 	return ret;
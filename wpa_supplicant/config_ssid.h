@@ -774,6 +774,16 @@ struct wpa_ssid {
 	 */
 	struct os_reltime disabled_until;
 
+#ifdef CONFIG_SCAN_LEARN
+	/**
+	 * learned_freqs - Channels on which this network has been seen
+	 *
+	 * This is maintained by the scan_learn module and not stored in the
+	 * configuration.
+	 */
+	struct scan_learn_hist *learned_freqs;
+#endif /* CONFIG_SCAN_LEARN */
+
 	/**
 	 * parent_cred - Pointer to parent wpa_cred entry
 	 *
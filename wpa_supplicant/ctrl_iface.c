@@ -51,6 +51,7 @@
 #include "interworking.h"
 #include "blacklist.h"
 #include "autoscan.h"
+#include "scan_learn.h"
 #include "wnm_sta.h"
 #include "offchannel.h"
 #include "drivers/driver.h"
@@ -2460,7 +2461,7 @@ static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 	char *pos, *end, *stamp;
 	int ret;
 
-	/* cmd: "LOG_LEVEL [<level>]" */
+	/* cmd: "LOG_LEVEL [<level>|<module>=<level>|<module>=DEFAULT]" */
 	if (*cmd == '\0') {
 		pos = buf;
 		end = buf + buflen;
@@ -2469,9 +2470,11 @@ static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 				  debug_level_str(wpa_debug_level),
 				  wpa_debug_timestamp);
 		if (os_snprintf_error(end - pos, ret))
-			ret = 0;
+			return 0;
+		pos += ret;
+		pos += wpa_debug_module_levels_str(pos, end - pos);
 
-		return ret;
+		return pos - buf;
 	}
 
 	while (*cmd == ' ')
@@ -2485,7 +2488,10 @@ static int wpa_supplicant_ctrl_iface_log_level(struct wpa_supplicant *wpa_s,
 		}
 	}
 
-	if (os_strlen(cmd)) {
+	if (os_strchr(cmd, '=')) {
+		if (wpa_debug_set_module_level(cmd) < 0)
+			return -1;
+	} else if (os_strlen(cmd)) {
 		int level = str_to_debug_level(cmd);
 		if (level < 0)
 			return -1;
@@ -9985,6 +9991,10 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 			wpa_s, buf + 6, reply, reply_size);
 	} else if (os_strcmp(buf, "PMKSA") == 0) {
 		reply_len = wpas_ctrl_iface_pmksa(wpa_s, reply, reply_size);
+#ifdef CONFIG_SCAN_LEARN
+	} else if (os_strcmp(buf, "SCAN_LEARN") == 0) {
+		reply_len = wpas_scan_learn_status(wpa_s, reply, reply_size);
+#endif /* CONFIG_SCAN_LEARN */
 	} else if (os_strcmp(buf, "PMKSA_FLUSH") == 0) {
 		wpas_ctrl_iface_pmksa_flush(wpa_s);
 #ifdef CONFIG_PMKSA_CACHE_EXTERNAL
@@ -4106,7 +4106,7 @@ dbus_bool_t wpas_dbus_getter_sta_rx_packets(
 	if (!sta)
 		return FALSE;
 
-	if (hostapd_drv_read_sta_data(hapd, &data, sta->addr) < 0)
+	if (ap_sta_read_stats(hapd, sta, STA_STATS_CTRL_IFACE, &data) < 0)
 		return FALSE;
 
 	return wpas_dbus_simple_property_getter(iter, DBUS_TYPE_UINT64,
@@ -4145,7 +4145,7 @@ dbus_bool_t wpas_dbus_getter_sta_tx_packets(
 	if (!sta)
 		return FALSE;
 
-	if (hostapd_drv_read_sta_data(hapd, &data, sta->addr) < 0)
+	if (ap_sta_read_stats(hapd, sta, STA_STATS_CTRL_IFACE, &data) < 0)
 		return FALSE;
 
 	return wpas_dbus_simple_property_getter(iter, DBUS_TYPE_UINT64,
@@ -4184,7 +4184,7 @@ dbus_bool_t wpas_dbus_getter_sta_tx_bytes(
 	if (!sta)
 		return FALSE;
 
-	if (hostapd_drv_read_sta_data(hapd, &data, sta->addr) < 0)
+	if (ap_sta_read_stats(hapd, sta, STA_STATS_CTRL_IFACE, &data) < 0)
 		return FALSE;
 
 	return wpas_dbus_simple_property_getter(iter, DBUS_TYPE_UINT64,
@@ -4223,7 +4223,7 @@ dbus_bool_t wpas_dbus_getter_sta_rx_bytes(
 	if (!sta)
 		return FALSE;
 
-	if (hostapd_drv_read_sta_data(hapd, &data, sta->addr) < 0)
+	if (ap_sta_read_stats(hapd, sta, STA_STATS_CTRL_IFACE, &data) < 0)
 		return FALSE;
 
 	return wpas_dbus_simple_property_getter(iter, DBUS_TYPE_UINT64,
@@ -40,6 +40,7 @@
 #include "p2p_supplicant.h"
 #include "bgscan.h"
 #include "autoscan.h"
+#include "scan_learn.h"
 #include "ap.h"
 #include "bss.h"
 #include "scan.h"
@@ -530,9 +531,55 @@ static int wpa_supplicant_match_privacy(struct wpa_bss *bss,
 }
 
 
+/*
+ * Security parameters of a BSS that do not depend on the network block it is
+ * matched against. These are parsed once per BSS per network selection round
+ * instead of once for each configured network.
+ */
+struct wpa_bss_match_info {
+	const u8 *wpa_ie;
+	const u8 *rsn_ie;
+	int wpa_ie_res; /* wpa_parse_wpa_ie() result for wpa_ie */
+	int rsn_ie_res; /* wpa_parse_wpa_ie() result for rsn_ie */
+	struct wpa_ie_data wpa_data;
+	struct wpa_ie_data rsn_data;
+	unsigned int osen:1;
+	unsigned int rsn_osen:1;
+	unsigned int valid:1;
+};
+
+
+static void wpa_bss_match_info_init(struct wpa_bss *bss,
+				    struct wpa_bss_match_info *info)
+{
+	os_memset(info, 0, sizeof(*info));
+
+	info->wpa_ie = wpa_bss_get_vendor_ie(bss, WPA_IE_VENDOR_TYPE);
+	if (info->wpa_ie)
+		info->wpa_ie_res = wpa_parse_wpa_ie(info->wpa_ie,
+						    2 + info->wpa_ie[1],
+						    &info->wpa_data);
+
+	info->rsn_ie = wpa_bss_get_ie(bss, WLAN_EID_RSN);
+	if (info->rsn_ie) {
+		info->rsn_ie_res = wpa_parse_wpa_ie(info->rsn_ie,
+						    2 + info->rsn_ie[1],
+						    &info->rsn_data);
+		if (info->rsn_ie_res == 0 &&
+		    (info->rsn_data.key_mgmt & WPA_KEY_MGMT_OSEN))
+			info->rsn_osen = 1;
+	}
+
+	info->osen = wpa_bss_get_vendor_ie(bss, OSEN_IE_VENDOR_TYPE) != NULL;
+	info->valid = 1;
+}
+
+
 static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 					 struct wpa_ssid *ssid,
-					 struct wpa_bss *bss, int debug_print)
+					 struct wpa_bss *bss,
+					 const struct wpa_bss_match_info *info,
+					 int debug_print)
 {
 	struct wpa_ie_data ie;
 	int proto_match = 0;
@@ -550,16 +597,17 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 		  ssid->wep_key_len[ssid->wep_tx_keyidx] > 0) ||
 		 (ssid->key_mgmt & WPA_KEY_MGMT_IEEE8021X_NO_WPA));
 
-	rsn_ie = wpa_bss_get_ie(bss, WLAN_EID_RSN);
+	rsn_ie = info->rsn_ie;
 	while ((ssid->proto & (WPA_PROTO_RSN | WPA_PROTO_OSEN)) && rsn_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(rsn_ie, 2 + rsn_ie[1], &ie)) {
+		if (info->rsn_ie_res) {
 			if (debug_print)
 				wpa_dbg(wpa_s, MSG_DEBUG,
 					"   skip RSN IE - parse failed");
 			break;
 		}
+		ie = info->rsn_data;
 		if (!ie.has_pairwise)
 			ie.pairwise_cipher = wpa_default_rsn_cipher(bss->freq);
 		if (!ie.has_group)
@@ -657,16 +705,17 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 	}
 #endif /* CONFIG_IEEE80211W */
 
-	wpa_ie = wpa_bss_get_vendor_ie(bss, WPA_IE_VENDOR_TYPE);
+	wpa_ie = info->wpa_ie;
 	while ((ssid->proto & WPA_PROTO_WPA) && wpa_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(wpa_ie, 2 + wpa_ie[1], &ie)) {
+		if (info->wpa_ie_res) {
 			if (debug_print)
 				wpa_dbg(wpa_s, MSG_DEBUG,
 					"   skip WPA IE - parse failed");
 			break;
 		}
+		ie = info->wpa_data;
 
 		if (wep_ok &&
 		    (ie.group_cipher & (WPA_CIPHER_WEP40 | WPA_CIPHER_WEP104)))
@@ -1008,35 +1057,169 @@ static void owe_trans_ssid(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 }
 
 
-struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
-				     int i, struct wpa_bss *bss,
-				     struct wpa_ssid *group,
-				     int only_first_ssid, int debug_print)
+/*
+ * Index of the network blocks in a priority group by SSID. Network blocks with
+ * a specific SSID can only match a BSS with that same SSID, so only the blocks
+ * in the bucket of the BSS SSID and the blocks without an SSID (wildcard
+ * matches for WPS and BSSID-only configuration) need to be checked for each
+ * BSS. Entries are stored in pnext order and each chain is kept in that order
+ * to maintain the selection order within the group.
+ */
+struct wpa_ssid_index_entry {
+	struct wpa_ssid *ssid;
+	int next; /* next entry in the same chain or -1 */
+};
+
+struct wpa_ssid_index {
+	unsigned int num_buckets; /* power of two */
+	int *bucket;
+	int wildcard; /* first network block without an SSID or -1 */
+	struct wpa_ssid_index_entry *entry;
+};
+
+struct wpa_ssid_iter {
+	const struct wpa_ssid_index *idx;
+	int named;
+	int wildcard;
+	struct wpa_ssid *next; /* not using an index */
+	int only_first_ssid;
+};
+
+
+static unsigned int wpa_ssid_index_hash(const u8 *ssid, size_t ssid_len)
+{
+	unsigned int hash = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < ssid_len; i++) {
+		hash ^= ssid[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+
+static void wpa_ssid_index_deinit(struct wpa_ssid_index *idx)
+{
+	os_free(idx->bucket);
+	os_free(idx->entry);
+	os_memset(idx, 0, sizeof(*idx));
+}
+
+
+static int wpa_ssid_index_init(struct wpa_ssid_index *idx,
+			       struct wpa_ssid *group)
+{
+	struct wpa_ssid *ssid;
+	unsigned int num = 0, i;
+
+	os_memset(idx, 0, sizeof(*idx));
+	for (ssid = group; ssid; ssid = ssid->pnext)
+		num++;
+
+	idx->num_buckets = 1;
+	while (idx->num_buckets < num)
+		idx->num_buckets <<= 1;
+	idx->bucket = os_malloc(idx->num_buckets * sizeof(int));
+	idx->entry = os_calloc(num, sizeof(struct wpa_ssid_index_entry));
+	if (!idx->bucket || !idx->entry) {
+		wpa_ssid_index_deinit(idx);
+		return -1;
+	}
+	for (i = 0; i < idx->num_buckets; i++)
+		idx->bucket[i] = -1;
+	idx->wildcard = -1;
+
+	for (i = 0, ssid = group; ssid; ssid = ssid->pnext)
+		idx->entry[i++].ssid = ssid;
+
+	/* Add in reverse order so that each chain ends up in pnext order */
+	while (i-- > 0) {
+		int *head;
+
+		ssid = idx->entry[i].ssid;
+		if (ssid->ssid_len == 0)
+			head = &idx->wildcard;
+		else
+			head = &idx->bucket[wpa_ssid_index_hash(
+					ssid->ssid, ssid->ssid_len) &
+					    (idx->num_buckets - 1)];
+		idx->entry[i].next = *head;
+		*head = i;
+	}
+
+	return 0;
+}
+
+
+static void wpa_ssid_iter_init(struct wpa_ssid_iter *iter,
+			       const struct wpa_ssid_index *idx,
+			       struct wpa_ssid *group, int only_first_ssid,
+			       const u8 *match_ssid, size_t match_ssid_len)
+{
+	os_memset(iter, 0, sizeof(*iter));
+	iter->idx = idx;
+	if (idx) {
+		iter->named = idx->bucket[wpa_ssid_index_hash(
+				match_ssid, match_ssid_len) &
+					  (idx->num_buckets - 1)];
+		iter->wildcard = idx->wildcard;
+	} else {
+		iter->next = group;
+		iter->only_first_ssid = only_first_ssid;
+	}
+}
+
+
+static struct wpa_ssid * wpa_ssid_iter_next(struct wpa_ssid_iter *iter)
+{
+	struct wpa_ssid *ssid;
+	int *pos;
+
+	if (!iter->idx) {
+		ssid = iter->next;
+		if (ssid)
+			iter->next = iter->only_first_ssid ? NULL : ssid->pnext;
+		return ssid;
+	}
+
+	/* Merge the SSID chain and the wildcard chain in pnext order */
+	if (iter->named < 0 && iter->wildcard < 0)
+		return NULL;
+	if (iter->wildcard < 0 ||
+	    (iter->named >= 0 && iter->named < iter->wildcard))
+		pos = &iter->named;
+	else
+		pos = &iter->wildcard;
+	ssid = iter->idx->entry[*pos].ssid;
+	*pos = iter->idx->entry[*pos].next;
+	return ssid;
+}
+
+
+static struct wpa_ssid *
+wpas_scan_res_match(struct wpa_supplicant *wpa_s, int i, struct wpa_bss *bss,
+		    const struct wpa_bss_match_info *info,
+		    struct wpa_ssid *group, const struct wpa_ssid_index *idx,
+		    int only_first_ssid, int debug_print)
 {
 	u8 wpa_ie_len, rsn_ie_len;
 	int wpa;
 	struct wpa_blacklist *e;
 	const u8 *ie;
 	struct wpa_ssid *ssid;
-	int osen, rsn_osen = 0;
+	struct wpa_ssid_iter iter;
+	int osen, rsn_osen;
 #ifdef CONFIG_MBO
 	const u8 *assoc_disallow;
 #endif /* CONFIG_MBO */
 	const u8 *match_ssid;
 	size_t match_ssid_len;
-	struct wpa_ie_data data;
-
-	ie = wpa_bss_get_vendor_ie(bss, WPA_IE_VENDOR_TYPE);
-	wpa_ie_len = ie ? ie[1] : 0;
 
-	ie = wpa_bss_get_ie(bss, WLAN_EID_RSN);
-	rsn_ie_len = ie ? ie[1] : 0;
-	if (ie && wpa_parse_wpa_ie_rsn(ie, 2 + ie[1], &data) == 0 &&
-	    (data.key_mgmt & WPA_KEY_MGMT_OSEN))
-		rsn_osen = 1;
-
-	ie = wpa_bss_get_vendor_ie(bss, OSEN_IE_VENDOR_TYPE);
-	osen = ie != NULL;
+	wpa_ie_len = info->wpa_ie ? info->wpa_ie[1] : 0;
+	rsn_ie_len = info->rsn_ie ? info->rsn_ie[1] : 0;
+	rsn_osen = info->rsn_osen;
+	osen = info->osen;
 
 	if (debug_print) {
 		wpa_dbg(wpa_s, MSG_DEBUG, "%d: " MACSTR
@@ -1101,7 +1284,9 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 
 	wpa = wpa_ie_len > 0 || rsn_ie_len > 0;
 
-	for (ssid = group; ssid; ssid = only_first_ssid ? NULL : ssid->pnext) {
+	wpa_ssid_iter_init(&iter, idx, group, only_first_ssid, match_ssid,
+			   match_ssid_len);
+	while ((ssid = wpa_ssid_iter_next(&iter))) {
 		int check_ssid = wpa ? 1 : (ssid->ssid_len != 0);
 		int res;
 
@@ -1184,7 +1369,7 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 			continue;
 		}
 
-		if (!wpa_supplicant_ssid_bss_match(wpa_s, ssid, bss,
+		if (!wpa_supplicant_ssid_bss_match(wpa_s, ssid, bss, info,
 						   debug_print))
 			continue;
 
@@ -1383,13 +1568,54 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 }
 
 
+struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
+				     int i, struct wpa_bss *bss,
+				     struct wpa_ssid *group,
+				     int only_first_ssid, int debug_print)
+{
+	struct wpa_bss_match_info info;
+
+	wpa_bss_match_info_init(bss, &info);
+	return wpas_scan_res_match(wpa_s, i, bss, &info, group, NULL,
+				   only_first_ssid, debug_print);
+}
+
+
+static const struct wpa_bss_match_info *
+wpa_supplicant_bss_match_info(struct wpa_bss *bss,
+			      struct wpa_bss_match_info *cache,
+			      struct wpa_bss_match_info *tmp, unsigned int i)
+{
+	struct wpa_bss_match_info *info = cache ? &cache[i] : tmp;
+
+	if (!cache || !info->valid)
+		wpa_bss_match_info_init(bss, info);
+	return info;
+}
+
+
 static struct wpa_bss *
 wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 			  struct wpa_ssid *group,
+			  struct wpa_bss_match_info *cache,
 			  struct wpa_ssid **selected_ssid,
 			  int only_first_ssid)
 {
 	unsigned int i;
+	struct wpa_ssid_index idx, *pidx = NULL;
+	struct wpa_bss_match_info tmp;
+	const struct wpa_bss_match_info *info;
+
+	if (!only_first_ssid && wpa_ssid_index_init(&idx, group) == 0) {
+		struct wpa_ssid *ssid;
+
+		pidx = &idx;
+		/* The index skips network blocks with other SSIDs, so check
+		 * for expired temporary disabling here to report re-enabled
+		 * networks as before. */
+		for (ssid = group; ssid; ssid = ssid->pnext)
+			wpas_temp_disabled(wpa_s, ssid);
+	}
 
 	if (wpa_s->current_ssid) {
 		struct wpa_ssid *ssid;
@@ -1399,8 +1625,10 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 		for (i = 0; i < wpa_s->last_scan_res_used; i++) {
 			struct wpa_bss *bss = wpa_s->last_scan_res[i];
 
-			ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						  only_first_ssid, 0);
+			info = wpa_supplicant_bss_match_info(bss, cache, &tmp,
+							     i);
+			ssid = wpas_scan_res_match(wpa_s, i, bss, info, group,
+						   pidx, only_first_ssid, 0);
 			if (ssid != wpa_s->current_ssid)
 				continue;
 			wpa_dbg(wpa_s, MSG_DEBUG, "%u: " MACSTR
@@ -1420,9 +1648,11 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 	for (i = 0; i < wpa_s->last_scan_res_used; i++) {
 		struct wpa_bss *bss = wpa_s->last_scan_res[i];
 
+		info = wpa_supplicant_bss_match_info(bss, cache, &tmp, i);
 		wpa_s->owe_transition_select = 1;
-		*selected_ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						    only_first_ssid, 1);
+		*selected_ssid = wpas_scan_res_match(wpa_s, i, bss, info,
+						     group, pidx,
+						     only_first_ssid, 1);
 		wpa_s->owe_transition_select = 0;
 		if (!*selected_ssid)
 			continue;
@@ -1430,9 +1660,13 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 			" ssid='%s'",
 			MAC2STR(bss->bssid),
 			wpa_ssid_txt(bss->ssid, bss->ssid_len));
+		if (pidx)
+			wpa_ssid_index_deinit(pidx);
 		return bss;
 	}
 
+	if (pidx)
+		wpa_ssid_index_deinit(pidx);
 	return NULL;
 }
 
@@ -1444,11 +1678,16 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 	int prio;
 	struct wpa_ssid *next_ssid = NULL;
 	struct wpa_ssid *ssid;
+	struct wpa_bss_match_info *cache;
 
 	if (wpa_s->last_scan_res == NULL ||
 	    wpa_s->last_scan_res_used == 0)
 		return NULL; /* no scan results from last update */
 
+	/* Parsed BSS security information is shared by all priority groups;
+	 * fall back to parsing it for each match if allocation fails. */
+	cache = os_calloc(wpa_s->last_scan_res_used, sizeof(*cache));
+
 	if (wpa_s->next_ssid) {
 		/* check that next_ssid is still valid */
 		for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
@@ -1464,12 +1703,13 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			if (next_ssid && next_ssid->priority ==
 			    wpa_s->conf->pssid[prio]->priority) {
 				selected = wpa_supplicant_select_bss(
-					wpa_s, next_ssid, selected_ssid, 1);
+					wpa_s, next_ssid, cache, selected_ssid,
+					1);
 				if (selected)
 					break;
 			}
 			selected = wpa_supplicant_select_bss(
-				wpa_s, wpa_s->conf->pssid[prio],
+				wpa_s, wpa_s->conf->pssid[prio], cache,
 				selected_ssid, 0);
 			if (selected)
 				break;
@@ -1485,6 +1725,8 @@ struct wpa_bss * wpa_supplicant_pick_network(struct wpa_supplicant *wpa_s,
 			break;
 	}
 
+	os_free(cache);
+
 	ssid = *selected_ssid;
 	if (selected && ssid && ssid->mem_only_psk && !ssid->psk_set &&
 	    !ssid->passphrase && !ssid->ext_psk) {
@@ -4319,6 +4561,7 @@ void wpa_supplicant_event(void *ctx, enum wpa_event_type event,
 			wpa_s->scan_start_time.usec = 0;
 			wpa_dbg(wpa_s, MSG_DEBUG, "Scan completed in %ld.%06ld seconds",
 				diff.sec, diff.usec);
+			wpas_scan_learn_scan_time(wpa_s, &diff);
 		}
 		if (wpa_supplicant_event_scan_results(wpa_s, data))
 			break; /* interface may have been removed */
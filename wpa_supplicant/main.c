@@ -90,6 +90,11 @@ static void usage(void)
 	       "  -p = driver parameters\n"
 	       "  -P = PID file\n"
 	       "  -q = decrease debugging verbosity (-qq even less)\n"
+#ifdef CONFIG_DEBUG_RING
+	       "  -r = buffer debug output in memory and write it in batches\n"
+	       "  -R = capture debug messages in memory and write them out\n"
+	       "       only when an error is logged\n"
+#endif /* CONFIG_DEBUG_RING */
 #ifdef CONFIG_DEBUG_SYSLOG
 	       "  -s = log output to syslog instead of stdout\n"
 #endif /* CONFIG_DEBUG_SYSLOG */
@@ -201,7 +206,7 @@ int main(int argc, char *argv[])
 
 	for (;;) {
 		c = getopt(argc, argv,
-			   "b:Bc:C:D:de:f:g:G:hi:I:KLMm:No:O:p:P:qsTtuvW");
+			   "b:Bc:C:D:de:f:g:G:hi:I:KLMm:No:O:p:P:qrRsTtuvW");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -282,6 +287,14 @@ int main(int argc, char *argv[])
 		case 'q':
 			params.wpa_debug_level++;
 			break;
+#ifdef CONFIG_DEBUG_RING
+		case 'r':
+			params.wpa_debug_ring = WPA_DEBUG_RING_BUFFERED + 1;
+			break;
+		case 'R':
+			params.wpa_debug_ring = WPA_DEBUG_RING_CAPTURE + 1;
+			break;
+#endif /* CONFIG_DEBUG_RING */
 #ifdef CONFIG_DEBUG_SYSLOG
 		case 's':
 			params.wpa_debug_syslog++;
@@ -23,6 +23,7 @@
 #include "bss.h"
 #include "scan.h"
 #include "mesh.h"
+#include "scan_learn.h"
 
 
 static void wpa_supplicant_gen_assoc_event(struct wpa_supplicant *wpa_s)
@@ -1649,6 +1650,10 @@ scan:
 
 	params.sched_scan_start_delay = wpa_s->conf->sched_scan_start_delay;
 
+	if (scan_params == &params && !ssid && wpa_s->first_sched_scan)
+		wpas_scan_learn_sched_scan(wpa_s, &params,
+					   params.sched_scan_plans[0].interval);
+
 	if (ssid || !wpa_s->first_sched_scan) {
 		wpa_dbg(wpa_s, MSG_DEBUG,
 			"Starting sched scan after %u seconds: interval %u timeout %d",
@@ -1678,6 +1683,7 @@ scan:
 	ret = wpa_supplicant_start_sched_scan(wpa_s, scan_params);
 	wpabuf_free(extra_ie);
 	os_free(params.filter_ssids);
+	os_free(params.freqs);
 	if (ret) {
 		wpa_msg(wpa_s, MSG_WARNING, "Failed to initiate sched scan");
 		if (prev_state != wpa_s->wpa_state)
@@ -1750,6 +1756,7 @@ void wpa_supplicant_cancel_delayed_sched_scan(struct wpa_supplicant *wpa_s)
  */
 void wpa_supplicant_cancel_sched_scan(struct wpa_supplicant *wpa_s)
 {
+	wpas_scan_learn_cancel(wpa_s);
 	if (!wpa_s->sched_scanning)
 		return;
 
@@ -1951,95 +1958,77 @@ struct wpabuf * wpa_scan_get_vendor_ie_multi(const struct wpa_scan_res *res,
  * better. */
 static int wpa_scan_result_compar(const void *a, const void *b)
 {
-#define MIN(a,b) a < b ? a : b
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
-	int wpa_a, wpa_b;
+	const struct wpa_scan_res_key *ka = a;
+	const struct wpa_scan_res_key *kb = b;
 	int snr_a, snr_b, snr_a_full, snr_b_full;
 
 	/* WPA/WPA2 support preferred */
-	wpa_a = wpa_scan_get_vendor_ie(wa, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wa, WLAN_EID_RSN) != NULL;
-	wpa_b = wpa_scan_get_vendor_ie(wb, WPA_IE_VENDOR_TYPE) != NULL ||
-		wpa_scan_get_ie(wb, WLAN_EID_RSN) != NULL;
-
-	if (wpa_b && !wpa_a)
+	if (kb->wpa && !ka->wpa)
 		return 1;
-	if (!wpa_b && wpa_a)
+	if (!kb->wpa && ka->wpa)
 		return -1;
 
 	/* privacy support preferred */
-	if ((wa->caps & IEEE80211_CAP_PRIVACY) == 0 &&
-	    (wb->caps & IEEE80211_CAP_PRIVACY))
+	if (!ka->privacy && kb->privacy)
 		return 1;
-	if ((wa->caps & IEEE80211_CAP_PRIVACY) &&
-	    (wb->caps & IEEE80211_CAP_PRIVACY) == 0)
+	if (ka->privacy && !kb->privacy)
 		return -1;
 
-	if (wa->flags & wb->flags & WPA_SCAN_LEVEL_DBM) {
-		snr_a_full = wa->snr;
-		snr_a = MIN(wa->snr, GREAT_SNR);
-		snr_b_full = wb->snr;
-		snr_b = MIN(wb->snr, GREAT_SNR);
+	if (ka->dbm && kb->dbm) {
+		snr_a_full = ka->snr_full;
+		snr_a = ka->snr;
+		snr_b_full = kb->snr_full;
+		snr_b = kb->snr;
 	} else {
 		/* Level is not in dBm, so we can't calculate
 		 * SNR. Just use raw level (units unknown). */
-		snr_a = snr_a_full = wa->level;
-		snr_b = snr_b_full = wb->level;
+		snr_a = snr_a_full = ka->level;
+		snr_b = snr_b_full = kb->level;
 	}
 
 	/* if SNR is close, decide by max rate or frequency band */
 	if (snr_a && snr_b && abs(snr_b - snr_a) < 7) {
-		if (wa->est_throughput != wb->est_throughput)
-			return (int) wb->est_throughput -
-				(int) wa->est_throughput;
+		if (ka->est_throughput != kb->est_throughput)
+			return (int) kb->est_throughput -
+				(int) ka->est_throughput;
 	}
 	if ((snr_a && snr_b && abs(snr_b - snr_a) < 5) ||
-	    (wa->qual && wb->qual && abs(wb->qual - wa->qual) < 10)) {
-		if (IS_5GHZ(wa->freq) ^ IS_5GHZ(wb->freq))
-			return IS_5GHZ(wa->freq) ? -1 : 1;
+	    (ka->qual && kb->qual && abs(kb->qual - ka->qual) < 10)) {
+		if (ka->band_5ghz ^ kb->band_5ghz)
+			return ka->band_5ghz ? -1 : 1;
 	}
 
 	/* all things being equal, use SNR; if SNRs are
 	 * identical, use quality values since some drivers may only report
 	 * that value and leave the signal level zero */
 	if (snr_b_full == snr_a_full)
-		return wb->qual - wa->qual;
+		return kb->qual - ka->qual;
 	return snr_b_full - snr_a_full;
-#undef MIN
 }
 
 
+const struct wpa_scan_rank_policy wpa_scan_rank_default = {
+	.name = "default",
+	.compar = wpa_scan_result_compar,
+};
+
+
 #ifdef CONFIG_WPS
 /* Compare function for sorting scan results when searching a WPS AP for
  * provisioning. Return >0 if @b is considered better. */
 static int wpa_scan_result_wps_compar(const void *a, const void *b)
 {
-	struct wpa_scan_res **_wa = (void *) a;
-	struct wpa_scan_res **_wb = (void *) b;
-	struct wpa_scan_res *wa = *_wa;
-	struct wpa_scan_res *wb = *_wb;
-	int uses_wps_a, uses_wps_b;
-	struct wpabuf *wps_a, *wps_b;
+	const struct wpa_scan_res_key *ka = a;
+	const struct wpa_scan_res_key *kb = b;
 	int res;
 
-	/* Optimization - check WPS IE existence before allocated memory and
-	 * doing full reassembly. */
-	uses_wps_a = wpa_scan_get_vendor_ie(wa, WPS_IE_VENDOR_TYPE) != NULL;
-	uses_wps_b = wpa_scan_get_vendor_ie(wb, WPS_IE_VENDOR_TYPE) != NULL;
-	if (uses_wps_a && !uses_wps_b)
+	if (ka->wps && !kb->wps)
 		return -1;
-	if (!uses_wps_a && uses_wps_b)
+	if (!ka->wps && kb->wps)
 		return 1;
 
-	if (uses_wps_a && uses_wps_b) {
-		wps_a = wpa_scan_get_vendor_ie_multi(wa, WPS_IE_VENDOR_TYPE);
-		wps_b = wpa_scan_get_vendor_ie_multi(wb, WPS_IE_VENDOR_TYPE);
-		res = wps_ap_priority_compar(wps_a, wps_b);
-		wpabuf_free(wps_a);
-		wpabuf_free(wps_b);
+	if (ka->wps && kb->wps) {
+		res = wps_ap_priority_compar(ka->wps, kb->wps);
 		if (res)
 			return res;
 	}
@@ -2053,13 +2042,75 @@ static int wpa_scan_result_wps_compar(const void *a, const void *b)
 	/* all things being equal, use signal level; if signal levels are
 	 * identical, use quality values since some drivers may only report
 	 * that value and leave the signal level zero */
-	if (wb->level == wa->level)
-		return wb->qual - wa->qual;
-	return wb->level - wa->level;
+	if (kb->level == ka->level)
+		return kb->qual - ka->qual;
+	return kb->level - ka->level;
 }
+
+
+const struct wpa_scan_rank_policy wpa_scan_rank_wps = {
+	.name = "WPS provisioning",
+	.compar = wpa_scan_result_wps_compar,
+	.need_wps_ie = 1,
+};
 #endif /* CONFIG_WPS */
 
 
+/**
+ * wpa_scan_results_sort - Sort scan results based on a ranking policy
+ * @scan_res: Scan results; the res array is reordered, best entry first
+ * @policy: Ranking policy
+ * Returns: 0 on success, -1 on failure (scan results left unsorted)
+ *
+ * Each scan result is parsed once into a struct wpa_scan_res_key and only the
+ * keys are compared while sorting, so the policy compare function does not
+ * need to go through the IEs of the scan results.
+ */
+int wpa_scan_results_sort(struct wpa_scan_results *scan_res,
+			  const struct wpa_scan_rank_policy *policy)
+{
+	struct wpa_scan_res_key *keys;
+	size_t i;
+
+	if (!scan_res->res || scan_res->num < 2)
+		return 0;
+
+	keys = os_calloc(scan_res->num, sizeof(*keys));
+	if (!keys)
+		return -1;
+
+	for (i = 0; i < scan_res->num; i++) {
+		struct wpa_scan_res *r = scan_res->res[i];
+		struct wpa_scan_res_key *key = &keys[i];
+
+		key->res = r;
+		key->snr_full = r->snr;
+		key->snr = r->snr < GREAT_SNR ? r->snr : GREAT_SNR;
+		key->level = r->level;
+		key->qual = r->qual;
+		key->est_throughput = r->est_throughput;
+		key->dbm = !!(r->flags & WPA_SCAN_LEVEL_DBM);
+		key->wpa = wpa_scan_get_vendor_ie(r, WPA_IE_VENDOR_TYPE) ||
+			wpa_scan_get_ie(r, WLAN_EID_RSN);
+		key->privacy = !!(r->caps & IEEE80211_CAP_PRIVACY);
+		key->band_5ghz = IS_5GHZ(r->freq);
+		if (policy->need_wps_ie)
+			key->wps = wpa_scan_get_vendor_ie_multi(
+				r, WPS_IE_VENDOR_TYPE);
+	}
+
+	qsort(keys, scan_res->num, sizeof(*keys), policy->compar);
+
+	for (i = 0; i < scan_res->num; i++) {
+		scan_res->res[i] = keys[i].res;
+		wpabuf_free(keys[i].wps);
+	}
+	os_free(keys);
+
+	return 0;
+}
+
+
 static void dump_scan_res(struct wpa_scan_results *scan_res)
 {
 #ifndef CONFIG_NO_STDOUT_DEBUG
@@ -2142,7 +2193,9 @@ void filter_scan_res(struct wpa_supplicant *wpa_s,
 						      res->res[i]->bssid)) {
 			res->res[j++] = res->res[i];
 		} else {
-			os_free(res->res[i]);
+			/* Arena entries are freed with the results */
+			if (!res->arena)
+				os_free(res->res[i]);
 			res->res[i] = NULL;
 		}
 	}
@@ -2354,7 +2407,7 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 {
 	struct wpa_scan_results *scan_res;
 	size_t i;
-	int (*compar)(const void *, const void *) = wpa_scan_result_compar;
+	const struct wpa_scan_rank_policy *policy = &wpa_scan_rank_default;
 
 	scan_res = wpa_drv_get_scan_results2(wpa_s);
 	if (scan_res == NULL) {
@@ -2381,14 +2434,14 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 	if (wpas_wps_searching(wpa_s)) {
 		wpa_dbg(wpa_s, MSG_DEBUG, "WPS: Order scan results with WPS "
 			"provisioning rules");
-		compar = wpa_scan_result_wps_compar;
+		policy = &wpa_scan_rank_wps;
 	}
 #endif /* CONFIG_WPS */
 
-	if (scan_res->res) {
-		qsort(scan_res->res, scan_res->num,
-		      sizeof(struct wpa_scan_res *), compar);
-	}
+	if (wpa_scan_results_sort(scan_res, policy) < 0)
+		wpa_dbg(wpa_s, MSG_INFO,
+			"Failed to sort scan results using %s ranking policy",
+			policy->name);
 	dump_scan_res(scan_res);
 
 	if (wpa_s->ignore_post_flush_scan_res) {
@@ -2402,10 +2455,13 @@ wpa_supplicant_get_scan_results(struct wpa_supplicant *wpa_s,
 	}
 
 	wpa_bss_update_start(wpa_s);
+	wpa_s->bss_update_generation = scan_res->generation;
 	for (i = 0; i < scan_res->num; i++)
 		wpa_bss_update_scan_res(wpa_s, scan_res->res[i],
 					&scan_res->fetch_time);
 	wpa_bss_update_end(wpa_s, info, new_scan);
+	if (new_scan)
+		wpas_scan_learn_scan_res(wpa_s, info);
 
 	return scan_res;
 }
@@ -60,4 +60,58 @@ void scan_est_throughput(struct wpa_supplicant *wpa_s,
 			 struct wpa_scan_res *res);
 void wpa_supplicant_set_default_scan_ies(struct wpa_supplicant *wpa_s);
 
+/**
+ * struct wpa_scan_res_key - Sort key for ranking scan results
+ * @res: Scan result
+ * @wps: Reassembled WPS IE or %NULL (only with need_wps_ie policies)
+ * @snr: SNR capped to the value that allows full rate operation
+ * @snr_full: SNR
+ * @level: Signal level
+ * @qual: Signal quality
+ * @est_throughput: Estimated throughput in kbps
+ * @dbm: Whether the signal level is in dBm
+ * @wpa: Whether the BSS advertises WPA or RSN
+ * @privacy: Whether the Privacy bit is set in Capability Information
+ * @band_5ghz: Whether the BSS operates on a 5 GHz (or higher) channel
+ */
+struct wpa_scan_res_key {
+	struct wpa_scan_res *res;
+	struct wpabuf *wps;
+	int snr;
+	int snr_full;
+	int level;
+	int qual;
+	unsigned int est_throughput;
+	unsigned int dbm:1;
+	unsigned int wpa:1;
+	unsigned int privacy:1;
+	unsigned int band_5ghz:1;
+};
+
+/**
+ * struct wpa_scan_rank_policy - Scan result ranking policy
+ * @name: Name of the policy for debug prints
+ * @compar: qsort() compare function for two struct wpa_scan_res_key entries;
+ *	returns >0 if the second entry is considered better
+ * @need_wps_ie: Whether the compare function uses wpa_scan_res_key::wps
+ *
+ * This is a fixed table of the ranking rules defined in scan.c rather than a
+ * configurable selection: wpa_supplicant_get_scan_results() uses
+ * wpa_scan_rank_wps while searching for a WPS AP for provisioning and
+ * wpa_scan_rank_default otherwise.
+ */
+struct wpa_scan_rank_policy {
+	const char *name;
+	int (*compar)(const void *a, const void *b);
+	unsigned int need_wps_ie:1;
+};
+
+extern const struct wpa_scan_rank_policy wpa_scan_rank_default;
+#ifdef CONFIG_WPS
+extern const struct wpa_scan_rank_policy wpa_scan_rank_wps;
+#endif /* CONFIG_WPS */
+
+int wpa_scan_results_sort(struct wpa_scan_results *scan_res,
+			  const struct wpa_scan_rank_policy *policy);
+
 #endif /* SCAN_H */
@@ -0,0 +1,396 @@
+/*
+ * WPA Supplicant - Learned channels for scheduled scans
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * The channels on which each configured network has been found in scan
+ * results (and connected to) are tracked in a small per-network history in the
+ * same spirit as bgscan_learn tracks the channels of neighboring BSSes. When
+ * all enabled networks have a history, scheduled scans are limited to the
+ * learned channels, ordered by how often the networks were seen on them, for
+ * sched_scan_learn scan intervals at a time. A full channel scheduled scan is
+ * run in between to find networks that have moved to other channels.
+ *
+ * The number of scans, the number of channels scanned as a proxy for the energy
+ * used for scanning, and the time spent in scans requested by wpa_supplicant
+ * are collected and can be fetched with the SCAN_LEARN control interface
+ * command.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "eloop.h"
+#include "drivers/driver.h"
+#include "config.h"
+#include "wpa_supplicant_i.h"
+#include "bss.h"
+#include "scan.h"
+#include "scan_learn.h"
+
+#define SCAN_LEARN_MAX_FREQS 8
+#define SCAN_LEARN_MAX_HITS 1000
+/* Weight of the channel of a completed connection compared to a scan hit */
+#define SCAN_LEARN_CONNECT_HITS 4
+
+struct scan_learn_freq {
+	int freq;
+	unsigned int hits;
+	struct os_reltime last_seen;
+};
+
+struct scan_learn_hist {
+	struct scan_learn_freq freq[SCAN_LEARN_MAX_FREQS];
+	unsigned int num;
+};
+
+
+static void scan_learn_add(struct wpa_ssid *ssid, int freq, unsigned int hits,
+			   const struct os_reltime *now)
+{
+	struct scan_learn_hist *hist = ssid->learned_freqs;
+	struct scan_learn_freq *entry = NULL;
+	unsigned int i;
+
+	if (!hist) {
+		hist = os_zalloc(sizeof(*hist));
+		if (!hist)
+			return;
+		ssid->learned_freqs = hist;
+	}
+
+	for (i = 0; i < hist->num; i++) {
+		if (hist->freq[i].freq == freq) {
+			entry = &hist->freq[i];
+			break;
+		}
+	}
+
+	if (!entry && hist->num < SCAN_LEARN_MAX_FREQS) {
+		entry = &hist->freq[hist->num++];
+		entry->hits = 0;
+	} else if (!entry) {
+		/* Replace the least used channel; the oldest one on ties */
+		entry = &hist->freq[0];
+		for (i = 1; i < hist->num; i++) {
+			struct scan_learn_freq *f = &hist->freq[i];
+
+			if (f->hits < entry->hits ||
+			    (f->hits == entry->hits &&
+			     os_reltime_before(&f->last_seen,
+					       &entry->last_seen)))
+				entry = f;
+		}
+		entry->hits = 0;
+	}
+
+	entry->freq = freq;
+	entry->hits += hits;
+	entry->last_seen = *now;
+
+	if (entry->hits > SCAN_LEARN_MAX_HITS) {
+		/* Age the history to let recent observations dominate */
+		for (i = 0; i < hist->num; i++)
+			hist->freq[i].hits = (hist->freq[i].hits + 1) / 2;
+	}
+}
+
+
+/* Number of channels scanned when no frequencies are specified */
+static unsigned int scan_learn_num_channels(struct wpa_supplicant *wpa_s)
+{
+	unsigned int count = 0;
+	int i, j, has_g = 0;
+
+	for (i = 0; i < wpa_s->hw.num_modes; i++) {
+		if (wpa_s->hw.modes[i].mode == HOSTAPD_MODE_IEEE80211G)
+			has_g = 1;
+	}
+
+	for (i = 0; i < wpa_s->hw.num_modes; i++) {
+		struct hostapd_hw_modes *mode = &wpa_s->hw.modes[i];
+
+		/* IEEE 802.11b channels are included in the 11g mode */
+		if (mode->mode == HOSTAPD_MODE_IEEE80211B && has_g)
+			continue;
+		for (j = 0; j < mode->num_channels; j++) {
+			if (!(mode->channels[j].flag & HOSTAPD_CHAN_DISABLED))
+				count++;
+		}
+	}
+
+	return count;
+}
+
+
+/**
+ * wpas_scan_learn_scan_res - Learn channels from new scan results
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @info: Information about the scan or %NULL if not available
+ *
+ * This is called after the BSS table has been updated with the results of a
+ * new scan.
+ */
+void wpas_scan_learn_scan_res(struct wpa_supplicant *wpa_s,
+			      struct scan_info *info)
+{
+	struct wpa_ssid *ssid;
+	struct os_reltime now;
+	unsigned int i, all, num;
+
+	all = scan_learn_num_channels(wpa_s);
+	num = info && info->num_freqs ? info->num_freqs : all;
+	wpa_s->scan_learn_scans++;
+	if (num < all)
+		wpa_s->scan_learn_partial_scans++;
+	wpa_s->scan_learn_channels += num;
+	wpa_s->scan_learn_all_channels += all;
+
+	if (!wpa_s->conf->sched_scan_learn)
+		return;
+
+	os_get_reltime(&now);
+	for (i = 0; i < wpa_s->last_scan_res_used; i++) {
+		struct wpa_bss *bss = wpa_s->last_scan_res[i];
+
+		for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
+			if (ssid->ssid_len &&
+			    ssid->ssid_len == bss->ssid_len &&
+			    os_memcmp(ssid->ssid, bss->ssid,
+				      bss->ssid_len) == 0)
+				scan_learn_add(ssid, bss->freq, 1, &now);
+		}
+	}
+}
+
+
+/**
+ * wpas_scan_learn_connected - Learn the channel of a completed connection
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void wpas_scan_learn_connected(struct wpa_supplicant *wpa_s)
+{
+	struct os_reltime now;
+
+	if (!wpa_s->conf->sched_scan_learn || !wpa_s->current_ssid ||
+	    !wpa_s->assoc_freq)
+		return;
+
+	os_get_reltime(&now);
+	scan_learn_add(wpa_s->current_ssid, wpa_s->assoc_freq,
+		       SCAN_LEARN_CONNECT_HITS, &now);
+}
+
+
+/**
+ * wpas_scan_learn_scan_time - Account the duration of a completed scan
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @duration: Time from the start of the scan to the scan results
+ */
+void wpas_scan_learn_scan_time(struct wpa_supplicant *wpa_s,
+			       const struct os_reltime *duration)
+{
+	wpa_s->scan_learn_time_ms += duration->sec * 1000 +
+		duration->usec / 1000;
+}
+
+
+struct scan_learn_plan_freq {
+	int freq;
+	unsigned int hits;
+};
+
+
+static int scan_learn_plan_freq_cmp(const void *a, const void *b)
+{
+	const struct scan_learn_plan_freq *fa = a, *fb = b;
+
+	if (fa->hits != fb->hits)
+		return fa->hits < fb->hits ? 1 : -1;
+	return fa->freq - fb->freq;
+}
+
+
+/*
+ * Build a zero terminated list of the learned channels of all enabled networks
+ * with the most used channels first. NULL is returned if the scan cannot be
+ * limited, e.g., because some of the networks have not yet been seen.
+ */
+static int * scan_learn_freqs(struct wpa_supplicant *wpa_s)
+{
+	struct scan_learn_plan_freq *plan = NULL, *n;
+	size_t num = 0, size = 0, i, j;
+	struct wpa_ssid *ssid;
+	int *freqs = NULL;
+
+	for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
+		struct scan_learn_hist *hist = ssid->learned_freqs;
+
+		if (wpas_network_disabled(wpa_s, ssid))
+			continue;
+		if (!ssid->ssid_len || !hist || !hist->num)
+			goto out;
+
+		for (i = 0; i < hist->num; i++) {
+			for (j = 0; j < num; j++) {
+				if (plan[j].freq == hist->freq[i].freq)
+					break;
+			}
+			if (j == num) {
+				if (num == size) {
+					size = size ? size * 2 : 16;
+					n = os_realloc_array(plan, size,
+							     sizeof(*plan));
+					if (!n)
+						goto out;
+					plan = n;
+				}
+				plan[num].freq = hist->freq[i].freq;
+				plan[num].hits = 0;
+				num++;
+			}
+			plan[j].hits += hist->freq[i].hits;
+		}
+	}
+
+	if (num == 0 || num >= scan_learn_num_channels(wpa_s))
+		goto out;
+
+	qsort(plan, num, sizeof(*plan), scan_learn_plan_freq_cmp);
+	freqs = os_calloc(num + 1, sizeof(int));
+	if (!freqs)
+		goto out;
+	for (i = 0; i < num; i++)
+		freqs[i] = plan[i].freq;
+
+out:
+	os_free(plan);
+	return freqs;
+}
+
+
+static void scan_learn_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_supplicant *wpa_s = eloop_ctx;
+
+	/* timeout_ctx is set when the learned channel phase ends */
+	wpa_s->scan_learn_next_full = timeout_ctx != NULL;
+	if (wpa_s->sched_scanning) {
+		wpa_dbg(wpa_s, MSG_DEBUG,
+			"Scan learn: Restart sched scan with %s channels",
+			wpa_s->scan_learn_next_full ? "all" : "learned");
+		wpas_scan_restart_sched_scan(wpa_s);
+	}
+}
+
+
+/**
+ * wpas_scan_learn_sched_scan - Limit a scheduled scan to learned channels
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @params: Scheduled scan parameters
+ * @interval: Scan interval of the first scan plan in seconds
+ *
+ * The channel list in params is set to the learned channels when that is
+ * possible and the scheduled scan is restarted after sched_scan_learn scan
+ * intervals to run a full channel scheduled scan.
+ */
+void wpas_scan_learn_sched_scan(struct wpa_supplicant *wpa_s,
+				struct wpa_driver_scan_params *params,
+				unsigned int interval)
+{
+	unsigned int timeout;
+
+	eloop_cancel_timeout(scan_learn_timeout, wpa_s, ELOOP_ALL_CTX);
+	if (!wpa_s->conf->sched_scan_learn || params->freqs ||
+	    wpa_s->setband != WPA_SETBAND_AUTO)
+		return;
+
+	if (wpa_s->scan_learn_next_full) {
+		/* Allow one full channel scan before the next learned phase */
+		wpa_s->scan_learn_next_full = 0;
+		timeout = params->sched_scan_start_delay + interval;
+		wpa_dbg(wpa_s, MSG_DEBUG,
+			"Scan learn: Full channel sched scan for %u seconds",
+			timeout);
+		eloop_register_timeout(timeout, 0, scan_learn_timeout, wpa_s,
+				       NULL);
+		return;
+	}
+
+	params->freqs = scan_learn_freqs(wpa_s);
+	if (!params->freqs)
+		return;
+
+	timeout = params->sched_scan_start_delay +
+		interval * wpa_s->conf->sched_scan_learn;
+	wpa_dbg(wpa_s, MSG_DEBUG,
+		"Scan learn: Limit sched scan to %d learned channels for %u seconds",
+		int_array_len(params->freqs), timeout);
+	eloop_register_timeout(timeout, 0, scan_learn_timeout, wpa_s,
+			       (void *) 1);
+}
+
+
+/**
+ * wpas_scan_learn_cancel - Stop the learned channel scheduled scan cycle
+ * @wpa_s: Pointer to wpa_supplicant data
+ */
+void wpas_scan_learn_cancel(struct wpa_supplicant *wpa_s)
+{
+	eloop_cancel_timeout(scan_learn_timeout, wpa_s, ELOOP_ALL_CTX);
+}
+
+
+/**
+ * wpas_scan_learn_status - Get scan statistics and learned channels
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @buf: Buffer for the status text
+ * @buflen: Length of the buffer
+ * Returns: Number of octets written
+ */
+int wpas_scan_learn_status(struct wpa_supplicant *wpa_s, char *buf,
+			   size_t buflen)
+{
+	char *pos = buf, *end = buf + buflen;
+	struct wpa_ssid *ssid;
+	unsigned int i;
+	int ret;
+
+	ret = os_snprintf(pos, end - pos,
+			  "scans=%u\npartial_scans=%u\nchannels=%lu\n"
+			  "all_channels=%lu\nscan_time_ms=%lu\n",
+			  wpa_s->scan_learn_scans,
+			  wpa_s->scan_learn_partial_scans,
+			  wpa_s->scan_learn_channels,
+			  wpa_s->scan_learn_all_channels,
+			  wpa_s->scan_learn_time_ms);
+	if (os_snprintf_error(end - pos, ret))
+		return 0;
+	pos += ret;
+
+	for (ssid = wpa_s->conf->ssid; ssid; ssid = ssid->next) {
+		struct scan_learn_hist *hist = ssid->learned_freqs;
+
+		if (!hist || !hist->num)
+			continue;
+		ret = os_snprintf(pos, end - pos, "network=%d freqs=", ssid->id);
+		if (os_snprintf_error(end - pos, ret))
+			return pos - buf;
+		pos += ret;
+		for (i = 0; i < hist->num; i++) {
+			ret = os_snprintf(pos, end - pos, "%s%d:%u",
+					  i ? "," : "", hist->freq[i].freq,
+					  hist->freq[i].hits);
+			if (os_snprintf_error(end - pos, ret))
+				return pos - buf;
+			pos += ret;
+		}
+		ret = os_snprintf(pos, end - pos, "\n");
+		if (os_snprintf_error(end - pos, ret))
+			return pos - buf;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
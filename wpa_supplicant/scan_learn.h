@@ -0,0 +1,58 @@
+/*
+ * WPA Supplicant - Learned channels for scheduled scans
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef SCAN_LEARN_H
+#define SCAN_LEARN_H
+
+struct wpa_driver_scan_params;
+struct scan_info;
+
+#ifdef CONFIG_SCAN_LEARN
+
+void wpas_scan_learn_scan_res(struct wpa_supplicant *wpa_s,
+			      struct scan_info *info);
+void wpas_scan_learn_connected(struct wpa_supplicant *wpa_s);
+void wpas_scan_learn_scan_time(struct wpa_supplicant *wpa_s,
+			       const struct os_reltime *duration);
+void wpas_scan_learn_sched_scan(struct wpa_supplicant *wpa_s,
+				struct wpa_driver_scan_params *params,
+				unsigned int interval);
+void wpas_scan_learn_cancel(struct wpa_supplicant *wpa_s);
+int wpas_scan_learn_status(struct wpa_supplicant *wpa_s, char *buf,
+			   size_t buflen);
+
+#else /* CONFIG_SCAN_LEARN */
+
+static inline void wpas_scan_learn_scan_res(struct wpa_supplicant *wpa_s,
+					    struct scan_info *info)
+{
+}
+
+static inline void wpas_scan_learn_connected(struct wpa_supplicant *wpa_s)
+{
+}
+
+static inline void
+wpas_scan_learn_scan_time(struct wpa_supplicant *wpa_s,
+			  const struct os_reltime *duration)
+{
+}
+
+static inline void
+wpas_scan_learn_sched_scan(struct wpa_supplicant *wpa_s,
+			   struct wpa_driver_scan_params *params,
+			   unsigned int interval)
+{
+}
+
+static inline void wpas_scan_learn_cancel(struct wpa_supplicant *wpa_s)
+{
+}
+
+#endif /* CONFIG_SCAN_LEARN */
+
+#endif /* SCAN_LEARN_H */
@@ -332,6 +332,15 @@ static int wpa_cli_cmd_pmksa(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+#ifdef CONFIG_SCAN_LEARN
+static int wpa_cli_cmd_scan_learn(struct wpa_ctrl *ctrl, int argc,
+				  char *argv[])
+{
+	return wpa_ctrl_command(ctrl, "SCAN_LEARN");
+}
+#endif /* CONFIG_SCAN_LEARN */
+
+
 static int wpa_cli_cmd_pmksa_flush(struct wpa_ctrl *ctrl, int argc,
 				   char *argv[])
 {
@@ -3086,6 +3095,11 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "pmksa", wpa_cli_cmd_pmksa, NULL,
 	  cli_cmd_flag_none,
 	  "= show PMKSA cache" },
+#ifdef CONFIG_SCAN_LEARN
+	{ "scan_learn", wpa_cli_cmd_scan_learn, NULL,
+	  cli_cmd_flag_none,
+	  "= show scan statistics and learned channels of networks" },
+#endif /* CONFIG_SCAN_LEARN */
 	{ "pmksa_flush", wpa_cli_cmd_pmksa_flush, NULL,
 	  cli_cmd_flag_none,
 	  "= flush PMKSA cache entries" },
@@ -3151,6 +3165,7 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "log_level", wpa_cli_cmd_log_level, NULL,
 	  cli_cmd_flag_none,
 	  "<level> [<timestamp>] = update the log level/timestamp\n"
+	  "<module>=<level|DEFAULT> = update the log level of a module\n"
 	  "log_level = display the current log level and log options" },
 	{ "list_networks", wpa_cli_cmd_list_networks, NULL,
 	  cli_cmd_flag_none,
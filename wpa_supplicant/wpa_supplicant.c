@@ -54,6 +54,7 @@
 #include "notify.h"
 #include "bgscan.h"
 #include "autoscan.h"
+#include "scan_learn.h"
 #include "bss.h"
 #include "scan.h"
 #include "offchannel.h"
@@ -478,6 +479,7 @@ static void wpa_supplicant_cleanup(struct wpa_supplicant *wpa_s)
 
 	bgscan_deinit(wpa_s);
 	autoscan_deinit(wpa_s);
+	wpas_scan_learn_cancel(wpa_s);
 	scard_deinit(wpa_s->scard);
 	wpa_s->scard = NULL;
 	wpa_sm_set_scard_ctx(wpa_s->wpa, NULL);
@@ -927,6 +929,7 @@ void wpa_supplicant_set_state(struct wpa_supplicant *wpa_s,
 			fils_hlp_sent ? " FILS_HLP_SENT" : "");
 #endif /* CONFIG_CTRL_IFACE || !CONFIG_NO_STDOUT_DEBUG */
 		wpas_clear_temp_disabled(wpa_s, ssid, 1);
+		wpas_scan_learn_connected(wpa_s);
 		wpa_blacklist_clear(wpa_s);
 		wpa_s->extra_blacklist_count = 0;
 		wpa_s->new_connection = 0;
@@ -6320,6 +6323,18 @@ static const char * wpa_supplicant_msg_ifname_cb(void *ctx)
 #define WPA_SUPPLICANT_CLEANUP_INTERVAL 10
 #endif /* WPA_SUPPLICANT_CLEANUP_INTERVAL */
 
+#ifdef CONFIG_DEBUG_RING
+#define WPA_SUPPLICANT_DEBUG_RING_FLUSH_INTERVAL 1
+
+static void wpas_debug_ring_flush(void *eloop_ctx, void *timeout_ctx)
+{
+	wpa_debug_ring_flush();
+	eloop_register_timeout(WPA_SUPPLICANT_DEBUG_RING_FLUSH_INTERVAL, 0,
+			       wpas_debug_ring_flush, NULL, NULL);
+}
+#endif /* CONFIG_DEBUG_RING */
+
+
 /* Periodic cleanup tasks */
 static void wpas_periodic(void *eloop_ctx, void *timeout_ctx)
 {
@@ -6385,6 +6400,12 @@ struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 			return NULL;
 		}
 	}
+	if (params->wpa_debug_ring &&
+	    wpa_debug_ring_init(params->wpa_debug_ring - 1,
+				WPA_DEBUG_RING_DEFAULT_SIZE, MSG_DEBUG)) {
+		wpa_printf(MSG_ERROR, "Failed to enable debug ring buffer");
+		return NULL;
+	}
 
 	ret = eap_register_methods();
 	if (ret) {
@@ -6485,6 +6506,11 @@ struct wpa_global * wpa_supplicant_init(struct wpa_params *params)
 
 	eloop_register_timeout(WPA_SUPPLICANT_CLEANUP_INTERVAL, 0,
 			       wpas_periodic, global, NULL);
+#ifdef CONFIG_DEBUG_RING
+	if (params->wpa_debug_ring == WPA_DEBUG_RING_BUFFERED + 1)
+		eloop_register_timeout(WPA_SUPPLICANT_DEBUG_RING_FLUSH_INTERVAL,
+				       0, wpas_debug_ring_flush, NULL, NULL);
+#endif /* CONFIG_DEBUG_RING */
 
 	return global;
 }
@@ -6544,6 +6570,9 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 		return;
 
 	eloop_cancel_timeout(wpas_periodic, global, NULL);
+#ifdef CONFIG_DEBUG_RING
+	eloop_cancel_timeout(wpas_debug_ring_flush, NULL, NULL);
+#endif /* CONFIG_DEBUG_RING */
 
 #ifdef CONFIG_WIFI_DISPLAY
 	wifi_display_deinit(global);
@@ -6593,6 +6622,7 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 	os_free(global->add_psk);
 
 	os_free(global);
+	wpa_debug_ring_deinit();
 	wpa_debug_close_syslog();
 	wpa_debug_close_file();
 	wpa_debug_close_linux_tracing();
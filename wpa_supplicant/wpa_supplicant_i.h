@@ -193,6 +193,13 @@ struct wpa_params {
 	 */
 	int wpa_debug_tracing;
 
+	/**
+	 * wpa_debug_ring - Debug ring buffer mode
+	 *
+	 * 0 = not used, otherwise enum wpa_debug_ring_mode + 1
+	 */
+	int wpa_debug_ring;
+
 	/**
 	 * override_driver - Optional driver parameter override
 	 *
@@ -576,6 +583,14 @@ struct wpa_supplicant {
 	int sched_scan_timeout;
 	int first_sched_scan;
 	int sched_scan_timed_out;
+#ifdef CONFIG_SCAN_LEARN
+	unsigned int scan_learn_next_full:1;
+	unsigned int scan_learn_scans;
+	unsigned int scan_learn_partial_scans;
+	unsigned long scan_learn_channels; /* number of channels scanned */
+	unsigned long scan_learn_all_channels; /* same without limited scans */
+	unsigned long scan_learn_time_ms;
+#endif /* CONFIG_SCAN_LEARN */
 	struct sched_scan_plan *sched_scan_plans;
 	size_t sched_scan_plans_num;
 
@@ -586,6 +601,14 @@ struct wpa_supplicant {
 	size_t num_bss;
 	unsigned int bss_update_idx;
 	unsigned int bss_next_id;
+	/* Driver BSS table generation of the results in the ongoing update
+	 * round (0 = not available) */
+	unsigned int bss_update_generation;
+	/* Number of entries added, changed, and found unchanged in the
+	 * ongoing or the last update round */
+	unsigned int bss_update_added;
+	unsigned int bss_update_changed;
+	unsigned int bss_update_unchanged;
 
 	 /*
 	  * Pointers to BSS entries in the order they were in the last scan
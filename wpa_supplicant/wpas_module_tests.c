@@ -10,8 +10,10 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "common/ieee802_11_defs.h"
 #include "wpa_supplicant_i.h"
 #include "blacklist.h"
+#include "scan.h"
 
 
 static int wpas_blacklist_module_tests(void)
@@ -70,6 +72,167 @@ fail:
 }
 
 
+static struct wpa_scan_res * wpas_scan_sort_test_res(u8 id, int snr, int freq,
+						     int rsn)
+{
+	struct wpa_scan_res *res;
+	u8 *pos;
+
+	res = os_zalloc(sizeof(*res) + 4);
+	if (!res)
+		return NULL;
+	res->bssid[5] = id;
+	res->flags = WPA_SCAN_LEVEL_DBM;
+	res->snr = snr;
+	res->level = snr - 90;
+	res->freq = freq;
+	if (rsn) {
+		res->caps = IEEE80211_CAP_PRIVACY;
+		pos = (u8 *) (res + 1);
+		*pos++ = WLAN_EID_RSN;
+		*pos++ = 2;
+		WPA_PUT_LE16(pos, 1); /* Version */
+		res->ie_len = 4;
+	}
+	return res;
+}
+
+
+static int wpas_scan_sort_module_tests(void)
+{
+	struct wpa_scan_results scan_res;
+	struct wpa_scan_res *res[4];
+	static const u8 expected[] = { 2, 3, 1, 0 };
+	unsigned int i;
+	int ret = -1;
+
+	os_memset(&scan_res, 0, sizeof(scan_res));
+	res[0] = wpas_scan_sort_test_res(0, 40, 2412, 0);
+	res[1] = wpas_scan_sort_test_res(1, 10, 2412, 1);
+	res[2] = wpas_scan_sort_test_res(2, 30, 5180, 1);
+	res[3] = wpas_scan_sort_test_res(3, 32, 2437, 1);
+	scan_res.res = res;
+	scan_res.num = ARRAY_SIZE(res);
+
+	for (i = 0; i < ARRAY_SIZE(res); i++) {
+		if (!res[i])
+			goto fail;
+	}
+
+	if (wpa_scan_results_sort(&scan_res, &wpa_scan_rank_default) < 0)
+		goto fail;
+	for (i = 0; i < ARRAY_SIZE(expected); i++) {
+		if (res[i]->bssid[5] != expected[i])
+			goto fail;
+	}
+
+	ret = 0;
+fail:
+	for (i = 0; i < ARRAY_SIZE(res); i++)
+		os_free(res[i]);
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "scan result sort module test failure");
+
+	return ret;
+}
+
+
+#define SCAN_SORT_BENCH_ROUNDS 20
+
+static int wpas_scan_sort_bench(size_t num)
+{
+	struct wpa_scan_results scan_res;
+	struct wpa_scan_res **res, **orig;
+	struct os_reltime start, end, diff;
+	unsigned int seed = 12345;
+	int level = wpa_debug_level;
+	int snr, freq, rsn;
+	size_t i, created = 0;
+	unsigned int round;
+	int ret = -1;
+
+	os_memset(&scan_res, 0, sizeof(scan_res));
+	res = os_calloc(num, sizeof(*res));
+	orig = os_calloc(num, sizeof(*orig));
+	if (!res || !orig)
+		goto fail;
+
+	/* Dense venue: mostly secured BSSes on a few channels with similar
+	 * SNR values and some open hotspots mixed in */
+	for (i = 0; i < num; i++) {
+		seed = seed * 1103515245 + 12345;
+		snr = 5 + (seed >> 16) % 40;
+		freq = (seed >> 8) & 1 ? 5180 + 20 * ((seed >> 4) % 8) :
+			2412 + 25 * ((seed >> 4) % 3);
+		rsn = (seed >> 24) % 5 != 0;
+		orig[i] = wpas_scan_sort_test_res(i & 0xff, snr, freq, rsn);
+		if (!orig[i])
+			goto fail;
+		orig[i]->bssid[4] = i >> 8;
+		created++;
+	}
+	scan_res.res = res;
+	scan_res.num = num;
+
+	wpa_debug_level = MSG_INFO;
+	os_get_reltime(&start);
+	for (round = 0; round < SCAN_SORT_BENCH_ROUNDS; round++) {
+		os_memcpy(res, orig, num * sizeof(*res));
+		if (wpa_scan_results_sort(&scan_res, &wpa_scan_rank_default) <
+		    0)
+			break;
+	}
+	os_get_reltime(&end);
+	wpa_debug_level = level;
+	if (round < SCAN_SORT_BENCH_ROUNDS)
+		goto fail;
+
+	/* RSN BSSes have to be ranked before the open ones */
+	for (i = 1; i < num; i++) {
+		if (res[i]->ie_len && !res[i - 1]->ie_len)
+			goto fail;
+	}
+
+	os_reltime_sub(&end, &start, &diff);
+	wpa_printf(MSG_INFO,
+		   "scan result sort: %u x %u BSSes in %ld.%06ld sec",
+		   SCAN_SORT_BENCH_ROUNDS, (unsigned int) num,
+		   (long) diff.sec, (long) diff.usec);
+
+	ret = 0;
+fail:
+	for (i = 0; i < created; i++)
+		os_free(orig[i]);
+	os_free(orig);
+	os_free(res);
+
+	if (ret)
+		wpa_printf(MSG_ERROR,
+			   "scan result sort benchmark failure (%u BSSes)",
+			   (unsigned int) num);
+
+	return ret;
+}
+
+
+static int wpas_scan_sort_bench_module_tests(void)
+{
+	static const size_t sizes[] = { 50, 300, 1000 };
+	unsigned int i;
+	int ret = 0;
+
+	wpa_printf(MSG_INFO, "scan result sort benchmark (dense venue)");
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		if (wpas_scan_sort_bench(sizes[i]) < 0)
+			ret = -1;
+	}
+
+	return ret;
+}
+
+
 int wpas_module_tests(void)
 {
 	int ret = 0;
@@ -79,6 +242,12 @@ int wpas_module_tests(void)
 	if (wpas_blacklist_module_tests() < 0)
 		ret = -1;
 
+	if (wpas_scan_sort_module_tests() < 0)
+		ret = -1;
+
+	if (wpas_scan_sort_bench_module_tests() < 0)
+		ret = -1;
+
 #ifdef CONFIG_WPS
 	if (wps_module_tests() < 0)
 		ret = -1;